@@ -13,6 +13,8 @@
 #include <zephyr/init.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/eeprom.h>
+#include <zephyr/drivers/disk/eepromdisk.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(eepromdisk, CONFIG_DISK_DRIVER_EEPROM_LOG_LEVEL);
@@ -23,6 +25,9 @@ struct eeprom_disk_config {
 	const struct device *const eeprom_dev;
 	const uint32_t eeprom_off;
 	const bool eeprom_ro;
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+	atomic_t *const trimmed;
+#endif
 };
 
 static uint32_t lba_to_address(const struct device *dev, uint32_t lba)
@@ -42,21 +47,56 @@ static int disk_eeprom_access_init(struct disk_info *disk)
 	return 0;
 }
 
+static bool sector_trimmed(const struct device *dev, uint32_t sector)
+{
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+	const struct eeprom_disk_config *config = dev->config;
+
+	return atomic_test_bit(config->trimmed, sector);
+#else
+	ARG_UNUSED(dev);
+	ARG_UNUSED(sector);
+	return false;
+#endif
+}
+
 static int disk_eeprom_access_read(struct disk_info *disk, uint8_t *buff,
 				   uint32_t sector, uint32_t count)
 {
 	const struct device *dev = disk->dev;
 	const struct eeprom_disk_config *config = dev->config;
 	const uint32_t scount = config->sector_count;
+	int rc = 0;
 
 	if ((scount < count) || (scount - count) < sector) {
 		LOG_ERR("Read outside disk range");
 		return -EIO;
 	}
 
-	return eeprom_read(config->eeprom_dev,
-			   config->eeprom_off + lba_to_address(dev, sector),
-			   buff, count * config->sector_size);
+	while ((count != 0U) && (rc == 0)) {
+		uint32_t run = 1U;
+
+		if (sector_trimmed(dev, sector)) {
+			memset(buff, 0xff, config->sector_size);
+		} else {
+			/* read the untrimmed sectors at once */
+			while ((run < count) &&
+			       (!sector_trimmed(dev, sector + run))) {
+				run++;
+			}
+
+			rc = eeprom_read(config->eeprom_dev,
+					 config->eeprom_off +
+						 lba_to_address(dev, sector),
+					 buff, run * config->sector_size);
+		}
+
+		buff += run * config->sector_size;
+		sector += run;
+		count -= run;
+	}
+
+	return rc;
 }
 
 static int disk_eeprom_access_write(struct disk_info *disk, const uint8_t *buff,
@@ -80,9 +120,43 @@ static int disk_eeprom_access_write(struct disk_info *disk, const uint8_t *buff,
 			      buff, count * config->sector_size);
 	LOG_DBG("Write %d sectors to %x [%d]", count,
 		lba_to_address(dev, sector), rc);
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+	if (rc == 0) {
+		for (uint32_t i = 0U; i < count; i++) {
+			atomic_clear_bit(config->trimmed, sector + i);
+		}
+	}
+#endif
 	return rc;
 }
 
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+static int disk_eeprom_access_trim(const struct device *dev,
+				   const struct eeprom_disk_trim *trim)
+{
+	const struct eeprom_disk_config *config = dev->config;
+	const uint32_t scount = config->sector_count;
+
+	if (config->eeprom_ro) {
+		return -ENOTSUP;
+	}
+
+	if ((trim == NULL) || (scount < trim->count) ||
+	    ((scount - trim->count) < trim->sector)) {
+		LOG_ERR("Trim outside disk range");
+		return -EINVAL;
+	}
+
+	for (uint32_t i = 0U; i < trim->count; i++) {
+		atomic_set_bit(config->trimmed, trim->sector + i);
+	}
+
+	LOG_DBG("Trim %d sectors at %x", trim->count,
+		lba_to_address(dev, trim->sector));
+	return 0;
+}
+#endif
+
 static int disk_eeprom_access_ioctl(struct disk_info *disk, uint8_t cmd,
 				    void *buff)
 {
@@ -100,6 +174,10 @@ static int disk_eeprom_access_ioctl(struct disk_info *disk, uint8_t cmd,
 	case DISK_IOCTL_GET_ERASE_BLOCK_SZ:
 		*(uint32_t *)buff = 1U;
 		break;
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+	case EEPROM_DISK_IOCTL_CTRL_TRIM:
+		return disk_eeprom_access_trim(disk->dev, buff);
+#endif
 	default:
 		return -EINVAL;
 	}
@@ -137,14 +215,24 @@ static const struct disk_operations eeprom_disk_ops = {
 #define EEPROM_DISK_SIZE_OK(n)  (EEPROM_ASIZE(n) >= EEPROM_DISK_SIZE(n))
 #define EEPROM_DISK_ALIGN_OK(n) (EEPROM_DISK_SIZE(n) % EEPROM_DISK_SSIZE(n) == 0)
 
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+#define EEPROMDISK_TRIM_DEFINE(n)                                               \
+	static ATOMIC_DEFINE(disk_trimmed_##n, EEPROM_DISK_SCNT(n))
+#define EEPROMDISK_TRIM(n) .trimmed = disk_trimmed_##n,
+#else
+#define EEPROMDISK_TRIM_DEFINE(n) BUILD_ASSERT(true, "")
+#define EEPROMDISK_TRIM(n)
+#endif
+
 #define EEPROMDISK_DEVICE_CONFIG_DEFINE(n)                                      \
-                                                                                \
+	EEPROMDISK_TRIM_DEFINE(n);                                              \
 	static struct eeprom_disk_config disk_config_##n = {                    \
 		.sector_size = EEPROM_DISK_SSIZE(n),                            \
 		.sector_count = EEPROM_DISK_SCNT(n),                            \
 		.eeprom_dev = EEPROM_DEVICE(n),                                 \
 		.eeprom_off = EEPROM_OFFSET(n),                                 \
 		.eeprom_ro = EEPROM_RO(n),                                      \
+		EEPROMDISK_TRIM(n)                                              \
 	}
 
 #define EEPROMDISK_DEVICE_DEFINE(n)                                             \
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Extensions of the disk access api for the eeprom disk
+ */
+
+#ifndef ZEPHYR_INCLUDE_DRIVERS_DISK_EEPROMDISK_H_
+#define ZEPHYR_INCLUDE_DRIVERS_DISK_EEPROMDISK_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Eeprom disk extensions
+ * @defgroup eeprom_disk_interface Eeprom disk extensions
+ * @ingroup io_interfaces
+ * @{
+ */
+
+/**
+ * @brief Trim (release) disk sectors, used with disk_access_ioctl().
+ *
+ * The data in the sectors is no longer needed: the sectors are only marked as
+ * trimmed (no eeprom writes), a trimmed sector reads as 0xff without an
+ * eeprom access until it is written again. The trimmed sectors are not kept
+ * over a restart: the sectors then read their old data again.
+ *
+ * The ioctl buffer is a struct eeprom_disk_trim. Available when
+ * CONFIG_DISK_DRIVER_EEPROM_TRIM is enabled, a storage area on disk uses it
+ * for discarded blocks (CONFIG_STORAGE_AREA_DISK_TRIM).
+ */
+#define EEPROM_DISK_IOCTL_CTRL_TRIM 0x80
+
+/** Sector range for EEPROM_DISK_IOCTL_CTRL_TRIM */
+struct eeprom_disk_trim {
+	uint32_t sector; /**< first sector */
+	uint32_t count;  /**< number of sectors */
+};
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_DRIVERS_DISK_EEPROMDISK_H_ */
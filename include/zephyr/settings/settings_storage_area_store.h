@@ -22,9 +22,34 @@ extern "C" {
  * Deleted settings are stored without a settings value
  */
 
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+/* The (optional) name index keeps for each setting name hash the location of
+ * the newest valid record. It is rebuilt each time the backend mounts the
+ * storage area store and kept up to date by save and compaction. When the
+ * index overflows the backend falls back to scanning the store.
+ */
+struct settings_sas_index_entry {
+	uint32_t hash;
+	size_t sector;
+	size_t loc;
+	size_t size;
+};
+
+struct settings_sas_index {
+	struct settings_sas_index *next;
+	const struct storage_area_store *sa_store;
+	struct settings_sas_index_entry
+		entry[CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX_SIZE];
+	bool ready;
+};
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+
 struct settings_storage_area_store {
 	struct settings_store store;
 	struct storage_area_store *sa_store;
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index index;
+#endif
 };
 
 extern const struct settings_store_itf settings_storage_area_store_itf;
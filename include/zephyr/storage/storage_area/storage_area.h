@@ -25,6 +25,8 @@
  * The subsystem is easy extendable to create custom (virtual) storage areas
  * that consist of e.g. a combination of flash and ram, an encrypted storage
  * area, ...
+ * A write-back cache in ram on top of another storage area is available as
+ * storage_area_cache (see storage_area_cache.h).
  *
  * There following methods are exposed:
  * - storage_area_read(): read data,
@@ -32,8 +34,21 @@
  * - storage_area_write(): write data,
  * - storage_area_writev(): write data vector,
  * - storage_area_erase(): erase (in erase block addressing),
+ * - storage_area_discard(): release erase blocks without erasing them,
+ * - storage_area_blank_check(): check if data is erased,
  * - storage_area_ioctl(): used for e.g. getting xip addresses,
  *
+ * When CONFIG_STORAGE_AREA_ASYNC is enabled read, write and erase can also be
+ * requested asynchronously (storage_area_readv_async(),
+ * storage_area_writev_async() and storage_area_erase_async()). The requests
+ * are executed in order of submission on a dedicated work queue using the
+ * backend routines, and are completed through a callback or a poll signal.
+ *
+ * When CONFIG_STORAGE_AREA_STATS is enabled the number of operations, bytes,
+ * errors and a latency histogram are kept for read, write and erase of each
+ * storage area. They are retrieved with the STORAGE_AREA_IOCTL_STATS ioctl
+ * or the `storage_area stats` shell command.
+ *
  * A storage area is defined e.g. for a read-write area on flash:
  * @code{.c}
  * STORAGE_AREA_FLASH_RW_DEFINE(name, ...);
@@ -56,9 +71,13 @@
 #ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_H_
 #define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <zephyr/sys/util.h>
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+#include <zephyr/kernel.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -96,6 +115,76 @@ enum storage_area_ioctl_cmd {
 	STORAGE_AREA_IOCTL_NONE,
 	/** retrieve the storage area xip address */
 	STORAGE_AREA_IOCTL_XIPADDRESS,
+	/** write cached data to the storage device */
+	STORAGE_AREA_IOCTL_FLUSH,
+	/** retrieve the cache counters (struct storage_area_cache_stats) */
+	STORAGE_AREA_IOCTL_CACHE_STATS,
+	/** discard erase blocks (struct storage_area_blocks) */
+	STORAGE_AREA_IOCTL_DISCARD,
+	/** retrieve the i/o statistics (struct storage_area_stats) */
+	STORAGE_AREA_IOCTL_STATS,
+	/** clear the i/o statistics */
+	STORAGE_AREA_IOCTL_STATS_RESET,
+	/** retrieve the nor simulator counters
+	 *  (struct storage_area_nor_sim_stats)
+	 */
+	STORAGE_AREA_IOCTL_NOR_SIM_STATS,
+	/** retrieve the erase count of a nor simulator block
+	 *  (struct storage_area_nor_sim_wear)
+	 */
+	STORAGE_AREA_IOCTL_NOR_SIM_WEAR,
+	/** retrieve the failed replicas of a mirror (uint32_t bitmask) */
+	STORAGE_AREA_IOCTL_MIRROR_FAILED,
+	/** use the failed replicas of a mirror again (after a resync) */
+	STORAGE_AREA_IOCTL_MIRROR_RESTORE,
+};
+
+/** storage area erase block range */
+struct storage_area_blocks {
+	size_t sblk; /**< start block */
+	size_t bcnt; /**< number of blocks */
+};
+
+/** storage area cache counters */
+struct storage_area_cache_stats {
+	uint32_t hits;   /**< reads served from the cache */
+	uint32_t misses; /**< reads that needed the storage device */
+};
+
+/** number of storage area latency histogram buckets */
+#define STORAGE_AREA_STATS_BUCKETS 20
+
+/**
+ * storage area operation counters, the latency histogram bucket 0 counts
+ * operations that took less than 1 us, bucket i (i > 0) operations that took
+ * [2^(i-1), 2^i) us and the last bucket also counts all slower operations.
+ */
+struct storage_area_op_stats {
+	uint32_t ops;    /**< number of operations */
+	uint32_t errors; /**< number of failed operations */
+	uint64_t bytes;  /**< bytes read, written or erased */
+	uint32_t latency[STORAGE_AREA_STATS_BUCKETS]; /**< latency histogram */
+};
+
+/** number of storage area erase blocks with an erase counter */
+#ifdef CONFIG_STORAGE_AREA_STATS_ERASE_BLOCKS
+#define STORAGE_AREA_STATS_ERASE_BLOCKS CONFIG_STORAGE_AREA_STATS_ERASE_BLOCKS
+#else
+#define STORAGE_AREA_STATS_ERASE_BLOCKS 1
+#endif
+
+/**
+ * storage area i/o statistics (CONFIG_STORAGE_AREA_STATS), erases of blocks
+ * at or above STORAGE_AREA_STATS_ERASE_BLOCKS are only counted in
+ * erased_blocks.
+ */
+struct storage_area_stats {
+	struct storage_area_op_stats read;  /**< storage_area_readv() */
+	struct storage_area_op_stats write; /**< storage_area_writev() */
+	struct storage_area_op_stats erase; /**< storage_area_erase() */
+	uint64_t erased_blocks;             /**< number of erased blocks */
+	/** number of erases of each block */
+	uint32_t block_erases[STORAGE_AREA_STATS_ERASE_BLOCKS];
 };
 
 /** storage area api */
@@ -105,6 +194,9 @@ struct storage_area_api {
 	int (*writev)(const struct storage_area *area, sa_off_t offset,
 		      const struct storage_area_iovec *iovec, size_t iovcnt);
 	int (*erase)(const struct storage_area *area, size_t sblk, size_t bcnt);
+	/** optional, when not provided (or -ENOTSUP) data is read back */
+	int (*blank_check)(const struct storage_area *area, sa_off_t offset,
+			   size_t len);
 	int (*ioctl)(const struct storage_area *area,
 		     enum storage_area_ioctl_cmd cmd, void *data);
 };
@@ -129,8 +221,8 @@ struct storage_area {
 #define STORAGE_AREA_LOVRWRITE(area)                                            \
 	STORAGE_AREA_HAS_PROPERTY(area, STORAGE_AREA_PROP_LOVRWRITE)
 #define STORAGE_AREA_ERASEVALUE(area)                                           \
-	STORAGE_AREA_HAS_PROPERTY(area, STORAGE_AREA_PROP_ZEROERASE) ? 0x00     \
-								     : 0xff
+	(STORAGE_AREA_HAS_PROPERTY(area, STORAGE_AREA_PROP_ZEROERASE) ? 0x00    \
+								      : 0xff)
 #define STORAGE_AREA_AUTOERASE(area)                                            \
 	STORAGE_AREA_HAS_PROPERTY(area, STORAGE_AREA_PROP_AUTOERASE)
 
@@ -168,6 +260,36 @@ int storage_area_readv(const struct storage_area *area, sa_off_t offset,
 int storage_area_read(const struct storage_area *area, sa_off_t offset,
 		      void *data, size_t len);
 
+/**
+ * @brief	 Map a part of a storage area for reading without a copy. When
+ *		 the storage area is memory addressable (it supports
+ *		 STORAGE_AREA_IOCTL_XIPADDRESS) ptr points to the data in place,
+ *		 otherwise the data is read in the bounce buffer buf and ptr
+ *		 points to buf. A map is released with storage_area_unmap().
+ *
+ * @param area	 storage area.
+ * @param offset offset in storage area (byte).
+ * @param len	 map size.
+ * @param buf	 bounce buffer of at least len bytes (can be NULL to only
+ *		 map in place).
+ * @param ptr	 returned pointer to the data.
+ *
+ * @retval	 0 on success, -ENOTSUP when buf is NULL and the storage area
+ *		 is not memory addressable, else negative errno code.
+ */
+int storage_area_map(const struct storage_area *area, sa_off_t offset,
+		     size_t len, void *buf, const void **ptr);
+
+/**
+ * @brief	 Release a map of a storage area.
+ *
+ * @param area	 storage area.
+ * @param ptr	 pointer returned by storage_area_map().
+ *
+ * @retval	 0 on success else negative errno code.
+ */
+int storage_area_unmap(const struct storage_area *area, const void *ptr);
+
 /**
  * @brief	 Write iovec to storage area.
  *
@@ -206,6 +328,122 @@ int storage_area_write(const struct storage_area *area, sa_off_t offset,
 int storage_area_erase(const struct storage_area *area, size_t sblk,
 		       size_t bcnt);
 
+/**
+ * @brief      Discard storage area blocks: the data in the blocks is no
+ *	       longer needed. Until the blocks are written again they read as
+ *	       erased. A storage area that supports STORAGE_AREA_IOCTL_DISCARD
+ *	       only remembers the discarded blocks (no device writes), after a
+ *	       restart the blocks can contain the old data again. On other
+ *	       storage areas the blocks are erased.
+ *
+ * @param area storage area.
+ * @param sblk start block
+ * @param bcnt number of blocks to discard.
+ *
+ * @retval     0 on success else negative errno code.
+ */
+int storage_area_discard(const struct storage_area *area, size_t sblk,
+			 size_t bcnt);
+
+/**
+ * @brief	 Check if a part of a storage area is blank (contains only
+ *		 the erase value).
+ *
+ * @param area	 storage area.
+ * @param offset offset in storage area (byte).
+ * @param len    check size.
+ *
+ * @retval	 0 when blank, -ENOTEMPTY when not blank, else negative errno
+ *		 code.
+ */
+int storage_area_blank_check(const struct storage_area *area, sa_off_t offset,
+			     size_t len);
+
+/**
+ * @brief	 Check if memory is blank (helper for storage area backends).
+ *		 The memory is compared in 64-bit words.
+ *
+ * @param mem	 memory.
+ * @param len    check size.
+ * @param value  erase value.
+ *
+ * @retval	 true when blank else false.
+ */
+bool storage_area_mem_blank(const void *mem, size_t len, uint8_t value);
+
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+/**
+ * @brief Discarded block tracking (helpers for storage area backends). For
+ *        each erase block the size of the discarded part at the end of the
+ *        block is kept (0 when nothing is discarded, the erase-size when the
+ *        block is discarded). Writes in the discarded part move its start.
+ */
+#define STORAGE_AREA_DISCARD_DEFINE(_name, _blocks)                             \
+	static uint32_t _storage_area_##_name##_discard[_blocks]
+#define STORAGE_AREA_DISCARD_PTR(_name) _storage_area_##_name##_discard
+#define STORAGE_AREA_DISCARD_INIT(_discard) .discard = _discard,
+
+/**
+ * @brief	   Mark blocks as discarded (discarded == true) or as erased.
+ *
+ * @param area	   storage area.
+ * @param discard  discarded part size for each erase block.
+ * @param sblk	   start block.
+ * @param bcnt	   number of blocks.
+ * @param discarded new state of the blocks.
+ */
+void storage_area_discard_set(const struct storage_area *area,
+			      uint32_t *discard, size_t sblk, size_t bcnt,
+			      bool discarded);
+
+/**
+ * @brief	   Get the size of the part at offset that is completely
+ *		   discarded or not discarded.
+ *
+ * @param area	   storage area.
+ * @param discard  discarded part size for each erase block.
+ * @param offset   offset in storage area (byte).
+ * @param len	   maximum size.
+ * @param discarded returned state of the part.
+ *
+ * @retval	   size of the part (at most len).
+ */
+size_t storage_area_discard_extent(const struct storage_area *area,
+				   const uint32_t *discard, sa_off_t offset,
+				   size_t len, bool *discarded);
+
+/**
+ * @brief	   Get the size of the discarded gap before a write at offset,
+ *		   the gap should be written with the erase value before the
+ *		   write.
+ *
+ * @param area	   storage area.
+ * @param discard  discarded part size for each erase block.
+ * @param offset   offset in storage area (byte).
+ *
+ * @retval	   size of the gap (the gap ends at offset).
+ */
+size_t storage_area_discard_gap(const struct storage_area *area,
+				const uint32_t *discard, sa_off_t offset);
+
+/**
+ * @brief	   Update the discarded parts after a write (including the gap
+ *		   before the write).
+ *
+ * @param area	   storage area.
+ * @param discard  discarded part size for each erase block.
+ * @param offset   offset in storage area (byte).
+ * @param len	   write size.
+ */
+void storage_area_discard_written(const struct storage_area *area,
+				  uint32_t *discard, sa_off_t offset,
+				  size_t len);
+#else
+#define STORAGE_AREA_DISCARD_DEFINE(_name, _blocks) BUILD_ASSERT(true, "")
+#define STORAGE_AREA_DISCARD_PTR(_name)             NULL
+#define STORAGE_AREA_DISCARD_INIT(_discard)
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
 /**
  * @brief	Storage area ioctl.
  *
@@ -218,6 +456,129 @@ int storage_area_erase(const struct storage_area *area, size_t sblk,
 int storage_area_ioctl(const struct storage_area *area,
 		       enum storage_area_ioctl_cmd cmd, void *data);
 
+/** storage area i/o statistics callback */
+typedef void (*storage_area_stats_cb_t)(const struct storage_area *area,
+					const struct storage_area_stats *stats,
+					void *ctx);
+
+/**
+ * @brief	Walk the i/o statistics of all storage areas that have been
+ *		used (CONFIG_STORAGE_AREA_STATS). The callback is called with
+ *		a copy of the statistics, it can block.
+ *
+ * @param cb	callback.
+ * @param ctx	callback context.
+ *
+ * @retval	0 on success else negative errno code.
+ */
+int storage_area_stats_foreach(storage_area_stats_cb_t cb, void *ctx);
+
+struct storage_area_async_req;
+
+/** storage area asynchronous request completion callback */
+typedef void (*storage_area_async_cb_t)(struct storage_area_async_req *req);
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+/** storage area asynchronous request */
+struct storage_area_async_req {
+	/** completion callback (optional), called from the work queue */
+	storage_area_async_cb_t cb;
+#ifdef CONFIG_POLL
+	/** completion signal (optional), raised with the result */
+	struct k_poll_signal *signal;
+#endif
+	/** result of the request, valid after completion */
+	int rc;
+	/* internally used */
+	struct k_work work;
+	const struct storage_area *area;
+	uint8_t op;
+	sa_off_t offset;
+	const struct storage_area_iovec *iovec;
+	size_t cnt;
+	bool busy;
+};
+#endif
+
+/**
+ * @brief	Initialize an asynchronous request, when CONFIG_POLL is enabled
+ *		a poll signal can be assigned to req->signal after the
+ *		initialization.
+ *
+ * @param req	request.
+ * @param cb	completion callback (can be NULL).
+ *
+ * @retval	0 on success else negative errno code (-ENOTSUP when
+ *		CONFIG_STORAGE_AREA_ASYNC is disabled).
+ */
+int storage_area_async_init(struct storage_area_async_req *req,
+			    storage_area_async_cb_t cb);
+
+/**
+ * @brief	 Request an asynchronous read of iovec from storage area. The
+ *		 request (and the iovec) should remain valid until completion.
+ *
+ * @param area   storage area.
+ * @param offset offset in storage area (byte).
+ * @param iovec  io vector for read.
+ * @param iovcnt iovec element count.
+ * @param req    request.
+ *
+ * @retval	 0 when the request is queued, -EBUSY when the request is
+ *		 already queued or running (it is done, and can be
+ *		 resubmitted, from its completion callback on), else negative
+ *		 errno code.
+ */
+int storage_area_readv_async(const struct storage_area *area, sa_off_t offset,
+			     const struct storage_area_iovec *iovec,
+			     size_t iovcnt, struct storage_area_async_req *req);
+
+/**
+ * @brief	 Request an asynchronous write of iovec to storage area. The
+ *		 request (and the iovec) should remain valid until completion.
+ *
+ * @param area   storage area.
+ * @param offset offset in storage area (byte).
+ * @param iovec  io vector to write.
+ * @param iovcnt iovec element count.
+ * @param req    request.
+ *
+ * @retval	 0 when the request is queued, -EBUSY when the request is
+ *		 already queued or running (it is done, and can be
+ *		 resubmitted, from its completion callback on), else negative
+ *		 errno code.
+ */
+int storage_area_writev_async(const struct storage_area *area, sa_off_t offset,
+			      const struct storage_area_iovec *iovec,
+			      size_t iovcnt, struct storage_area_async_req *req);
+
+/**
+ * @brief      Request an asynchronous erase of storage area. The request
+ *	       should remain valid until completion.
+ *
+ * @param area storage area.
+ * @param sblk start block
+ * @param bcnt number of blocks to erase.
+ * @param req  request.
+ *
+ * @retval     0 when the request is queued, -EBUSY when the request is
+ *	       already queued or running (it is done, and can be
+ *	       resubmitted, from its completion callback on), else negative
+ *	       errno code.
+ */
+int storage_area_erase_async(const struct storage_area *area, size_t sblk,
+			     size_t bcnt, struct storage_area_async_req *req);
+
+/**
+ * @brief	Wait for completion of an asynchronous request (not to be
+ *		called from a completion callback).
+ *
+ * @param req	request.
+ *
+ * @retval	result of the request.
+ */
+int storage_area_async_wait(struct storage_area_async_req *req);
+
 /**
  * @}
  */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief A write-back cache on top of a storage area
+ * @defgroup storage_area_cache Storage area write-back cache
+ * @ingroup storage_area
+ * @{
+ *
+ * The cache keeps writes to a wrapped storage area in a number of RAM lines.
+ * Adjacent writes to a line are merged and written to the wrapped storage
+ * area in one call when the line is flushed. Lines are flushed (oldest first)
+ * when a line is needed for a new write, on a STORAGE_AREA_IOCTL_FLUSH ioctl
+ * or after CONFIG_STORAGE_AREA_CACHE_FLUSH_DELAY ms. Reads return the cached
+ * data, erase drops the cached data of the erased blocks.
+ *
+ * The cache is defined with the same write-size, erase-size, size and
+ * properties as the wrapped storage area (this is verified on first use).
+ * Storage areas with STORAGE_AREA_PROP_AUTOERASE are not supported as the
+ * flush order differs from the write order. Data that is not flushed is lost
+ * on power failure.
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_CACHE_H_
+#define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_CACHE_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** write-back cache line */
+struct storage_area_cache_line {
+	/** storage area offset of the line */
+	sa_off_t offset;
+	/** cached (dirty) part of the line, empty when start == end */
+	size_t start;
+	size_t end;
+	/** order in which the line was taken into use */
+	uint32_t age;
+};
+
+/** Runtime state of a storage area write-back cache */
+struct storage_area_cache_data {
+	bool ready;
+	uint32_t age;
+#if defined(CONFIG_STORAGE_AREA_CACHE_FLUSH_DELAY) &&                          \
+	(CONFIG_STORAGE_AREA_CACHE_FLUSH_DELAY > 0)
+	struct k_work_delayable flush;
+	const struct storage_area_cache *cache;
+#endif
+};
+
+struct storage_area_cache {
+	const struct storage_area area;
+	const struct storage_area *backend;
+	uint8_t *buf;
+	struct storage_area_cache_line *lines;
+	const size_t lsize;
+	const size_t lcnt;
+	struct storage_area_cache_data *data;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
+};
+
+extern const struct storage_area_api storage_area_cache_rw_api;
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_CACHE_LOCK_DEFINE(_name)                                   \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_CACHE_LOCK(_name) .lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_CACHE_LOCK_DEFINE(_name)                                   \
+	BUILD_ASSERT(true, "")
+#define STORAGE_AREA_CACHE_LOCK(_name)
+#endif
+
+/**
+ * @brief Helper macro to create a write-back cache on top of a storage area
+ */
+#define STORAGE_AREA_CACHE(_name, _backend, _lsize, _lcnt, _ws, _es, _size,     \
+			   _props, _api)                                        \
+	{                                                                       \
+		.area =                                                         \
+			{                                                       \
+				.api = ((_ws == 0) ||                           \
+					((_ws & (_ws - 1)) != 0) ||             \
+					((_es % _ws) != 0) ||                   \
+					((_size % _es) != 0) ||                 \
+					((_lsize % _ws) != 0) ||                \
+					((_es % _lsize) != 0))                  \
+					       ? NULL                           \
+					       : _api,                          \
+				.write_size = _ws,                              \
+				.erase_size = _es,                              \
+				.erase_blocks = _size / _es,                    \
+				.props = _props,                                \
+			},                                                      \
+		.backend = _backend, .buf = _storage_area_##_name##_buf,        \
+		.lines = _storage_area_##_name##_lines, .lsize = _lsize,        \
+		.lcnt = _lcnt, .data = &(_storage_area_##_name##_data),         \
+		STORAGE_AREA_CACHE_LOCK(_name)                                  \
+	}
+
+/**
+ * @brief Define a write-back cache on top of a storage area
+ *
+ * @param _name	   storage area name: used by GET_STORAGE_AREA(_name)
+ * @param _backend wrapped storage area
+ * @param _lsize   cache line size (multiple of write-size, erase-size should
+ *                 be a multiple of _lsize)
+ * @param _lcnt    number of cache lines
+ * @param _ws      write-size (equal to the wrapped storage area write-size)
+ * @param _es	   erase-size (equal to the wrapped storage area erase-size)
+ * @param _size	   storage area size (equal to the wrapped storage area size)
+ * @param _props   storage area properties (equal to the wrapped storage area
+ *                 properties)
+ */
+#define STORAGE_AREA_CACHE_RW_DEFINE(_name, _backend, _lsize, _lcnt, _ws, _es,  \
+				     _size, _props)                             \
+	BUILD_ASSERT(_ws != 0, "Invalid write size");                           \
+	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
+	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
+	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	BUILD_ASSERT((_lsize % _ws) == 0, "Invalid line size");                 \
+	BUILD_ASSERT((_es % _lsize) == 0, "Invalid line size");                 \
+	BUILD_ASSERT(_lcnt != 0, "Invalid line count");                         \
+	static uint8_t _storage_area_##_name##_buf[_lcnt * _lsize];             \
+	static struct storage_area_cache_line                                   \
+		_storage_area_##_name##_lines[_lcnt];                           \
+	static struct storage_area_cache_data _storage_area_##_name##_data;     \
+	STORAGE_AREA_CACHE_LOCK_DEFINE(_name);                                  \
+	const struct storage_area_cache _storage_area_##_name =                 \
+		STORAGE_AREA_CACHE(_name, _backend, _lsize, _lcnt, _ws, _es,    \
+				   _size, _props, &storage_area_cache_rw_api)
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_CACHE_H_ */
@@ -9,11 +9,32 @@
  * @defgroup storage_area_disk Storage area on disk
  * @ingroup storage_area
  * @{
+ *
+ * An erase writes the erase value to the sectors of the blocks. When
+ * CONFIG_STORAGE_AREA_DISCARD is enabled a read-write storage area on disk
+ * supports STORAGE_AREA_IOCTL_DISCARD: discarded blocks are only remembered,
+ * their sectors read as erased without a disk access and the erase value is
+ * only written for a gap that is left by a write in a discarded block. With
+ * CONFIG_STORAGE_AREA_DISK_TRIM the sectors of discarded blocks are also
+ * trimmed on the disk (eeprom disks).
+ *
+ * Each storage area on disk has a buffer of CONFIG_STORAGE_AREA_DISK_READAHEAD
+ * sectors (at least one) that is used for partial sectors and to write the
+ * erase value in chunks, so no sector sized buffers are needed on the stack.
+ *
+ * Reads of whole sectors go directly to the caller's buffers with a single
+ * disk read for each run of sectors. Partial sectors are read through the
+ * buffer, when CONFIG_STORAGE_AREA_DISK_READAHEAD is not 0 the sectors in the
+ * buffer are kept between reads as readahead (e.g. for the sequential record
+ * header reads of a storage area store). The readahead is dropped on each
+ * write, erase or discard through the storage area, changes made to the disk
+ * outside the storage area are not seen.
  */
 
 #ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_DISK_H_
 #define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_DISK_H_
 
+#include <zephyr/kernel.h>
 #include <zephyr/storage/disk_access.h>
 #include <zephyr/storage/storage_area/storage_area.h>
 
@@ -21,21 +42,58 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Runtime state of a storage area on disk, the disk is initialized and
+ *        its geometry is validated once on first use and the result is cached.
+ */
+struct storage_area_disk_data {
+	bool ready;
+	/** sectors in the buffer (relative to the area start) */
+	uint32_t buf_start;
+	uint32_t buf_cnt;
+};
+
 struct storage_area_disk {
 	const struct storage_area area;
 	const uint32_t start;
 	const size_t ssize;
 	const char *name;
+	struct storage_area_disk_data *data;
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	uint32_t *discard;
+#endif
+	uint8_t *buf;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
 };
 
 extern const struct storage_area_api storage_area_disk_rw_api;
 extern const struct storage_area_api storage_area_disk_ro_api;
 
+/** sectors in the buffer of a storage area on disk */
+#define STORAGE_AREA_DISK_BUF_SECTORS MAX(1, CONFIG_STORAGE_AREA_DISK_READAHEAD)
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_DISK_BUF_DEFINE(_name, _ssize)                             \
+	static uint8_t _storage_area_##_name##_buf                              \
+		[(_ssize) * STORAGE_AREA_DISK_BUF_SECTORS];                     \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_DISK_BUF(_name)                                            \
+	.buf = _storage_area_##_name##_buf,                                     \
+	.lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_DISK_BUF_DEFINE(_name, _ssize)                             \
+	static uint8_t _storage_area_##_name##_buf                              \
+		[(_ssize) * STORAGE_AREA_DISK_BUF_SECTORS]
+#define STORAGE_AREA_DISK_BUF(_name) .buf = _storage_area_##_name##_buf,
+#endif
+
 /**
  * @brief Helper macro to create a storage area on top of a disk
  */
-#define STORAGE_AREA_DISK(_dname, _start, _ssize, _ws, _es, _size, _props,      \
-			  _api)                                                 \
+#define STORAGE_AREA_DISK(_name, _dname, _start, _ssize, _ws, _es, _size,       \
+			  _props, _api, _data, _discard)                        \
 	{                                                                       \
 		.area =                                                         \
 			{                                                       \
@@ -51,6 +109,8 @@ extern const struct storage_area_api storage_area_disk_ro_api;
 				.props = _props | STORAGE_AREA_PROP_FOVRWRITE,  \
 			},                                                      \
 		.name = _dname, .start = _start, .ssize = _ssize,               \
+		.data = _data, STORAGE_AREA_DISCARD_INIT(_discard)              \
+		STORAGE_AREA_DISK_BUF(_name)                                    \
 	}
 
 /**
@@ -71,9 +131,14 @@ extern const struct storage_area_api storage_area_disk_ro_api;
 	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
 	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
 	BUILD_ASSERT((_ssize % _ws) == 0, "Invalid sector size");               \
+	static struct storage_area_disk_data _storage_area_##_name##_data;      \
+	STORAGE_AREA_DISCARD_DEFINE(_name, _size / _es);                        \
+	STORAGE_AREA_DISK_BUF_DEFINE(_name, _ssize);                            \
 	const struct storage_area_disk _storage_area_##_name =                  \
-		STORAGE_AREA_DISK(_dname, _start, _ssize, _ws, _es, _size,      \
-				  _props, &storage_area_disk_rw_api)
+		STORAGE_AREA_DISK(_name, _dname, _start, _ssize, _ws, _es,      \
+				  _size, _props, &storage_area_disk_rw_api,     \
+				  &(_storage_area_##_name##_data),              \
+				  STORAGE_AREA_DISCARD_PTR(_name))
 
 /**
  * @brief Define a read-only storage area on top of a disk
@@ -92,9 +157,12 @@ extern const struct storage_area_api storage_area_disk_ro_api;
 	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
 	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
 	BUILD_ASSERT((_ssize % _ws) == 0, "Invalid sector size");               \
+	static struct storage_area_disk_data _storage_area_##_name##_data;      \
+	STORAGE_AREA_DISK_BUF_DEFINE(_name, _ssize);                            \
 	const struct storage_area_disk _storage_area_##_name =                  \
-		STORAGE_AREA_DISK(_dname, _start, _ssize, _ws, _es, _size,      \
-				  _props, &storage_area_disk_ro_api)
+		STORAGE_AREA_DISK(_name, _dname, _start, _ssize, _ws, _es,      \
+				  _size, _props, &storage_area_disk_ro_api,     \
+				  &(_storage_area_##_name##_data), NULL)
 
 /**
  * @}
@@ -9,6 +9,12 @@
  * @defgroup storage_area_eeprom Storage area on eeprom
  * @ingroup storage_area
  * @{
+ *
+ * An erase fills the blocks with the erase value. When
+ * CONFIG_STORAGE_AREA_DISCARD is enabled a read-write storage area on eeprom
+ * supports STORAGE_AREA_IOCTL_DISCARD: discarded blocks are only remembered,
+ * they read as erased without an eeprom access and the erase value is only
+ * written for a gap that is left by a write in a discarded block.
  */
 
 #ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_EEPROM_H_
@@ -21,10 +27,22 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Runtime state of a storage area on eeprom, the eeprom device and area
+ *        size are validated once on first use and the result is cached.
+ */
+struct storage_area_eeprom_data {
+	bool ready;
+};
+
 struct storage_area_eeprom {
 	const struct storage_area area;
 	const struct device *dev;
 	const off_t doffset;
+	struct storage_area_eeprom_data *data;
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	uint32_t *discard;
+#endif
 };
 
 extern const struct storage_area_api storage_area_eeprom_rw_api;
@@ -33,7 +51,8 @@ extern const struct storage_area_api storage_area_eeprom_ro_api;
 /**
  * @brief Helper macro to create a storage area on top of an eeprom device
  */
-#define STORAGE_AREA_EEPROM(_dev, _doffset, _ws, _es, _size, _props, _api)      \
+#define STORAGE_AREA_EEPROM(_dev, _doffset, _ws, _es, _size, _props, _api,      \
+			    _data, _discard)                                    \
 	{                                                                       \
 		.area =                                                         \
 			{                                                       \
@@ -48,7 +67,8 @@ extern const struct storage_area_api storage_area_eeprom_ro_api;
 				.erase_blocks = _size / _es,                    \
 				.props = _props | STORAGE_AREA_PROP_FOVRWRITE,  \
 			},                                                      \
-		.dev = _dev, .doffset = _doffset,                               \
+		.dev = _dev, .doffset = _doffset, .data = _data,                \
+		STORAGE_AREA_DISCARD_INIT(_discard)                             \
 	}
 
 /**
@@ -68,9 +88,13 @@ extern const struct storage_area_api storage_area_eeprom_ro_api;
 	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
 	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
 	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	static struct storage_area_eeprom_data _storage_area_##_name##_data;    \
+	STORAGE_AREA_DISCARD_DEFINE(_name, _size / _es);                        \
 	const struct storage_area_eeprom _storage_area_##_name =                \
 		STORAGE_AREA_EEPROM(_dev, _doffset, _ws, _es, _size, _props,    \
-				    &storage_area_eeprom_rw_api);
+				    &storage_area_eeprom_rw_api,                \
+				    &(_storage_area_##_name##_data),            \
+				    STORAGE_AREA_DISCARD_PTR(_name));
 
 /**
  * @brief Define a read-only storage area on top of an eeprom device
@@ -88,9 +112,11 @@ extern const struct storage_area_api storage_area_eeprom_ro_api;
 	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
 	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
 	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	static struct storage_area_eeprom_data _storage_area_##_name##_data;    \
 	const struct storage_area_eeprom _storage_area_##_name =                \
 		STORAGE_AREA_EEPROM(_dev, _doffset, _ws, _es, _size, _props,    \
-				    &storage_area_eeprom_ro_api);
+				    &storage_area_eeprom_ro_api,                \
+				    &(_storage_area_##_name##_data), NULL);
 
 /**
  * @}
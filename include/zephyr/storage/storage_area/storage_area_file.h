@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief A storage area on a host file (native_sim)
+ * @defgroup storage_area_file Storage area on a host file
+ * @ingroup storage_area
+ * @{
+ *
+ * The host file is mapped in the process on first use, reads and writes are
+ * copies to and from the mapping. A new (or too small) file is extended and
+ * filled with the erase value. The mapping is returned by the
+ * STORAGE_AREA_IOCTL_XIPADDRESS ioctl and written to the file by the
+ * STORAGE_AREA_IOCTL_FLUSH ioctl. A NULL path uses a temporary file that is
+ * removed when the process exits (e.g. for tests).
+ *
+ * The storage area properties select the emulated semantics:
+ * STORAGE_AREA_PROP_ZEROERASE sets the erase value to 0x00 (default 0xff),
+ * without STORAGE_AREA_PROP_FOVRWRITE a write can only change bits from
+ * the erase value (as on nor flash), STORAGE_AREA_PROP_AUTOERASE erases a
+ * block when a write starts at the block.
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_FILE_H_
+#define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_FILE_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Runtime state of a storage area on a host file */
+struct storage_area_file_data {
+	bool ready;
+	uint8_t *map;
+};
+
+struct storage_area_file {
+	const struct storage_area area;
+	const char *path;
+	struct storage_area_file_data *data;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
+};
+
+extern const struct storage_area_api storage_area_file_rw_api;
+extern const struct storage_area_api storage_area_file_ro_api;
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_FILE_LOCK_DEFINE(_name)                                    \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_FILE_LOCK(_name) .lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_FILE_LOCK_DEFINE(_name) BUILD_ASSERT(true, "")
+#define STORAGE_AREA_FILE_LOCK(_name)
+#endif
+
+/**
+ * @brief Helper macro to create a storage area on a host file
+ */
+#define STORAGE_AREA_FILE(_name, _path, _ws, _es, _size, _props, _api)         \
+	{                                                                       \
+		.area =                                                         \
+			{                                                       \
+				.api = ((_ws == 0) ||                           \
+					((_ws & (_ws - 1)) != 0) ||             \
+					((_es % _ws) != 0) ||                   \
+					((_size % _es) != 0))                   \
+					       ? NULL                           \
+					       : _api,                          \
+				.write_size = _ws,                              \
+				.erase_size = _es,                              \
+				.erase_blocks = _size / _es,                    \
+				.props = _props,                                \
+			},                                                      \
+		.path = _path, .data = &(_storage_area_##_name##_data),         \
+		STORAGE_AREA_FILE_LOCK(_name)                                   \
+	}
+
+#define STORAGE_AREA_FILE_DEFINE(_name, _path, _ws, _es, _size, _props, _api)  \
+	BUILD_ASSERT(_ws != 0, "Invalid write size");                           \
+	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
+	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
+	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	static struct storage_area_file_data _storage_area_##_name##_data;      \
+	STORAGE_AREA_FILE_LOCK_DEFINE(_name);                                   \
+	const struct storage_area_file _storage_area_##_name =                  \
+		STORAGE_AREA_FILE(_name, _path, _ws, _es, _size, _props, _api)
+
+/**
+ * @brief Define a read-write storage area on a host file
+ *
+ * @param _name	   storage area name: used by GET_STORAGE_AREA(_name)
+ * @param _path    host file path (NULL: temporary file)
+ * @param _ws      write-size
+ * @param _es	   erase-size
+ * @param _size	   storage area size
+ * @param _props   storage area properties (see storage_area.h)
+ */
+#define STORAGE_AREA_FILE_RW_DEFINE(_name, _path, _ws, _es, _size, _props)     \
+	STORAGE_AREA_FILE_DEFINE(_name, _path, _ws, _es, _size, _props,         \
+				 &storage_area_file_rw_api)
+
+/**
+ * @brief Define a read-only storage area on a host file
+ *
+ * see @ref STORAGE_AREA_FILE_RW_DEFINE for parameters
+ */
+#define STORAGE_AREA_FILE_RO_DEFINE(_name, _path, _ws, _es, _size, _props)     \
+	STORAGE_AREA_FILE_DEFINE(_name, _path, _ws, _es, _size, _props,         \
+				 &storage_area_file_ro_api)
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_FILE_H_ */
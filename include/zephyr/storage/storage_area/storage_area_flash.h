@@ -23,11 +23,20 @@ extern "C" {
 
 #define STORAGE_AREA_FLASH_NO_XIP (-1)
 
+/**
+ * @brief Runtime state of a storage area on flash, the flash device and area
+ *        geometry are validated once on first use and the result is cached.
+ */
+struct storage_area_flash_data {
+	bool ready;
+};
+
 struct storage_area_flash {
 	const struct storage_area area;
 	const struct device *dev;
 	const off_t doffset;
 	uintptr_t xip_address;
+	struct storage_area_flash_data *data;
 };
 
 extern const struct storage_area_api storage_area_flash_rw_api;
@@ -36,7 +45,8 @@ extern const struct storage_area_api storage_area_flash_ro_api;
 /**
  * @brief Helper macro to create a storage area on top of a flash device
  */
-#define STORAGE_AREA_FLASH(_dev, _doffset, _xip, _ws, _es, _size, _props, _api) \
+#define STORAGE_AREA_FLASH(_dev, _doffset, _xip, _ws, _es, _size, _props, _api, \
+			   _data)                                               \
 	{                                                                       \
 		.area =                                                         \
 			{                                                       \
@@ -52,6 +62,7 @@ extern const struct storage_area_api storage_area_flash_ro_api;
 				.props = _props,                                \
 			},                                                      \
 		.dev = _dev, .doffset = _doffset, .xip_address = _xip,          \
+		.data = _data,                                                  \
 	}
 
 /**
@@ -73,9 +84,11 @@ extern const struct storage_area_api storage_area_flash_ro_api;
 	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
 	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
 	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	static struct storage_area_flash_data _storage_area_##_name##_data;     \
 	const struct storage_area_flash _storage_area_##_name =                 \
 		STORAGE_AREA_FLASH(_dev, _doffset, _xip, _ws, _es, _size,       \
-				   _props, &storage_area_flash_rw_api)
+				   _props, &storage_area_flash_rw_api,          \
+				   &(_storage_area_##_name##_data))
 
 /**
  * @brief Define a read-only storage area on top of a flash device
@@ -93,9 +106,11 @@ extern const struct storage_area_api storage_area_flash_ro_api;
 	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
 	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
 	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	static struct storage_area_flash_data _storage_area_##_name##_data;     \
 	const struct storage_area_flash _storage_area_##_name =                 \
 		STORAGE_AREA_FLASH(_dev, _doffset, _xip, _ws, _es, _size,       \
-				   _props, &storage_area_flash_ro_api)
+				   _props, &storage_area_flash_ro_api,          \
+				   &(_storage_area_##_name##_data))
 /**
  * @}
  */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief A storage area mirrored over multiple storage areas
+ * @defgroup storage_area_mirror Storage area mirror
+ * @ingroup storage_area
+ * @{
+ *
+ * The mirror keeps the same data on N storage areas (replicas) with equal
+ * definition. Writes and erases are done on all replicas, reads and blank
+ * checks are done on one replica. The replica used for a read is selected
+ * round-robin or as the replica with the least reads in progress (see
+ * CONFIG_STORAGE_AREA_MIRROR_READ). A read that fails on a replica is
+ * retried on the other replicas.
+ *
+ * A replica that fails a write, erase, discard or flush no longer holds the
+ * mirror data: it is marked failed and is not used until the failed replicas
+ * are restored (STORAGE_AREA_IOCTL_MIRROR_RESTORE, after the application has
+ * resynchronized them). The failed replicas are retrieved as a bitmask with
+ * STORAGE_AREA_IOCTL_MIRROR_FAILED. When all replicas failed the mirror
+ * returns -EIO.
+ *
+ * Reads and blank checks do not take the mirror lock, so reads on different
+ * replicas run concurrently. Writes and erases hold the lock and return after
+ * all replicas are updated: a read that starts after a write has returned
+ * gets the new data from any replica. A read that overlaps a write can return
+ * old or new data, as it does on a single storage area.
+ *
+ * The definition of the replicas is verified on first use.
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_MIRROR_H_
+#define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_MIRROR_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Runtime state of a storage area mirror */
+struct storage_area_mirror_data {
+	bool ready;
+	/* round-robin read counter */
+	atomic_t next;
+	/* failed replicas (bitmask) */
+	atomic_t failed;
+};
+
+struct storage_area_mirror {
+	const struct storage_area area;
+	const struct storage_area *const *replicas;
+	/* reads in progress on each replica */
+	atomic_t *busy;
+	const size_t cnt;
+	struct storage_area_mirror_data *data;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
+};
+
+extern const struct storage_area_api storage_area_mirror_rw_api;
+extern const struct storage_area_api storage_area_mirror_ro_api;
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_MIRROR_LOCK_DEFINE(_name)                                  \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_MIRROR_LOCK(_name) .lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_MIRROR_LOCK_DEFINE(_name)                                  \
+	BUILD_ASSERT(true, "")
+#define STORAGE_AREA_MIRROR_LOCK(_name)
+#endif
+
+#define STORAGE_AREA_MIRROR_CNT(_name)                                          \
+	ARRAY_SIZE(_storage_area_##_name##_replicas)
+
+/**
+ * @brief Helper macro to create a mirror over storage areas
+ */
+#define STORAGE_AREA_MIRROR(_name, _ws, _es, _size, _props, _api)              \
+	{                                                                       \
+		.area =                                                         \
+			{                                                       \
+				.api = ((_ws == 0) ||                           \
+					((_ws & (_ws - 1)) != 0) ||             \
+					((_es % _ws) != 0) ||                   \
+					((_size % _es) != 0))                   \
+					       ? NULL                           \
+					       : _api,                          \
+				.write_size = _ws,                              \
+				.erase_size = _es,                              \
+				.erase_blocks = _size / _es,                    \
+				.props = _props,                                \
+			},                                                      \
+		.replicas = _storage_area_##_name##_replicas,                   \
+		.busy = _storage_area_##_name##_busy,                           \
+		.cnt = STORAGE_AREA_MIRROR_CNT(_name),                          \
+		.data = &(_storage_area_##_name##_data),                        \
+		STORAGE_AREA_MIRROR_LOCK(_name)                                 \
+	}
+
+#define STORAGE_AREA_MIRROR_DEFINE(_name, _ws, _es, _size, _props, _api, ...)  \
+	BUILD_ASSERT(_ws != 0, "Invalid write size");                           \
+	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
+	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
+	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	static const struct storage_area *const                                 \
+		_storage_area_##_name##_replicas[] = {__VA_ARGS__};             \
+	BUILD_ASSERT(STORAGE_AREA_MIRROR_CNT(_name) <= 32,                      \
+		     "Too many replicas");                                      \
+	static atomic_t                                                         \
+		_storage_area_##_name##_busy[STORAGE_AREA_MIRROR_CNT(_name)];   \
+	static struct storage_area_mirror_data _storage_area_##_name##_data;    \
+	STORAGE_AREA_MIRROR_LOCK_DEFINE(_name);                                 \
+	const struct storage_area_mirror _storage_area_##_name =                \
+		STORAGE_AREA_MIRROR(_name, _ws, _es, _size, _props, _api)
+
+/**
+ * @brief Define a read-write mirror over storage areas
+ *
+ * @param _name	   storage area name: used by GET_STORAGE_AREA(_name)
+ * @param _ws      write-size (equal to the replica write-size)
+ * @param _es	   erase-size (equal to the replica erase-size)
+ * @param _size	   storage area size (equal to the replica size)
+ * @param _props   storage area properties (equal to the replica properties)
+ * @param ...      replicas (pointers to storage areas)
+ */
+#define STORAGE_AREA_MIRROR_RW_DEFINE(_name, _ws, _es, _size, _props, ...)     \
+	STORAGE_AREA_MIRROR_DEFINE(_name, _ws, _es, _size, _props,              \
+				   &storage_area_mirror_rw_api, __VA_ARGS__)
+
+/**
+ * @brief Define a read-only mirror over storage areas
+ *
+ * see @ref STORAGE_AREA_MIRROR_RW_DEFINE for parameters
+ */
+#define STORAGE_AREA_MIRROR_RO_DEFINE(_name, _ws, _es, _size, _props, ...)     \
+	STORAGE_AREA_MIRROR_DEFINE(_name, _ws, _es, _size, _props,              \
+				   &storage_area_mirror_ro_api, __VA_ARGS__)
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_MIRROR_H_ */
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief A storage area on a simulated nor flash
+ * @defgroup storage_area_nor_sim Storage area on a simulated nor flash
+ * @ingroup storage_area
+ * @{
+ *
+ * The simulated nor flash keeps its data in RAM and follows the nor flash
+ * rules strictly: writes start at a write block, a write can only change bits
+ * from the erase value (a write that needs to change a bit back is refused
+ * with -EIO) and a write block can only be programmed a limited number of
+ * times between erases: once, or CONFIG_STORAGE_AREA_NOR_SIM_PROGRAM_LIMIT
+ * times when the storage area has STORAGE_AREA_PROP_LOVRWRITE. Refused writes
+ * leave the data unchanged. STORAGE_AREA_PROP_AUTOERASE erases a block when a
+ * write starts at the block, STORAGE_AREA_PROP_FOVRWRITE is not supported.
+ *
+ * Each write takes a program time per byte and each erased block an erase
+ * time. The time is added to a virtual clock and, when
+ * CONFIG_STORAGE_AREA_NOR_SIM_BUSY_WAIT is enabled, spent in k_busy_wait().
+ * The operation counters and the virtual clock are retrieved with the
+ * STORAGE_AREA_IOCTL_NOR_SIM_STATS ioctl, the erase count of a block with the
+ * STORAGE_AREA_IOCTL_NOR_SIM_WEAR ioctl.
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_NOR_SIM_H_
+#define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_NOR_SIM_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Operation counters of a simulated nor flash */
+struct storage_area_nor_sim_stats {
+	/** read, write and block erase operations */
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t erases;
+	/** writes refused because they break the nor flash rules */
+	uint32_t violations;
+	uint64_t read_bytes;
+	uint64_t write_bytes;
+	/** virtual clock: total program and erase time in us */
+	uint64_t busy_us;
+};
+
+/** Erase count of a block of a simulated nor flash */
+struct storage_area_nor_sim_wear {
+	/** block (input) */
+	size_t blk;
+	/** erase count (output) */
+	uint32_t erases;
+};
+
+/** Runtime state of a storage area on a simulated nor flash */
+struct storage_area_nor_sim_data {
+	bool ready;
+	/** program time remainder below 1 us */
+	uint32_t program_ns;
+	struct storage_area_nor_sim_stats stats;
+};
+
+struct storage_area_nor_sim {
+	const struct storage_area area;
+	/** flash content */
+	uint8_t *mem;
+	/** programs of each write block since its erase */
+	uint8_t *programs;
+	/** erase count of each block */
+	uint32_t *wear;
+	/** program time per byte (ns) and erase time per block (us) */
+	const uint32_t program_ns;
+	const uint32_t erase_us;
+	struct storage_area_nor_sim_data *data;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
+};
+
+extern const struct storage_area_api storage_area_nor_sim_rw_api;
+extern const struct storage_area_api storage_area_nor_sim_ro_api;
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_NOR_SIM_LOCK_DEFINE(_name)                                 \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_NOR_SIM_LOCK(_name)                                        \
+	.lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_NOR_SIM_LOCK_DEFINE(_name) BUILD_ASSERT(true, "")
+#define STORAGE_AREA_NOR_SIM_LOCK(_name)
+#endif
+
+/**
+ * @brief Helper macro to create a storage area on a simulated nor flash
+ */
+#define STORAGE_AREA_NOR_SIM(_name, _ws, _es, _size, _props, _program_ns,      \
+			     _erase_us, _api)                                   \
+	{                                                                       \
+		.area =                                                         \
+			{                                                       \
+				.api = ((_ws == 0) ||                           \
+					((_ws & (_ws - 1)) != 0) ||             \
+					((_es % _ws) != 0) ||                   \
+					((_size % _es) != 0))                   \
+					       ? NULL                           \
+					       : _api,                          \
+				.write_size = _ws,                              \
+				.erase_size = _es,                              \
+				.erase_blocks = _size / _es,                    \
+				.props = _props,                                \
+			},                                                      \
+		.mem = _storage_area_##_name##_mem,                             \
+		.programs = _storage_area_##_name##_programs,                   \
+		.wear = _storage_area_##_name##_wear,                           \
+		.program_ns = _program_ns, .erase_us = _erase_us,               \
+		.data = &(_storage_area_##_name##_data),                        \
+		STORAGE_AREA_NOR_SIM_LOCK(_name)                                \
+	}
+
+#define STORAGE_AREA_NOR_SIM_DEFINE(_name, _ws, _es, _size, _props,            \
+				    _program_ns, _erase_us, _api)               \
+	BUILD_ASSERT(_ws != 0, "Invalid write size");                           \
+	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
+	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
+	BUILD_ASSERT((_size % _es) == 0, "Invalid size");                       \
+	BUILD_ASSERT(((_props) & STORAGE_AREA_PROP_FOVRWRITE) == 0,             \
+		     "Nor flash can not be overwritten");                       \
+	static uint8_t _storage_area_##_name##_mem[_size];                      \
+	static uint8_t _storage_area_##_name##_programs[(_size) / (_ws)];       \
+	static uint32_t _storage_area_##_name##_wear[(_size) / (_es)];          \
+	static struct storage_area_nor_sim_data _storage_area_##_name##_data;   \
+	STORAGE_AREA_NOR_SIM_LOCK_DEFINE(_name);                                \
+	const struct storage_area_nor_sim _storage_area_##_name =               \
+		STORAGE_AREA_NOR_SIM(_name, _ws, _es, _size, _props,            \
+				     _program_ns, _erase_us, _api)
+
+/**
+ * @brief Define a read-write storage area on a simulated nor flash
+ *
+ * @param _name	      storage area name: used by GET_STORAGE_AREA(_name)
+ * @param _ws         write-size
+ * @param _es	      erase-size
+ * @param _size	      storage area size
+ * @param _props      storage area properties (see storage_area.h)
+ * @param _program_ns program time per byte (ns)
+ * @param _erase_us   erase time per block (us)
+ */
+#define STORAGE_AREA_NOR_SIM_RW_DEFINE(_name, _ws, _es, _size, _props,         \
+				       _program_ns, _erase_us)                  \
+	STORAGE_AREA_NOR_SIM_DEFINE(_name, _ws, _es, _size, _props,             \
+				    _program_ns, _erase_us,                     \
+				    &storage_area_nor_sim_rw_api)
+
+/**
+ * @brief Define a read-only storage area on a simulated nor flash
+ *
+ * see @ref STORAGE_AREA_NOR_SIM_RW_DEFINE for parameters
+ */
+#define STORAGE_AREA_NOR_SIM_RO_DEFINE(_name, _ws, _es, _size, _props,         \
+				       _program_ns, _erase_us)                  \
+	STORAGE_AREA_NOR_SIM_DEFINE(_name, _ws, _es, _size, _props,             \
+				    _program_ns, _erase_us,                     \
+				    &storage_area_nor_sim_ro_api)
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_NOR_SIM_H_ */
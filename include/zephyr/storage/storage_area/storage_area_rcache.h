@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief A read cache on top of a storage area
+ * @defgroup storage_area_rcache Storage area read cache
+ * @ingroup storage_area
+ * @{
+ *
+ * The read cache keeps a number of aligned lines of a wrapped storage area in
+ * RAM. A read that misses the cache reads a complete line from the wrapped
+ * storage area, the least recently used line is replaced. This avoids
+ * repeated small reads of the same region (e.g. record headers during a
+ * storage area store walk). Writes and erases are passed to the wrapped
+ * storage area and invalidate the lines they overlap. The hit and miss
+ * counters are retrieved with a STORAGE_AREA_IOCTL_CACHE_STATS ioctl.
+ *
+ * The read cache is defined with the same write-size, erase-size, size and
+ * properties as the wrapped storage area (this is verified on first use).
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_RCACHE_H_
+#define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_RCACHE_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** read cache line */
+struct storage_area_rcache_line {
+	/** storage area offset of the line */
+	sa_off_t offset;
+	/** last use of the line */
+	uint32_t used;
+	bool valid;
+};
+
+/** Runtime state of a storage area read cache */
+struct storage_area_rcache_data {
+	bool ready;
+	uint32_t clock;
+	struct storage_area_cache_stats stats;
+};
+
+struct storage_area_rcache {
+	const struct storage_area area;
+	const struct storage_area *backend;
+	uint8_t *buf;
+	struct storage_area_rcache_line *lines;
+	const size_t lsize;
+	const size_t lcnt;
+	struct storage_area_rcache_data *data;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
+};
+
+extern const struct storage_area_api storage_area_rcache_rw_api;
+extern const struct storage_area_api storage_area_rcache_ro_api;
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_RCACHE_LOCK_DEFINE(_name)                                  \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_RCACHE_LOCK(_name) .lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_RCACHE_LOCK_DEFINE(_name)                                  \
+	BUILD_ASSERT(true, "")
+#define STORAGE_AREA_RCACHE_LOCK(_name)
+#endif
+
+/**
+ * @brief Helper macro to create a read cache on top of a storage area
+ */
+#define STORAGE_AREA_RCACHE(_name, _backend, _lsize, _lcnt, _ws, _es, _size,    \
+			    _props, _api)                                       \
+	{                                                                       \
+		.area =                                                         \
+			{                                                       \
+				.api = ((_ws == 0) ||                           \
+					((_ws & (_ws - 1)) != 0) ||             \
+					((_es % _ws) != 0) ||                   \
+					((_size % _es) != 0) ||                 \
+					((_es % _lsize) != 0))                  \
+					       ? NULL                           \
+					       : _api,                          \
+				.write_size = _ws,                              \
+				.erase_size = _es,                              \
+				.erase_blocks = _size / _es,                    \
+				.props = _props,                                \
+			},                                                      \
+		.backend = _backend, .buf = _storage_area_##_name##_buf,        \
+		.lines = _storage_area_##_name##_lines, .lsize = _lsize,        \
+		.lcnt = _lcnt, .data = &(_storage_area_##_name##_data),         \
+		STORAGE_AREA_RCACHE_LOCK(_name)                                 \
+	}
+
+#define STORAGE_AREA_RCACHE_DEFINE(_name, _backend, _lsize, _lcnt, _ws, _es,    \
+				   _size, _props, _api)                         \
+	BUILD_ASSERT(_ws != 0, "Invalid write size");                           \
+	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
+	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
+	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	BUILD_ASSERT((_lsize != 0) && ((_es % _lsize) == 0),                    \
+		     "Invalid line size");                                      \
+	BUILD_ASSERT(_lcnt != 0, "Invalid line count");                         \
+	static uint8_t _storage_area_##_name##_buf[_lcnt * _lsize];             \
+	static struct storage_area_rcache_line                                  \
+		_storage_area_##_name##_lines[_lcnt];                           \
+	static struct storage_area_rcache_data _storage_area_##_name##_data;    \
+	STORAGE_AREA_RCACHE_LOCK_DEFINE(_name);                                 \
+	const struct storage_area_rcache _storage_area_##_name =                \
+		STORAGE_AREA_RCACHE(_name, _backend, _lsize, _lcnt, _ws, _es,   \
+				    _size, _props, _api)
+
+/**
+ * @brief Define a read-write read cache on top of a storage area
+ *
+ * @param _name	   storage area name: used by GET_STORAGE_AREA(_name)
+ * @param _backend wrapped storage area
+ * @param _lsize   cache line size (erase-size should be a multiple of _lsize)
+ * @param _lcnt    number of cache lines
+ * @param _ws      write-size (equal to the wrapped storage area write-size)
+ * @param _es	   erase-size (equal to the wrapped storage area erase-size)
+ * @param _size	   storage area size (equal to the wrapped storage area size)
+ * @param _props   storage area properties (equal to the wrapped storage area
+ *                 properties)
+ */
+#define STORAGE_AREA_RCACHE_RW_DEFINE(_name, _backend, _lsize, _lcnt, _ws, _es, \
+				      _size, _props)                            \
+	STORAGE_AREA_RCACHE_DEFINE(_name, _backend, _lsize, _lcnt, _ws, _es,    \
+				   _size, _props, &storage_area_rcache_rw_api)
+
+/**
+ * @brief Define a read-only read cache on top of a storage area
+ *
+ * see @ref STORAGE_AREA_RCACHE_RW_DEFINE for parameters
+ */
+#define STORAGE_AREA_RCACHE_RO_DEFINE(_name, _backend, _lsize, _lcnt, _ws, _es, \
+				      _size, _props)                            \
+	STORAGE_AREA_RCACHE_DEFINE(_name, _backend, _lsize, _lcnt, _ws, _es,    \
+				   _size, _props, &storage_area_rcache_ro_api)
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_RCACHE_H_ */
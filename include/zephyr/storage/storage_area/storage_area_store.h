@@ -29,7 +29,9 @@
  * `compacted`. The `advance` method will simply take into use a next sector.
  * The `compact` method will move certain records to the front of the storage
  * area store. The `compact` method uses a callback routine `move` to
- * determine if a record should be kept.
+ * determine if a record should be kept. A compaction can also be done in
+ * steps with a limited amount of work (`compact_step`), other operations on
+ * the store can be done in between steps.
  *
  * At the start of each sector a configurable `cookie` is (optionally) added,
  * this `cookie` can be used to describe the data format and or a data version
@@ -78,6 +80,22 @@
  * (if the storage area allows it). Updating the part of data that is not
  * included in the crc calculation can be used to mark a record as invalid.
  *
+ * When CONFIG_STORAGE_AREA_STORE_SUMMARY is enabled a sector is closed with a
+ * summary (record count, first and last record location, wrapcnt and an
+ * optional bloom filter of record keys) when the store is advanced. Sectors
+ * with an empty summary are skipped without scanning, and
+ * storage_area_record_find() skips sectors whose bloom filter excludes the
+ * searched key. Sectors without a summary (e.g. the current write sector) are
+ * scanned record by record.
+ *
+ * When CONFIG_STORAGE_AREA_STORE_WEAR is enabled the erases of each erase
+ * block are counted (storage_area_store_get_wear()), optionally the counter
+ * is kept after the sector cookie (CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST). A
+ * store that is mounted as a simple circular buffer skips retired erase blocks
+ * (storage_area_store_retire_block()) and erase blocks that have reached the
+ * wear limit (storage_area_store_set_wear_limit()). A persistent circular
+ * buffer does not skip erase blocks: this would break the spare sectors.
+ *
  * @defgroup storage_area_store Storage area store
  * @ingroup storage_apis
  * @{
@@ -94,6 +112,23 @@
 extern "C" {
 #endif
 
+/* fill buffer size and the fill elements of a write block (or less) */
+#define STORAGE_AREA_STORE_FILL_BUFSIZE                                        \
+	MAX(32, CONFIG_STORAGE_AREA_WRITE_BUFSIZE)
+#define STORAGE_AREA_STORE_FILL_IOVCNT                                         \
+	DIV_ROUND_UP(MAX(CONFIG_STORAGE_AREA_STORE_MOVE_BUFSIZE,                \
+			 STORAGE_AREA_STORE_FILL_BUFSIZE),                      \
+		     STORAGE_AREA_STORE_FILL_BUFSIZE)
+
+/**
+ * Maximum number of iovec elements in a write of a store to its storage area:
+ * the record elements, the header, the crc and the fill of the last write
+ * block.
+ */
+#define STORAGE_AREA_STORE_AREA_IOVCNT                                         \
+	(CONFIG_STORAGE_AREA_STORE_MAX_IOVCNT + 2 +                             \
+	 STORAGE_AREA_STORE_FILL_IOVCNT)
+
 struct storage_area_record;
 
 struct storage_area_store_compact_cb {
@@ -112,6 +147,40 @@ struct storage_area_store_compact_cb {
 
 struct storage_area_store;
 
+/** background compactor statistics */
+struct storage_area_store_compactor_stats {
+	/** compactions performed by the background compactor */
+	uint32_t runs;
+	/** foreground writes that had to wait for a compaction */
+	uint32_t waits;
+	/** foreground writes that failed with -ENOSPC after compaction */
+	uint32_t nospc;
+};
+
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+struct storage_area_store_compactor {
+	struct k_work work;
+	const struct storage_area_store *store;
+	const struct storage_area_store_compact_cb *cb;
+	/** compact when less than watermark bytes are free in the sector */
+	size_t watermark;
+	bool active;
+	struct storage_area_store_compactor_stats stats;
+};
+#endif
+
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+struct storage_area_store_preerase {
+	struct k_work work;
+	const struct storage_area_store *store;
+	/** erase units to keep erased ahead of the current erase unit */
+	size_t units;
+	/** erase units ahead of the current erase unit that are erased */
+	size_t erased;
+	bool active;
+};
+#endif
+
 struct storage_area_store_data {
 #ifdef CONFIG_STORAGE_AREA_STORE_SEMAPHORE
 	struct k_sem semaphore;
@@ -131,6 +200,37 @@ struct storage_area_store_data {
 	size_t loc;
 	/** current wrap counter */
 	uint8_t wrapcnt;
+	/** pending compaction: routines, victim walk position and sectors */
+	const struct storage_area_store_compact_cb *compact_cb;
+	size_t compact_sector;
+	size_t compact_loc;
+	size_t compact_size;
+	size_t compact_scnt;
+	/** the compaction for the block at compact_block started early */
+	bool compact_early;
+	size_t compact_block;
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+	/** background compactor */
+	struct storage_area_store_compactor compactor;
+#endif
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+	/** background erase of spare sectors */
+	struct storage_area_store_preerase preerase;
+#endif
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	/** key routine used to fill and check the sector bloom filters */
+	uint32_t (*key)(const struct storage_area_record *record);
+#endif
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	/** erase counters, one for each erase block (or sector) */
+	uint32_t *wear;
+	/** number of erase counters */
+	size_t wear_cnt;
+	/** erase blocks with this erase count are skipped (0: no limit) */
+	uint32_t wear_limit;
+	/** skip retired and worn erase blocks (circular buffer) */
+	bool wear_skip;
+#endif
 };
 
 struct storage_area_store {
@@ -206,7 +306,7 @@ int storage_area_store_wipe(const struct storage_area_store *store);
  *
  * @param store	 storage area store.
  * @param iovec	 io vector to write (see storage_area_iovec).
- * @param iovcnt iovec elements.
+ * @param iovcnt iovec elements (at most CONFIG_STORAGE_AREA_STORE_MAX_IOVCNT).
  *
  * @retval	0 on success else negative errno code.
  */
@@ -214,6 +314,23 @@ int storage_area_store_writev(const struct storage_area_store *store,
 			      const struct storage_area_iovec *iovec,
 			      size_t iovcnt);
 
+/**
+ * @brief	Write iovec to storage area store and return the written record.
+ *		The record location is taken under the store lock, so it is
+ *		also correct when a background compactor is writing.
+ *
+ * @param store	 storage area store.
+ * @param iovec	 io vector to write (see storage_area_iovec).
+ * @param iovcnt iovec elements (at most CONFIG_STORAGE_AREA_STORE_MAX_IOVCNT).
+ * @param record written record (can be NULL).
+ *
+ * @retval	0 on success else negative errno code.
+ */
+int storage_area_store_writev_record(const struct storage_area_store *store,
+				     const struct storage_area_iovec *iovec,
+				     size_t iovcnt,
+				     struct storage_area_record *record);
+
 /**
  * @brief	Write data to storage area store.
  *
@@ -251,6 +368,108 @@ int storage_area_store_advance(const struct storage_area_store *store);
 int storage_area_store_compact(const struct storage_area_store *store,
 			       const struct storage_area_store_compact_cb *cb);
 
+/**
+ * @brief	Perform a step of a compaction of a storage area store.
+ *		The first step takes a new sector into use, when this starts a
+ *		new block the records of the victim block that need keeping are
+ *		moved in steps that walk at most budget bytes of records (at
+ *		least one record). The store is released between steps, writes
+ *		in between are allowed as long as the pending compaction keeps
+ *		enough empty sectors (otherwise the write finishes it first).
+ *		Advance and compact finish a pending compaction. A compaction
+ *		interrupted by a reset is resumed when the store is mounted.
+ *		Between steps storage_area_record_next() also walks the
+ *		records of the victim block that are not moved yet.
+ *
+ * @param store	 storage area store.
+ * @param cb	 pointer to compact callback routines (the routines are used
+ *		 until the compaction is finished).
+ * @param budget record bytes to walk in a step.
+ *
+ * @retval	0 when the compaction is finished, -EAGAIN when more steps are
+ *		needed, else negative errno code.
+ */
+int storage_area_store_compact_step(
+	const struct storage_area_store *store,
+	const struct storage_area_store_compact_cb *cb, size_t budget);
+
+/**
+ * @brief	Start the background compactor of a (mounted) storage area
+ *		store. The compactor runs on a dedicated work queue. When less
+ *		than watermark bytes are free in the last sector of a block it
+ *		starts the compaction for the next block: the records of its
+ *		victim block are moved while writes keep filling the sector. A
+ *		new sector is only taken into use when a write does not fit.
+ *		Foreground writes that run out of space wait for a running
+ *		compactor and are retried. The compactor is stopped on unmount.
+ *		A compaction started early that is interrupted by a reset is
+ *		restarted at the next advance, records that were already moved
+ *		are moved again when the move routine keeps them.
+ *
+ * @param store	    storage area store.
+ * @param cb	    pointer to compact callback routines (the routines are
+ *		    called from the compactor work queue).
+ * @param watermark free space (in bytes) that triggers a compaction.
+ *
+ * @retval	0 on success else negative errno code (-ENOTSUP when
+ *		CONFIG_STORAGE_AREA_STORE_COMPACTOR is disabled).
+ */
+int storage_area_store_compactor_start(
+	const struct storage_area_store *store,
+	const struct storage_area_store_compact_cb *cb, size_t watermark);
+
+/**
+ * @brief	Stop the background compactor of a storage area store, waits
+ *		for a running compaction to finish.
+ *
+ * @param store	storage area store.
+ *
+ * @retval	0 on success else negative errno code.
+ */
+int storage_area_store_compactor_stop(const struct storage_area_store *store);
+
+/**
+ * @brief	Get the background compactor statistics.
+ *
+ * @param store	storage area store.
+ * @param stats	destination.
+ *
+ * @retval	0 on success else negative errno code.
+ */
+int storage_area_store_compactor_get_stats(
+	const struct storage_area_store *store,
+	struct storage_area_store_compactor_stats *stats);
+
+/**
+ * @brief	Start the background erase of the sectors ahead of the write
+ *		position of a (mounted) storage area store. The erase runs on
+ *		the background compactor work queue, advancing to a sector
+ *		that is erased in the background skips the erase. The sectors
+ *		are rounded up to erase blocks, the store needs one erase block
+ *		of spare sectors more than the erased sectors (the erased
+ *		sectors are taken from the spare sectors). The background
+ *		erase is stopped on unmount.
+ *
+ * @param store	  storage area store.
+ * @param sectors sectors to keep erased.
+ *
+ * @retval	0 on success else negative errno code (-ENOTSUP when
+ *		CONFIG_STORAGE_AREA_STORE_PREERASE is disabled or when the
+ *		storage area does not need an erase before write).
+ */
+int storage_area_store_preerase_start(const struct storage_area_store *store,
+				      size_t sectors);
+
+/**
+ * @brief	Stop the background erase of a storage area store, waits for
+ *		a running erase to finish.
+ *
+ * @param store	storage area store.
+ *
+ * @retval	0 on success else negative errno code.
+ */
+int storage_area_store_preerase_stop(const struct storage_area_store *store);
+
 /**
  * @brief	 Retrieve the next record of the store. To get the first
  *		 record set the record.store to NULL.
@@ -263,6 +482,37 @@ int storage_area_store_compact(const struct storage_area_store *store,
 int storage_area_record_next(const struct storage_area_store *store,
 			     struct storage_area_record *record);
 
+/**
+ * @brief	 Set the routine that calculates the key of a record. The key is
+ *		 added to the bloom filter of the sector summary when a sector
+ *		 is closed. The same routine should be used each time the store
+ *		 is used (it is best set before mounting).
+ *
+ * @param store	 storage area store.
+ * @param key	 key routine (NULL disables the bloom filter).
+ *
+ * @retval	 0 on success else negative errno code (-ENOTSUP when
+ *		 CONFIG_STORAGE_AREA_STORE_SUMMARY is disabled).
+ */
+int storage_area_store_set_key(const struct storage_area_store *store,
+			       uint32_t (*key)(const struct storage_area_record
+						       *record));
+
+/**
+ * @brief	 Retrieve the next record of the store with a given key. To get
+ *		 the first record set the record.store to NULL. Sectors whose
+ *		 summary excludes the key are skipped, a returned record can
+ *		 still be a false positive when different records share a key.
+ *
+ * @param store	 storage area store.
+ * @param record returned storage area record.
+ * @param key	 record key (as returned by the key routine).
+ *
+ * @retval	 0 on success else negative errno code.
+ */
+int storage_area_record_find(const struct storage_area_store *store,
+			     struct storage_area_record *record, uint32_t key);
+
 /**
  * @brief	 Validate a record (crc checks out)
  *
@@ -300,6 +550,66 @@ int storage_area_record_readv(const struct storage_area_record *record,
 int storage_area_record_read(const struct storage_area_record *record,
 			     size_t start, void *data, size_t len);
 
+/**
+ * @brief	 Map data of a record for reading without a copy (see
+ *		 storage_area_map()).
+ *
+ * @param record storage area record.
+ * @param start  offset in the record (data).
+ * @param len	 map size.
+ * @param buf	 bounce buffer of at least len bytes (can be NULL to only
+ *		 map in place).
+ * @param ptr	 returned pointer to the data.
+ *
+ * @retval	 0 on success else negative errno code.
+ */
+int storage_area_record_map(const struct storage_area_record *record,
+			    size_t start, size_t len, void *buf,
+			    const void **ptr);
+
+/**
+ * @brief	 Release a map of record data.
+ *
+ * @param record storage area record.
+ * @param ptr	 pointer returned by storage_area_record_map().
+ *
+ * @retval	 0 on success else negative errno code.
+ */
+int storage_area_record_unmap(const struct storage_area_record *record,
+			      const void *ptr);
+
+/**
+ * @brief	 Get a view of the record data in place, this is only
+ *		 supported when the storage area is memory addressable (e.g.
+ *		 ram or xip flash). The view is valid until the record is moved
+ *		 or erased, it is released with storage_area_record_unmap().
+ *
+ * @param record storage area record.
+ * @param data	 returned pointer to the record data.
+ * @param len	 returned record data size.
+ *
+ * @retval	 0 on success, -ENOTSUP when the storage area is not memory
+ *		 addressable, else negative errno code.
+ */
+int storage_area_record_view(const struct storage_area_record *record,
+			     const void **data, size_t *len);
+
+/**
+ * @brief	 Get a view of the record data in place (see
+ *		 storage_area_record_view()) after validating the record crc
+ *		 over the view.
+ *
+ * @param record storage area record.
+ * @param data	 returned pointer to the record data.
+ * @param len	 returned record data size.
+ *
+ * @retval	 0 on success, -EBADMSG when the crc does not check out,
+ *		 -ENOTSUP when the storage area is not memory addressable, else
+ *		 negative errno code.
+ */
+int storage_area_record_view_valid(const struct storage_area_record *record,
+				   const void **data, size_t *len);
+
 /**
  * @brief	 Update the start of record data. This is only possible if the
  *		 storage area supports multiple writes and the allowed update
@@ -328,6 +638,77 @@ int storage_area_store_get_sector_cookie(const struct storage_area_store *store,
 					 size_t sector, void *cookie,
 					 size_t cksz);
 
+/**
+ * @brief	 Get the erase count of an erase block of the store. The erases
+ *		 are counted since the start (or since the last mount when
+ *		 CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST restores the counters,
+ *		 erases of erase blocks that were not taken into use after the
+ *		 erase are not kept). When the erase block is smaller than a
+ *		 sector the count of the sector is returned. On storage areas
+ *		 without erase (or with autoerase) an erase block counts an erase
+ *		 each time it is taken into use.
+ *
+ * @param store	 storage area store.
+ * @param block	 erase block (relative to the start of the store).
+ * @param erases returned erase count (UINT32_MAX for a retired block).
+ *
+ * @retval	 0 on success else negative errno code (-ENOTSUP when
+ *		 CONFIG_STORAGE_AREA_STORE_WEAR is disabled).
+ */
+int storage_area_store_get_wear(const struct storage_area_store *store,
+				size_t block, uint32_t *erases);
+
+/**
+ * @brief	 Set the wear limit of a store, a store that is mounted as a
+ *		 simple circular buffer skips erase blocks that reached the wear
+ *		 limit when it is advanced. A skipped erase block is erased (if
+ *		 needed) a last time to remove the old records, it keeps the
+ *		 sector cookie and erase counter so the counter is restored
+ *		 after a reboot (CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST).
+ *
+ * @param store	 storage area store.
+ * @param limit	 erase count (0 disables the limit).
+ *
+ * @retval	 0 on success else negative errno code (-ENOTSUP when
+ *		 CONFIG_STORAGE_AREA_STORE_WEAR is disabled).
+ */
+int storage_area_store_set_wear_limit(const struct storage_area_store *store,
+				      uint32_t limit);
+
+/**
+ * @brief	 Retire an erase block of a store, a store that is mounted as a
+ *		 simple circular buffer never reads, writes or erases a retired
+ *		 erase block. The retired erase blocks are not kept, they should
+ *		 be retired each time before the store is mounted.
+ *
+ * @param store	 storage area store.
+ * @param block	 erase block (relative to the start of the store).
+ *
+ * @retval	 0 on success else negative errno code (-EBUSY when the store
+ *		 is mounted, -ENOTSUP when CONFIG_STORAGE_AREA_STORE_WEAR is
+ *		 disabled).
+ */
+int storage_area_store_retire_block(const struct storage_area_store *store,
+				    size_t block);
+
+/**
+ * @brief Number of erase counters of a store: one for each erase block, or
+ *        one for each sector when the erase block is smaller than a sector.
+ */
+#define STORAGE_AREA_STORE_WEAR_CNT(_erase_size, _sector_size, _sector_cnt)    \
+	DIV_ROUND_UP(_sector_cnt, MAX(1, (_erase_size) / (_sector_size)))
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+#define STORAGE_AREA_STORE_WEAR_DEFINE(_name, _wear_cnt)                        \
+	static uint32_t _storage_area_store_##_name##_wear[_wear_cnt]
+#define STORAGE_AREA_STORE_WEAR_INIT(_name)                                     \
+	= {.wear = _storage_area_store_##_name##_wear,                          \
+	   .wear_cnt = ARRAY_SIZE(_storage_area_store_##_name##_wear)}
+#else
+#define STORAGE_AREA_STORE_WEAR_DEFINE(_name, _wear_cnt) BUILD_ASSERT(true, "")
+#define STORAGE_AREA_STORE_WEAR_INIT(_name)
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
 /**
  * @brief Helper macro to create a storage area store on top of a storage area
  */
@@ -366,13 +747,34 @@ int storage_area_store_get_sector_cookie(const struct storage_area_store *store,
  *                       crc calculation. This can be used to invalidate certain
  *                       records while keeping the crc valid.
  *
+ *        With CONFIG_STORAGE_AREA_STORE_WEAR the store has an erase counter
+ *        for each sector, STORAGE_AREA_STORE_BLOCKS_DEFINE() only adds one
+ *        for each erase block.
  */
-
 #define STORAGE_AREA_STORE_DEFINE(_name, _area, _cookie, _cookie_size,          \
 				  _sector_size, _sector_cnt, _spare_sectors,    \
 				  _crc_skip)                                    \
+	STORAGE_AREA_STORE_BLOCKS_DEFINE(_name, _area, _sector_size, _cookie,   \
+					 _cookie_size, _sector_size,            \
+					 _sector_cnt, _spare_sectors, _crc_skip)
+
+/**
+ * @brief Define a named storage area store with an erase counter for each
+ *        erase block (CONFIG_STORAGE_AREA_STORE_WEAR)
+ *
+ * @param _erase_size    erase block size of the storage area
+ *
+ *        The other parameters are those of STORAGE_AREA_STORE_DEFINE().
+ */
+#define STORAGE_AREA_STORE_BLOCKS_DEFINE(_name, _area, _erase_size, _cookie,   \
+					 _cookie_size, _sector_size,            \
+					 _sector_cnt, _spare_sectors, _crc_skip)\
+	STORAGE_AREA_STORE_WEAR_DEFINE(                                         \
+		_name, STORAGE_AREA_STORE_WEAR_CNT(_erase_size, _sector_size,   \
+						   _sector_cnt));               \
 	static struct storage_area_store_data                                   \
-		_storage_area_store_##_name##_data;                             \
+		_storage_area_store_##_name##_data                              \
+			STORAGE_AREA_STORE_WEAR_INIT(_name);                    \
 	const struct storage_area_store _storage_area_store_##_name =           \
 		STORAGE_AREA_STORE(_area, &(_storage_area_store_##_name##_data),\
 				   _cookie, _cookie_size, _sector_size,         \
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @brief A storage area striped over multiple storage areas
+ * @defgroup storage_area_stripe Storage area stripe
+ * @ingroup storage_area
+ * @{
+ *
+ * The stripe combines N storage areas (children) with equal definition into
+ * one storage area. The data is interleaved over the children in units of
+ * the stripe unit: stripe unit i is stored on child i % N. An erase block of
+ * the stripe is made up of one erase block on each child (the stripe
+ * erase-size is N times the child erase-size).
+ *
+ * When CONFIG_STORAGE_AREA_STRIPE_WORKERS > 0 the operations on the children
+ * are done concurrently: the calling thread works on the first child, worker
+ * threads work on the other children.
+ *
+ * The definition of the children is verified on first use. Children should
+ * not be stripes themselves. A stripe with STORAGE_AREA_PROP_AUTOERASE erases
+ * the block on all children when a write starts a stripe erase block, the
+ * children are defined without STORAGE_AREA_PROP_AUTOERASE.
+ *
+ * Reads and writes are limited to STORAGE_AREA_STRIPE_MAX_IOVCNT iovec
+ * elements, larger vectors return -EINVAL. The limit is
+ * CONFIG_STORAGE_AREA_STRIPE_MAX_IOVCNT, raised to the iovec count of a
+ * storage area store write when CONFIG_STORAGE_AREA_STORE is enabled.
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_STRIPE_H_
+#define ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_STRIPE_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+#ifdef CONFIG_STORAGE_AREA_STORE
+#include <zephyr/storage/storage_area/storage_area_store.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** maximum iovec element count of a stripe read or write */
+#ifdef CONFIG_STORAGE_AREA_STORE
+#define STORAGE_AREA_STRIPE_MAX_IOVCNT                                         \
+	MAX(CONFIG_STORAGE_AREA_STRIPE_MAX_IOVCNT,                              \
+	    STORAGE_AREA_STORE_AREA_IOVCNT)
+#else
+#define STORAGE_AREA_STRIPE_MAX_IOVCNT CONFIG_STORAGE_AREA_STRIPE_MAX_IOVCNT
+#endif
+
+struct storage_area_stripe;
+
+/** work on one child of a storage area stripe */
+struct storage_area_stripe_task {
+	const struct storage_area_stripe *stripe;
+	int rc;
+#if defined(CONFIG_STORAGE_AREA_STRIPE_WORKERS) &&                             \
+	(CONFIG_STORAGE_AREA_STRIPE_WORKERS > 0)
+	struct k_work work;
+#endif
+};
+
+/** Runtime state of a storage area stripe */
+struct storage_area_stripe_data {
+	bool ready;
+	/* operation that is executed on the children */
+	int op;
+	sa_off_t offset;
+	size_t len;
+	const struct storage_area_iovec *iovec;
+	size_t iovcnt;
+#if defined(CONFIG_STORAGE_AREA_STRIPE_WORKERS) &&                             \
+	(CONFIG_STORAGE_AREA_STRIPE_WORKERS > 0)
+	struct k_sem done;
+#endif
+};
+
+struct storage_area_stripe {
+	const struct storage_area area;
+	const struct storage_area *const *children;
+	struct storage_area_stripe_task *tasks;
+	const size_t cnt;
+	const size_t su;
+	struct storage_area_stripe_data *data;
+#ifdef CONFIG_MULTITHREADING
+	struct k_mutex *lock;
+#endif
+};
+
+extern const struct storage_area_api storage_area_stripe_rw_api;
+extern const struct storage_area_api storage_area_stripe_ro_api;
+
+#ifdef CONFIG_MULTITHREADING
+#define STORAGE_AREA_STRIPE_LOCK_DEFINE(_name)                                  \
+	static K_MUTEX_DEFINE(_storage_area_##_name##_lock)
+#define STORAGE_AREA_STRIPE_LOCK(_name) .lock = &(_storage_area_##_name##_lock),
+#else
+#define STORAGE_AREA_STRIPE_LOCK_DEFINE(_name)                                  \
+	BUILD_ASSERT(true, "")
+#define STORAGE_AREA_STRIPE_LOCK(_name)
+#endif
+
+#define STORAGE_AREA_STRIPE_CNT(_name)                                          \
+	ARRAY_SIZE(_storage_area_##_name##_children)
+
+/**
+ * @brief Helper macro to create a stripe over storage areas
+ */
+#define STORAGE_AREA_STRIPE(_name, _su, _ws, _es, _size, _props, _api)         \
+	{                                                                       \
+		.area =                                                         \
+			{                                                       \
+				.api = ((_ws == 0) ||                           \
+					((_ws & (_ws - 1)) != 0) ||             \
+					((_es % _ws) != 0) ||                   \
+					((_size % _es) != 0) ||                 \
+					((_su % _ws) != 0) ||                   \
+					((_es % _su) != 0))                     \
+					       ? NULL                           \
+					       : _api,                          \
+				.write_size = _ws,                              \
+				.erase_size = _es,                              \
+				.erase_blocks = _size / _es,                    \
+				.props = _props,                                \
+			},                                                      \
+		.children = _storage_area_##_name##_children,                   \
+		.tasks = _storage_area_##_name##_tasks,                         \
+		.cnt = STORAGE_AREA_STRIPE_CNT(_name),                          \
+		.su = _su, .data = &(_storage_area_##_name##_data),             \
+		STORAGE_AREA_STRIPE_LOCK(_name)                                 \
+	}
+
+#define STORAGE_AREA_STRIPE_DEFINE(_name, _su, _ws, _es, _size, _props, _api,  \
+				   ...)                                         \
+	BUILD_ASSERT(_ws != 0, "Invalid write size");                           \
+	BUILD_ASSERT((_ws & (_ws - 1)) == 0, "Invalid write size");             \
+	BUILD_ASSERT((_es % _ws) == 0, "Invalid erase size");                   \
+	BUILD_ASSERT((_size % _ws) == 0, "Invalid size");                       \
+	BUILD_ASSERT((_su != 0) && ((_su % _ws) == 0), "Invalid stripe unit");  \
+	static const struct storage_area *const                                 \
+		_storage_area_##_name##_children[] = {__VA_ARGS__};             \
+	BUILD_ASSERT((_es % (_su * STORAGE_AREA_STRIPE_CNT(_name))) == 0,       \
+		     "Invalid stripe unit");                                    \
+	static struct storage_area_stripe_task                                  \
+		_storage_area_##_name##_tasks[STORAGE_AREA_STRIPE_CNT(_name)];  \
+	static struct storage_area_stripe_data _storage_area_##_name##_data;    \
+	STORAGE_AREA_STRIPE_LOCK_DEFINE(_name);                                 \
+	const struct storage_area_stripe _storage_area_##_name =                \
+		STORAGE_AREA_STRIPE(_name, _su, _ws, _es, _size, _props, _api)
+
+/**
+ * @brief Define a read-write stripe over storage areas
+ *
+ * @param _name	   storage area name: used by GET_STORAGE_AREA(_name)
+ * @param _su      stripe unit (multiple of write-size, the child erase-size
+ *                 should be a multiple of _su)
+ * @param _ws      write-size (equal to the child write-size)
+ * @param _es	   erase-size (child erase-size times the number of children)
+ * @param _size	   storage area size (child size times the number of children)
+ * @param _props   storage area properties (equal to the child properties,
+ *                 except for STORAGE_AREA_PROP_AUTOERASE)
+ * @param ...      children (pointers to storage areas)
+ */
+#define STORAGE_AREA_STRIPE_RW_DEFINE(_name, _su, _ws, _es, _size, _props, ...)\
+	STORAGE_AREA_STRIPE_DEFINE(_name, _su, _ws, _es, _size, _props,         \
+				   &storage_area_stripe_rw_api, __VA_ARGS__)
+
+/**
+ * @brief Define a read-only stripe over storage areas
+ *
+ * see @ref STORAGE_AREA_STRIPE_RW_DEFINE for parameters
+ */
+#define STORAGE_AREA_STRIPE_RO_DEFINE(_name, _su, _ws, _es, _size, _props, ...)\
+	STORAGE_AREA_STRIPE_DEFINE(_name, _su, _ws, _es, _size, _props,         \
+				   &storage_area_stripe_ro_api, __VA_ARGS__)
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_STORAGE_AREA_STRIPE_H_ */
@@ -14,6 +14,7 @@
 LOG_MODULE_DECLARE(settings_storage_area_store, CONFIG_SETTINGS_LOG_LEVEL);
 
 #define SASS_VALUE_BUF_SIZE	32
+#define SASS_NAME_BUF_SIZE	(SETTINGS_MAX_NAME_LEN + 1)
 
 struct settings_sas_read_fn_arg {
 	struct storage_area_record *record;
@@ -48,18 +49,448 @@ static int sas_get_name(const struct storage_area_record *record, char *name,
 	return storage_area_record_read(record, 1U, name, nsz);
 }
 
+/* compare the record name with name, in place when possible */
+static bool sas_name_equal(const struct storage_area_record *record,
+			   const char *name, size_t nsz)
+{
+	char buf[SASS_NAME_BUF_SIZE];
+	size_t start = 0U;
+
+	while (start < nsz) {
+		const size_t rdsz = MIN(sizeof(buf), nsz - start);
+		const void *rname;
+		bool equal;
+
+		if (storage_area_record_map(record, 1U + start, rdsz, buf,
+					    &rname) != 0) {
+			return false;
+		}
+
+		equal = (memcmp(name + start, rname, rdsz) == 0);
+		(void)storage_area_record_unmap(record, rname);
+		if (!equal) {
+			return false;
+		}
+
+		start += rdsz;
+	}
+
+	return true;
+}
+
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+#define SASS_INDEX_SIZE CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX_SIZE
+/* hash value that marks an unused index entry */
+#define SASS_INDEX_FREE 0U
+
+static struct settings_sas_index *sas_index_list;
+
+/*
+ * The index is used from the caller thread (load and save) and from the
+ * compactor thread (move and move_cb), all index accesses hold the lock.
+ */
+#ifdef CONFIG_MULTITHREADING
+static K_MUTEX_DEFINE(sas_index_mutex);
+#endif
+
+static void sas_index_lock(void)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(&sas_index_mutex, K_FOREVER);
+#endif
+}
+
+static void sas_index_unlock(void)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(&sas_index_mutex);
+#endif
+}
+
+/* fnv-1a hash of the setting name */
+static uint32_t sas_index_hash(const char *name, size_t nsz)
+{
+	uint32_t hash = 2166136261U;
+
+	for (size_t i = 0U; i < nsz; i++) {
+		hash ^= (uint8_t)name[i];
+		hash *= 16777619U;
+	}
+
+	return (hash == SASS_INDEX_FREE) ? 1U : hash;
+}
+
+static struct settings_sas_index *
+sas_index_get(const struct storage_area_store *sa_store)
+{
+	struct settings_sas_index *index = sas_index_list;
+
+	while ((index != NULL) && (index->sa_store != sa_store)) {
+		index = index->next;
+	}
+
+	if ((index == NULL) || (!index->ready)) {
+		return NULL;
+	}
+
+	return index;
+}
+
+static void sas_index_get_record(const struct settings_sas_index *index,
+				 const struct settings_sas_index_entry *entry,
+				 struct storage_area_record *record)
+{
+	record->store = (struct storage_area_store *)index->sa_store;
+	record->sector = entry->sector;
+	record->loc = entry->loc;
+	record->size = entry->size;
+}
+
+static bool sas_index_entry_is(const struct settings_sas_index_entry *entry,
+			       const struct storage_area_record *record)
+{
+	return ((entry != NULL) && (entry->sector == record->sector) &&
+		(entry->loc == record->loc));
+}
+
+/* Find the entry for name. When no entry is found free is set to the slot
+ * that can be used to add the name (NULL if the index is full).
+ */
+static struct settings_sas_index_entry *
+sas_index_find(struct settings_sas_index *index, const char *name, size_t nsz,
+	       struct settings_sas_index_entry **free)
+{
+	const uint32_t hash = sas_index_hash(name, nsz);
+	size_t pos = hash % SASS_INDEX_SIZE;
+
+	*free = NULL;
+	for (size_t i = 0U; i < SASS_INDEX_SIZE; i++) {
+		struct settings_sas_index_entry *entry = &index->entry[pos];
+		struct storage_area_record record;
+
+		if (entry->hash == SASS_INDEX_FREE) {
+			*free = entry;
+			break;
+		}
+
+		pos = (pos + 1U) % SASS_INDEX_SIZE;
+		if (entry->hash != hash) {
+			continue;
+		}
+
+		sas_index_get_record(index, entry, &record);
+		if (sas_get_name_size(&record) != nsz) {
+			continue;
+		}
+
+		if (sas_name_equal(&record, name, nsz)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static void sas_index_add(struct settings_sas_index *index,
+			  const struct storage_area_record *record,
+			  const char *name, size_t nsz)
+{
+	struct settings_sas_index_entry *free;
+	struct settings_sas_index_entry *entry;
+
+	entry = sas_index_find(index, name, nsz, &free);
+	if (entry == NULL) {
+		if (free == NULL) {
+			LOG_DBG("index full, falling back to store scan");
+			index->ready = false;
+			return;
+		}
+
+		entry = free;
+		entry->hash = sas_index_hash(name, nsz);
+	}
+
+	entry->sector = record->sector;
+	entry->loc = record->loc;
+	entry->size = record->size;
+}
+
+/* remove an entry and shift back the entries that follow it in the probe */
+static void sas_index_remove(struct settings_sas_index *index,
+			     struct settings_sas_index_entry *entry)
+{
+	size_t hole = entry - index->entry;
+	size_t pos = hole;
+
+	while (true) {
+		pos = (pos + 1U) % SASS_INDEX_SIZE;
+
+		const struct settings_sas_index_entry *next = &index->entry[pos];
+		const size_t home = next->hash % SASS_INDEX_SIZE;
+		bool keep;
+
+		if (next->hash == SASS_INDEX_FREE) {
+			break;
+		}
+
+		if (hole <= pos) {
+			keep = ((hole < home) && (home <= pos));
+		} else {
+			keep = ((hole < home) || (home <= pos));
+		}
+
+		if (keep) {
+			continue;
+		}
+
+		index->entry[hole] = *next;
+		hole = pos;
+	}
+
+	index->entry[hole].hash = SASS_INDEX_FREE;
+}
+
+/* Lookup the index entry for the name in record, a name that does not fit
+ * the name buffer drops the index.
+ */
+static struct settings_sas_index_entry *
+sas_index_lookup(struct settings_sas_index *index,
+		 const struct storage_area_record *record)
+{
+	struct settings_sas_index_entry *free;
+	const size_t nsz = sas_get_name_size(record);
+	char name[SASS_NAME_BUF_SIZE];
+
+	if (nsz == 0U) {
+		return NULL;
+	}
+
+	if (nsz > sizeof(name)) {
+		LOG_DBG("name too long, dropping index");
+		index->ready = false;
+		return NULL;
+	}
+
+	if (sas_get_name(record, name, nsz) != 0) {
+		return NULL;
+	}
+
+	return sas_index_find(index, name, nsz, &free);
+}
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+
+/* Build the index after a mount, or rebuild it when it has been dropped */
+static void sas_index_build(struct settings_storage_area_store *ssas,
+			    bool mounted)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index = &ssas->index;
+	struct storage_area_record record = {
+		.store = NULL,
+	};
+
+	sas_index_lock();
+	if ((!mounted) && (index->sa_store != NULL) && (index->ready)) {
+		goto end;
+	}
+
+	if (index->sa_store == NULL) {
+		index->sa_store = ssas->sa_store;
+		index->next = sas_index_list;
+		sas_index_list = index;
+	}
+
+	memset(index->entry, 0, sizeof(index->entry));
+	index->ready = true;
+	while ((index->ready) &&
+	       (storage_area_record_next(ssas->sa_store, &record) == 0)) {
+		const size_t nsz = sas_get_name_size(&record);
+		char name[SASS_NAME_BUF_SIZE];
+
+		if (nsz == 0U) {
+			continue;
+		}
+
+		if (nsz > sizeof(name)) {
+			LOG_DBG("name too long, falling back to store scan");
+			index->ready = false;
+			break;
+		}
+
+		if ((sas_get_name(&record, name, nsz) != 0) ||
+		    (!storage_area_record_valid(&record))) {
+			continue;
+		}
+
+		sas_index_add(index, &record, name, nsz);
+	}
+end:
+	sas_index_unlock();
+#else
+	ARG_UNUSED(ssas);
+	ARG_UNUSED(mounted);
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
+static void sas_index_invalidate(const struct storage_area_store *sa_store)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index;
+
+	sas_index_lock();
+	index = sas_index_get(sa_store);
+	if (index != NULL) {
+		index->ready = false;
+	}
+
+	sas_index_unlock();
+#else
+	ARG_UNUSED(sa_store);
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
+/* Add the written record for name to the index */
+static void sas_index_update(const struct storage_area_record *record,
+			     const char *name)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index;
+
+	sas_index_lock();
+	index = sas_index_get(record->store);
+	if (index != NULL) {
+		sas_index_add(index, record, name, strlen(name));
+	}
+
+	sas_index_unlock();
+#else
+	ARG_UNUSED(record);
+	ARG_UNUSED(name);
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
+/* Check if record is the newest version of a setting, returns false when
+ * no index is available.
+ */
+static bool sas_index_newest(const struct storage_area_record *record,
+			     bool *newest)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index;
+	bool rv = false;
+
+	sas_index_lock();
+	index = sas_index_get(record->store);
+	if (index != NULL) {
+		*newest = sas_index_entry_is(sas_index_lookup(index, record),
+					     record);
+		rv = index->ready;
+	}
+
+	sas_index_unlock();
+	return rv;
+#else
+	ARG_UNUSED(record);
+	ARG_UNUSED(newest);
+	return false;
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
+/* Get the newest record for name (record size is 0 when not found), returns
+ * false when no index is available.
+ */
+static bool sas_index_get_newest(const struct storage_area_store *sa_store,
+				 const char *name,
+				 struct storage_area_record *record)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index;
+	struct settings_sas_index_entry *free;
+	struct settings_sas_index_entry *entry;
+	bool rv = false;
+
+	sas_index_lock();
+	index = sas_index_get(sa_store);
+	if (index != NULL) {
+		entry = sas_index_find(index, name, strlen(name), &free);
+		if (entry != NULL) {
+			sas_index_get_record(index, entry, record);
+		} else {
+			record->size = 0U;
+		}
+
+		rv = true;
+	}
+
+	sas_index_unlock();
+	return rv;
+#else
+	ARG_UNUSED(sa_store);
+	ARG_UNUSED(name);
+	ARG_UNUSED(record);
+	return false;
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
+/* Remove the setting in record from the index */
+static void sas_index_drop(const struct storage_area_record *record)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index;
+	struct settings_sas_index_entry *entry;
+
+	sas_index_lock();
+	index = sas_index_get(record->store);
+	if (index != NULL) {
+		entry = sas_index_lookup(index, record);
+		if (sas_index_entry_is(entry, record)) {
+			sas_index_remove(index, entry);
+		}
+	}
+
+	sas_index_unlock();
+#else
+	ARG_UNUSED(record);
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
+/* Update the index after a record has been moved during compaction */
+static void sas_index_move(const struct storage_area_record *orig,
+			   const struct storage_area_record *dest)
+{
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+	struct settings_sas_index *index;
+	struct settings_sas_index_entry *entry;
+
+	sas_index_lock();
+	index = sas_index_get(orig->store);
+	if (index != NULL) {
+		entry = sas_index_lookup(index, orig);
+		if (sas_index_entry_is(entry, orig)) {
+			entry->sector = dest->sector;
+			entry->loc = dest->loc;
+		}
+	}
+
+	sas_index_unlock();
+#else
+	ARG_UNUSED(orig);
+	ARG_UNUSED(dest);
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+}
+
 static bool settings_sas_skip(const struct storage_area_record *record,
 			      const struct settings_load_arg *arg)
 {
-	size_t slen = ((arg == NULL) || (arg->subtree == NULL)) ? 
+	size_t slen = ((arg == NULL) || (arg->subtree == NULL)) ?
 		      0U : strlen(arg->subtree);
+	const size_t nsz = sas_get_name_size(record);
 
-	if ((sas_get_name_size(record) == 0U) ||
-	    (sas_get_name_size(record) < slen)) {
+	if ((nsz == 0U) || (nsz < slen)) {
 		return true;
 	}
-	
-	char name[sas_get_name_size(record)];
+
+	char name[nsz];
 
 	if (sas_get_name(record, name, sizeof(name)) != 0) {
 		return true;
@@ -69,6 +500,12 @@ static bool settings_sas_skip(const struct storage_area_record *record,
 		return true;
 	}
 
+	bool newest;
+
+	if (sas_index_newest(record, &newest)) {
+		return !newest;
+	}
+
 	struct storage_area_record walk = {
 		.store = record->store,
 		.sector = record->sector,
@@ -82,13 +519,7 @@ static bool settings_sas_skip(const struct storage_area_record *record,
 			continue;
 		}
 
-		char wname[sizeof(name)];
-
-		if (sas_get_name(&walk, wname, sizeof(name)) != 0) {
-			continue;
-		}
-
-		if ((memcmp(name, wname, sizeof(name)) == 0) && 
+		if ((sas_name_equal(&walk, name, sizeof(name))) &&
 		    (storage_area_record_valid(&walk))) {
 			rv = true;
 			break;
@@ -109,39 +540,56 @@ static bool settings_sas_move(const struct storage_area_record *record)
 	}
 
 	if ((sas_get_name_size(record) + 1U) == record->size) {
+		/* deleted settings are not moved */
+		sas_index_drop(record);
 		return false;
 	}
 
 	return true;
 }
 
-static int settings_sas_init(const struct storage_area_store *store)
+static void settings_sas_move_cb(const struct storage_area_record *orig,
+				 const struct storage_area_record *dest)
 {
-	if (store->data->ready) {
-		return 0;
-	}
+	sas_index_move(orig, dest);
+}
 
-	const struct storage_area_store_compact_cb cb = {
-		.move = settings_sas_move,
-	};
-	int rc;
+static const struct storage_area_store_compact_cb settings_sas_compact_cb = {
+	.move = settings_sas_move,
+	.move_cb = settings_sas_move_cb,
+};
+
+static int settings_sas_init(struct settings_storage_area_store *ssas)
+{
+	const struct storage_area_store *store = ssas->sa_store;
+	bool mounted = false;
+
+	if (!store->data->ready) {
+		sas_index_invalidate(store);
+
+		int rc = storage_area_store_mount(store,
+						  &settings_sas_compact_cb);
 
-	rc = storage_area_store_mount(store, &cb);
-	if (rc != 0) {
-		LOG_DBG("mount failed");
+		if (rc != 0) {
+			LOG_DBG("mount failed");
+			return rc;
+		}
+
+		mounted = true;
 	}
 
-	return rc;
+	sas_index_build(ssas, mounted);
+	return 0;
 }
 
 static int settings_sas_load(struct settings_store *store,
 			     const struct settings_load_arg *arg)
 {
-	const struct settings_storage_area_store *ssas =
+	struct settings_storage_area_store *ssas =
 		CONTAINER_OF(store, struct settings_storage_area_store, store);
 	const struct storage_area_store *sa_store = ssas->sa_store;
 
-	if (settings_sas_init(sa_store) != 0) {
+	if (settings_sas_init(ssas) != 0) {
 		/* allow other backends to be processed */
 		return 0;
 	}
@@ -197,8 +645,10 @@ static bool settings_sas_duplicate(const struct storage_area_store *sa_store,
 	uint8_t *value8 = (uint8_t *)value;
 	uint8_t buf[SASS_VALUE_BUF_SIZE];
 	bool rv = false;
+	bool indexed = sas_index_get_newest(sa_store, name, &record);
 
-	while (storage_area_record_next(sa_store, &record) == 0) {
+	while ((!indexed) &&
+	       (storage_area_record_next(sa_store, &record) == 0)) {
 		if (settings_sas_skip(&record, &load_arg)) {
 			continue;
 		}
@@ -212,12 +662,17 @@ static bool settings_sas_duplicate(const struct storage_area_store *sa_store,
 
 	while (dstart < record.size) {
 		size_t rdsz = MIN(sizeof(buf), record.size - dstart);
+		const void *rd;
+		bool equal;
 
-		if (storage_area_record_read(&record, dstart, buf, rdsz) != 0) {
+		if (storage_area_record_map(&record, dstart, rdsz, buf, &rd) !=
+		    0) {
 			break;
 		}
 
-		if (memcmp(value8, buf, rdsz) != 0) {
+		equal = (memcmp(value8, rd, rdsz) == 0);
+		(void)storage_area_record_unmap(&record, rd);
+		if (!equal) {
 			break;
 		}
 
@@ -235,11 +690,11 @@ end:
 static int settings_sas_save(struct settings_store *store, const char *name,
 			     const char *value, size_t val_len)
 {
-	const struct settings_storage_area_store *ssas =
+	struct settings_storage_area_store *ssas =
 		CONTAINER_OF(store, struct settings_storage_area_store, store);
 	const struct storage_area_store *sa_store = ssas->sa_store;
-	
-	if ((name == NULL) || (settings_sas_init(sa_store) != 0)) {
+
+	if ((name == NULL) || (settings_sas_init(ssas) != 0)) {
 		return -EINVAL;
 	}
 
@@ -247,7 +702,7 @@ static int settings_sas_save(struct settings_store *store, const char *name,
 	if (settings_sas_duplicate(sa_store, name, value, val_len)) {
 		return 0;
 	}
-	
+
 	uint8_t nsz = strlen(name);
 	struct storage_area_iovec wr[] = {
 		{
@@ -261,19 +716,25 @@ static int settings_sas_save(struct settings_store *store, const char *name,
 			.len = val_len,
 		},
 	};
-	const struct storage_area_store_compact_cb cb = {
-		.move = settings_sas_move,
-	};
+	struct storage_area_record record;
 	int rc = 0;
 
 	for (size_t i = 0; i < sa_store->sector_cnt; i++) {
-		rc = storage_area_store_writev(sa_store, wr, ARRAY_SIZE(wr));
-		if ((rc == 0) || (rc != -ENOSPC)) {
+		rc = storage_area_store_writev_record(sa_store, wr,
+						      ARRAY_SIZE(wr), &record);
+		if (rc == 0) {
+			sas_index_update(&record, name);
+			break;
+		}
+
+		if (rc != -ENOSPC) {
 			break;
 		}
 
-		rc = storage_area_store_compact(sa_store, &cb);
+		rc = storage_area_store_compact(sa_store,
+						&settings_sas_compact_cb);
 		if (rc != 0) {
+			sas_index_invalidate(sa_store);
 			break;
 		}
 
@@ -296,4 +757,4 @@ const struct settings_store_itf settings_storage_area_store_itf = {
 	.csi_load = settings_sas_load,
 	.csi_save = settings_sas_save,
 	.csi_storage_get = settings_sas_storage_get
-};
\ No newline at end of file
+};
@@ -5,11 +5,17 @@
  */
 
 #include <errno.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
 #include <zephyr/storage/storage_area/storage_area.h>
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(storage_area, CONFIG_STORAGE_AREA_LOG_LEVEL);
 
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_STORAGE_AREA_WRITE_BUFSIZE),
+	     "Write buffer size is not a power of two");
+
 static bool sa_range_valid(const struct storage_area *area, sa_off_t offset,
 			   size_t len)
 {
@@ -35,8 +41,149 @@ static size_t sa_iovec_size(const struct storage_area_iovec *iovec,
 	return rv;
 }
 
-int storage_area_readv(const struct storage_area *area, sa_off_t offset,
-		       const struct storage_area_iovec *iovec, size_t iovcnt)
+#ifdef CONFIG_STORAGE_AREA_STATS
+enum sa_stats_op {
+	SA_STATS_READ,
+	SA_STATS_WRITE,
+	SA_STATS_ERASE,
+};
+
+struct sa_stats_entry {
+	const struct storage_area *area;
+	struct storage_area_stats stats;
+};
+
+/* entries are assigned in order of first use and never released */
+static struct sa_stats_entry sa_stats[CONFIG_STORAGE_AREA_STATS_AREAS];
+static struct k_spinlock sa_stats_lock;
+
+/* called with the lock held */
+static struct sa_stats_entry *sa_stats_get(const struct storage_area *area,
+					   bool assign)
+{
+	for (size_t i = 0U; i < ARRAY_SIZE(sa_stats); i++) {
+		if (sa_stats[i].area == area) {
+			return &sa_stats[i];
+		}
+
+		if (sa_stats[i].area == NULL) {
+			if (assign) {
+				sa_stats[i].area = area;
+				return &sa_stats[i];
+			}
+
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static size_t sa_stats_bucket(uint32_t us)
+{
+	size_t bucket = 0U;
+
+	while ((us != 0U) && (bucket < (STORAGE_AREA_STATS_BUCKETS - 1))) {
+		us >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+static void sa_stats_add(const struct storage_area *area, enum sa_stats_op op,
+			 sa_off_t offset, size_t bytes, uint32_t start, int rc)
+{
+	const uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	k_spinlock_key_t key = k_spin_lock(&sa_stats_lock);
+	struct sa_stats_entry *entry = sa_stats_get(area, true);
+	struct storage_area_op_stats *ops;
+
+	if (entry == NULL) {
+		goto end;
+	}
+
+	switch (op) {
+	case SA_STATS_READ:
+		ops = &entry->stats.read;
+		break;
+	case SA_STATS_WRITE:
+		ops = &entry->stats.write;
+		break;
+	default:
+		ops = &entry->stats.erase;
+		break;
+	}
+
+	ops->ops++;
+	ops->latency[sa_stats_bucket(us)]++;
+	if (rc != 0) {
+		ops->errors++;
+		goto end;
+	}
+
+	ops->bytes += bytes;
+	if (op == SA_STATS_ERASE) {
+		const size_t sblk = offset / area->erase_size;
+		const size_t bcnt = bytes / area->erase_size;
+
+		entry->stats.erased_blocks += bcnt;
+		for (size_t i = sblk; (i < (sblk + bcnt)) &&
+				      (i < STORAGE_AREA_STATS_ERASE_BLOCKS); i++) {
+			entry->stats.block_erases[i]++;
+		}
+	}
+end:
+	k_spin_unlock(&sa_stats_lock, key);
+}
+#endif /* CONFIG_STORAGE_AREA_STATS */
+
+static int sa_readv(const struct storage_area *area, sa_off_t offset,
+		    const struct storage_area_iovec *iovec, size_t iovcnt)
+{
+#ifdef CONFIG_STORAGE_AREA_STATS
+	const uint32_t start = k_cycle_get_32();
+	int rc = area->api->readv(area, offset, iovec, iovcnt);
+
+	sa_stats_add(area, SA_STATS_READ, offset, sa_iovec_size(iovec, iovcnt),
+		     start, rc);
+	return rc;
+#else
+	return area->api->readv(area, offset, iovec, iovcnt);
+#endif /* CONFIG_STORAGE_AREA_STATS */
+}
+
+static int sa_writev(const struct storage_area *area, sa_off_t offset,
+		     const struct storage_area_iovec *iovec, size_t iovcnt)
+{
+#ifdef CONFIG_STORAGE_AREA_STATS
+	const uint32_t start = k_cycle_get_32();
+	int rc = area->api->writev(area, offset, iovec, iovcnt);
+
+	sa_stats_add(area, SA_STATS_WRITE, offset, sa_iovec_size(iovec, iovcnt),
+		     start, rc);
+	return rc;
+#else
+	return area->api->writev(area, offset, iovec, iovcnt);
+#endif /* CONFIG_STORAGE_AREA_STATS */
+}
+
+static int sa_erase(const struct storage_area *area, size_t sblk, size_t bcnt)
+{
+#ifdef CONFIG_STORAGE_AREA_STATS
+	const uint32_t start = k_cycle_get_32();
+	int rc = area->api->erase(area, sblk, bcnt);
+
+	sa_stats_add(area, SA_STATS_ERASE, sblk * area->erase_size,
+		     bcnt * area->erase_size, start, rc);
+	return rc;
+#else
+	return area->api->erase(area, sblk, bcnt);
+#endif /* CONFIG_STORAGE_AREA_STATS */
+}
+
+static int sa_readv_check(const struct storage_area *area, sa_off_t offset,
+			  const struct storage_area_iovec *iovec, size_t iovcnt)
 {
 	if ((area == NULL) || (area->api == NULL) ||
 	    (area->api->readv == NULL)) {
@@ -49,7 +196,19 @@ int storage_area_readv(const struct storage_area *area, sa_off_t offset,
 		return -EINVAL;
 	}
 
-	return area->api->readv(area, offset, iovec, iovcnt);
+	return 0;
+}
+
+int storage_area_readv(const struct storage_area *area, sa_off_t offset,
+		       const struct storage_area_iovec *iovec, size_t iovcnt)
+{
+	int rc = sa_readv_check(area, offset, iovec, iovcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	return sa_readv(area, offset, iovec, iovcnt);
 }
 
 int storage_area_read(const struct storage_area *area, sa_off_t offset,
@@ -63,8 +222,57 @@ int storage_area_read(const struct storage_area *area, sa_off_t offset,
 	return storage_area_readv(area, offset, &rd, 1U);
 }
 
-int storage_area_writev(const struct storage_area *area, sa_off_t offset,
-			const struct storage_area_iovec *iovec, size_t iovcnt)
+int storage_area_map(const struct storage_area *area, sa_off_t offset,
+		     size_t len, void *buf, const void **ptr)
+{
+	struct storage_area_iovec rd = {
+		.data = buf,
+		.len = len,
+	};
+	uintptr_t xip;
+	int rc;
+
+	if (ptr == NULL) {
+		return -EINVAL;
+	}
+
+	rc = sa_readv_check(area, offset, &rd, 1U);
+	if (rc != 0) {
+		return rc;
+	}
+
+	if (storage_area_ioctl(area, STORAGE_AREA_IOCTL_XIPADDRESS, &xip) == 0) {
+		*ptr = (const void *)(xip + (uintptr_t)offset);
+		return 0;
+	}
+
+	if (buf == NULL) {
+		return -ENOTSUP;
+	}
+
+	rc = sa_readv(area, offset, &rd, 1U);
+	if (rc == 0) {
+		*ptr = buf;
+	}
+
+	return rc;
+}
+
+int storage_area_unmap(const struct storage_area *area, const void *ptr)
+{
+	/* maps are not tracked: in place maps stay valid, buffers are owned
+	 * by the caller
+	 */
+	if ((area == NULL) || (ptr == NULL)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int sa_writev_check(const struct storage_area *area, sa_off_t offset,
+			   const struct storage_area_iovec *iovec,
+			   size_t iovcnt)
 {
 	if ((area == NULL) || (area->api == NULL) ||
 	    (area->api->writev == NULL)) {
@@ -78,7 +286,19 @@ int storage_area_writev(const struct storage_area *area, sa_off_t offset,
 		return -EINVAL;
 	}
 
-	return area->api->writev(area, offset, iovec, iovcnt);
+	return 0;
+}
+
+int storage_area_writev(const struct storage_area *area, sa_off_t offset,
+			const struct storage_area_iovec *iovec, size_t iovcnt)
+{
+	int rc = sa_writev_check(area, offset, iovec, iovcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	return sa_writev(area, offset, iovec, iovcnt);
 }
 
 int storage_area_write(const struct storage_area *area, sa_off_t offset,
@@ -92,7 +312,8 @@ int storage_area_write(const struct storage_area *area, sa_off_t offset,
 	return storage_area_writev(area, offset, &wr, 1U);
 }
 
-int storage_area_erase(const struct storage_area *area, size_t sblk, size_t bcnt)
+static int sa_erase_check(const struct storage_area *area, size_t sblk,
+			  size_t bcnt)
 {
 	if ((area == NULL) || (area->api == NULL) ||
 	    (area->api->erase == NULL)) {
@@ -106,12 +327,288 @@ int storage_area_erase(const struct storage_area *area, size_t sblk, size_t bcnt
 		return -EINVAL;
 	}
 
-	return area->api->erase(area, sblk, bcnt);
+	return 0;
+}
+
+int storage_area_erase(const struct storage_area *area, size_t sblk, size_t bcnt)
+{
+	int rc = sa_erase_check(area, sblk, bcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	return sa_erase(area, sblk, bcnt);
+}
+
+int storage_area_discard(const struct storage_area *area, size_t sblk,
+			 size_t bcnt)
+{
+	struct storage_area_blocks blocks = {
+		.sblk = sblk,
+		.bcnt = bcnt,
+	};
+	int rc = sa_erase_check(area, sblk, bcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = storage_area_ioctl(area, STORAGE_AREA_IOCTL_DISCARD, &blocks);
+	if (rc == -ENOTSUP) {
+		rc = sa_erase(area, sblk, bcnt);
+	}
+
+	return rc;
+}
+
+bool storage_area_mem_blank(const void *mem, size_t len, uint8_t value)
+{
+	const uint64_t pattern = value * 0x0101010101010101ULL;
+	const uint8_t *mem8 = (const uint8_t *)mem;
+	const uint64_t *mem64;
+
+	while ((len != 0U) && (((uintptr_t)mem8 & (sizeof(uint64_t) - 1)) != 0U)) {
+		if (*mem8 != value) {
+			return false;
+		}
+
+		mem8++;
+		len--;
+	}
+
+	mem64 = (const uint64_t *)mem8;
+	while (len >= (8U * sizeof(uint64_t))) {
+		uint64_t diff = 0U;
+
+		/* no early exit inside a chunk, this allows vectorization */
+		for (size_t i = 0U; i < 8U; i++) {
+			diff |= mem64[i] ^ pattern;
+		}
+
+		if (diff != 0U) {
+			return false;
+		}
+
+		mem64 += 8U;
+		len -= 8U * sizeof(uint64_t);
+	}
+
+	while (len >= sizeof(uint64_t)) {
+		if (*mem64 != pattern) {
+			return false;
+		}
+
+		mem64++;
+		len -= sizeof(uint64_t);
+	}
+
+	mem8 = (const uint8_t *)mem64;
+	while (len != 0U) {
+		if (*mem8 != value) {
+			return false;
+		}
+
+		mem8++;
+		len--;
+	}
+
+	return true;
+}
+
+static int sa_blank_check_read(const struct storage_area *area,
+			       sa_off_t offset, size_t len)
+{
+	uint64_t buf[DIV_ROUND_UP(CONFIG_STORAGE_AREA_BLANK_CHECK_BUFSIZE,
+				  sizeof(uint64_t))];
+	const uint8_t value = STORAGE_AREA_ERASEVALUE(area);
+	struct storage_area_iovec rd = {
+		.data = buf,
+	};
+	int rc = 0;
+
+	while (len != 0U) {
+		rd.len = MIN(len, sizeof(buf));
+		rc = area->api->readv(area, offset, &rd, 1U);
+		if (rc != 0) {
+			break;
+		}
+
+		if (!storage_area_mem_blank(buf, rd.len, value)) {
+			rc = -ENOTEMPTY;
+			break;
+		}
+
+		offset += rd.len;
+		len -= rd.len;
+	}
+
+	return rc;
+}
+
+int storage_area_blank_check(const struct storage_area *area, sa_off_t offset,
+			     size_t len)
+{
+	if ((area == NULL) || (area->api == NULL) ||
+	    (area->api->readv == NULL)) {
+		return -ENOTSUP;
+	}
+
+	if (!sa_range_valid(area, offset, len)) {
+		return -EINVAL;
+	}
+
+	if (area->api->blank_check != NULL) {
+		int rc = area->api->blank_check(area, offset, len);
+
+		if (rc != -ENOTSUP) {
+			return rc;
+		}
+	}
+
+	return sa_blank_check_read(area, offset, len);
+}
+
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+void storage_area_discard_set(const struct storage_area *area,
+			      uint32_t *discard, size_t sblk, size_t bcnt,
+			      bool discarded)
+{
+	const uint32_t value = discarded ? (uint32_t)area->erase_size : 0U;
+
+	for (size_t i = sblk; i < (sblk + bcnt); i++) {
+		discard[i] = value;
+	}
+}
+
+size_t storage_area_discard_extent(const struct storage_area *area,
+				   const uint32_t *discard, sa_off_t offset,
+				   size_t len, bool *discarded)
+{
+	const size_t esz = area->erase_size;
+	size_t blk = offset / esz;
+	size_t boff = offset % esz;
+	size_t ext = 0U;
+
+	*discarded = (boff >= (esz - discard[blk]));
+	while ((ext < len) && (blk < area->erase_blocks)) {
+		const size_t dstart = esz - discard[blk];
+		const size_t end = (*discarded) ? esz : dstart;
+
+		if ((*discarded) != (boff >= dstart)) {
+			break;
+		}
+
+		ext += end - boff;
+		if (end != esz) {
+			break;
+		}
+
+		blk++;
+		boff = 0U;
+	}
+
+	return MIN(ext, len);
+}
+
+size_t storage_area_discard_gap(const struct storage_area *area,
+				const uint32_t *discard, sa_off_t offset)
+{
+	const size_t esz = area->erase_size;
+	const size_t boff = offset % esz;
+	const size_t dstart = esz - discard[offset / esz];
+
+	return (boff > dstart) ? (boff - dstart) : 0U;
+}
+
+void storage_area_discard_written(const struct storage_area *area,
+				  uint32_t *discard, sa_off_t offset,
+				  size_t len)
+{
+	const size_t esz = area->erase_size;
+	size_t blk = offset / esz;
+	size_t boff = offset % esz;
+
+	while (len != 0U) {
+		const size_t wrlen = MIN(len, esz - boff);
+
+		if ((boff + wrlen) > (esz - discard[blk])) {
+			discard[blk] = (uint32_t)(esz - boff - wrlen);
+		}
+
+		len -= wrlen;
+		blk++;
+		boff = 0U;
+	}
+}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+#ifdef CONFIG_STORAGE_AREA_STATS
+static int sa_stats_ioctl(const struct storage_area *area,
+			  enum storage_area_ioctl_cmd cmd, void *data)
+{
+	struct storage_area_stats *stats = (struct storage_area_stats *)data;
+	struct sa_stats_entry *entry;
+	k_spinlock_key_t key;
+
+	if ((cmd == STORAGE_AREA_IOCTL_STATS) && (stats == NULL)) {
+		LOG_DBG("No return data supplied");
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&sa_stats_lock);
+	entry = sa_stats_get(area, false);
+	if (cmd == STORAGE_AREA_IOCTL_STATS) {
+		if (entry != NULL) {
+			*stats = entry->stats;
+		} else {
+			(void)memset(stats, 0, sizeof(*stats));
+		}
+	} else if (entry != NULL) {
+		(void)memset(&entry->stats, 0, sizeof(entry->stats));
+	}
+
+	k_spin_unlock(&sa_stats_lock, key);
+	return 0;
+}
+#endif /* CONFIG_STORAGE_AREA_STATS */
+
+int storage_area_stats_foreach(storage_area_stats_cb_t cb, void *ctx)
+{
+	if (cb == NULL) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STATS
+	for (size_t i = 0U; i < ARRAY_SIZE(sa_stats); i++) {
+		k_spinlock_key_t key = k_spin_lock(&sa_stats_lock);
+		const struct sa_stats_entry entry = sa_stats[i];
+
+		k_spin_unlock(&sa_stats_lock, key);
+		if (entry.area == NULL) {
+			break;
+		}
+
+		cb(entry.area, &entry.stats, ctx);
+	}
+
+	return 0;
+#else
+	ARG_UNUSED(ctx);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STATS */
 }
 
 int storage_area_ioctl(const struct storage_area *area,
 		       enum storage_area_ioctl_cmd cmd, void *data)
 {
+#ifdef CONFIG_STORAGE_AREA_STATS
+	if ((area != NULL) && ((cmd == STORAGE_AREA_IOCTL_STATS) ||
+			       (cmd == STORAGE_AREA_IOCTL_STATS_RESET))) {
+		return sa_stats_ioctl(area, cmd, data);
+	}
+#endif /* CONFIG_STORAGE_AREA_STATS */
+
 	if ((area == NULL) || (area->api == NULL) ||
 	    (area->api->ioctl == NULL)) {
 		return -ENOTSUP;
@@ -119,3 +616,218 @@ int storage_area_ioctl(const struct storage_area *area,
 
 	return area->api->ioctl(area, cmd, data);
 }
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+enum sa_async_op {
+	SA_ASYNC_READ,
+	SA_ASYNC_WRITE,
+	SA_ASYNC_ERASE,
+};
+
+static K_THREAD_STACK_DEFINE(sa_async_stack,
+			     CONFIG_STORAGE_AREA_ASYNC_STACK_SIZE);
+static struct k_work_q sa_async_wq;
+static struct k_spinlock sa_async_lock;
+
+static int sa_async_wq_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "sa_async",
+	};
+
+	k_work_queue_start(&sa_async_wq, sa_async_stack,
+			   K_THREAD_STACK_SIZEOF(sa_async_stack),
+			   CONFIG_STORAGE_AREA_ASYNC_PRIORITY, &cfg);
+	return 0;
+}
+
+SYS_INIT(sa_async_wq_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
+
+/* backends have no native asynchronous support: run the sync routines */
+static void sa_async_work(struct k_work *work)
+{
+	struct storage_area_async_req *req =
+		CONTAINER_OF(work, struct storage_area_async_req, work);
+	const struct storage_area *area = req->area;
+	int rc;
+
+	switch (req->op) {
+	case SA_ASYNC_READ:
+		rc = sa_readv(area, req->offset, req->iovec, req->cnt);
+		break;
+	case SA_ASYNC_WRITE:
+		rc = sa_writev(area, req->offset, req->iovec, req->cnt);
+		break;
+	case SA_ASYNC_ERASE:
+		rc = sa_erase(area, (size_t)req->offset, req->cnt);
+		break;
+	default:
+		rc = -EINVAL;
+		break;
+	}
+
+	const storage_area_async_cb_t cb = req->cb;
+#ifdef CONFIG_POLL
+	struct k_poll_signal *signal = req->signal;
+#endif
+	k_spinlock_key_t key = k_spin_lock(&sa_async_lock);
+
+	/* the request is done: it can be resubmitted from here on */
+	req->rc = rc;
+	req->busy = false;
+	k_spin_unlock(&sa_async_lock, key);
+
+	if (cb != NULL) {
+		cb(req);
+	}
+
+#ifdef CONFIG_POLL
+	if (signal != NULL) {
+		(void)k_poll_signal_raise(signal, rc);
+	}
+#endif
+}
+
+static int sa_async_submit(struct storage_area_async_req *req,
+			   const struct storage_area *area, uint8_t op,
+			   sa_off_t offset,
+			   const struct storage_area_iovec *iovec, size_t cnt)
+{
+	k_spinlock_key_t key = k_spin_lock(&sa_async_lock);
+	int rc = -EBUSY;
+
+	if (req->busy) {
+		goto end;
+	}
+
+	req->area = area;
+	req->op = op;
+	req->offset = offset;
+	req->iovec = iovec;
+	req->cnt = cnt;
+	req->rc = -EINPROGRESS;
+
+	rc = k_work_submit_to_queue(&sa_async_wq, &req->work);
+	if (rc > 0) {
+		req->busy = true;
+		rc = 0;
+	}
+end:
+	k_spin_unlock(&sa_async_lock, key);
+	return rc;
+}
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+
+int storage_area_async_init(struct storage_area_async_req *req,
+			    storage_area_async_cb_t cb)
+{
+	if (req == NULL) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+	k_work_init(&req->work, sa_async_work);
+	req->cb = cb;
+	req->busy = false;
+#ifdef CONFIG_POLL
+	req->signal = NULL;
+#endif
+	req->rc = 0;
+	return 0;
+#else
+	ARG_UNUSED(cb);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+}
+
+int storage_area_readv_async(const struct storage_area *area, sa_off_t offset,
+			     const struct storage_area_iovec *iovec,
+			     size_t iovcnt, struct storage_area_async_req *req)
+{
+	if (req == NULL) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+	int rc = sa_readv_check(area, offset, iovec, iovcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	return sa_async_submit(req, area, SA_ASYNC_READ, offset, iovec,
+			       iovcnt);
+#else
+	ARG_UNUSED(area);
+	ARG_UNUSED(offset);
+	ARG_UNUSED(iovec);
+	ARG_UNUSED(iovcnt);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+}
+
+int storage_area_writev_async(const struct storage_area *area, sa_off_t offset,
+			      const struct storage_area_iovec *iovec,
+			      size_t iovcnt, struct storage_area_async_req *req)
+{
+	if (req == NULL) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+	int rc = sa_writev_check(area, offset, iovec, iovcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	return sa_async_submit(req, area, SA_ASYNC_WRITE, offset, iovec,
+			       iovcnt);
+#else
+	ARG_UNUSED(area);
+	ARG_UNUSED(offset);
+	ARG_UNUSED(iovec);
+	ARG_UNUSED(iovcnt);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+}
+
+int storage_area_erase_async(const struct storage_area *area, size_t sblk,
+			     size_t bcnt, struct storage_area_async_req *req)
+{
+	if (req == NULL) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+	int rc = sa_erase_check(area, sblk, bcnt);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	return sa_async_submit(req, area, SA_ASYNC_ERASE, (sa_off_t)sblk,
+			       NULL, bcnt);
+#else
+	ARG_UNUSED(area);
+	ARG_UNUSED(sblk);
+	ARG_UNUSED(bcnt);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+}
+
+int storage_area_async_wait(struct storage_area_async_req *req)
+{
+	if (req == NULL) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+	struct k_work_sync sync;
+
+	(void)k_work_flush(&req->work, &sync);
+	return req->rc;
+#else
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+}
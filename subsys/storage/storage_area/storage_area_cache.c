@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/storage/storage_area/storage_area_cache.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(storage_area_cache, CONFIG_STORAGE_AREA_LOG_LEVEL);
+
+#if defined(CONFIG_STORAGE_AREA_CACHE_FLUSH_DELAY) &&                          \
+	(CONFIG_STORAGE_AREA_CACHE_FLUSH_DELAY > 0)
+#define SA_CACHE_FLUSH_TIMER 1
+#endif
+
+static void sa_cache_lock(const struct storage_area_cache *cache)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(cache->lock, K_FOREVER);
+#else
+	ARG_UNUSED(cache);
+#endif
+}
+
+static void sa_cache_unlock(const struct storage_area_cache *cache)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(cache->lock);
+#else
+	ARG_UNUSED(cache);
+#endif
+}
+
+static bool sa_cache_line_used(const struct storage_area_cache_line *line)
+{
+	return line->start != line->end;
+}
+
+static uint8_t *sa_cache_line_buf(const struct storage_area_cache *cache,
+				  const struct storage_area_cache_line *line)
+{
+	return cache->buf + (line - cache->lines) * cache->lsize;
+}
+
+static bool sa_cache_line_overlaps(const struct storage_area_cache *cache,
+				   const struct storage_area_cache_line *line,
+				   sa_off_t start, sa_off_t end)
+{
+	return (sa_cache_line_used(line)) && (line->offset < end) &&
+	       ((line->offset + cache->lsize) > start);
+}
+
+static int sa_cache_line_flush(const struct storage_area_cache *cache,
+			       struct storage_area_cache_line *line)
+{
+	const uint8_t *buf = sa_cache_line_buf(cache, line);
+	int rc;
+
+	rc = storage_area_write(cache->backend, line->offset + line->start,
+				buf + line->start, line->end - line->start);
+	if (rc != 0) {
+		LOG_DBG("flush failed at %lx", (long)(line->offset + line->start));
+		return rc;
+	}
+
+	line->start = 0U;
+	line->end = 0U;
+	return 0;
+}
+
+/* flush the lines that overlap [start, end), oldest first */
+static int sa_cache_flush_range(const struct storage_area_cache *cache,
+				sa_off_t start, sa_off_t end)
+{
+	int rc = 0;
+
+	while (rc == 0) {
+		struct storage_area_cache_line *oldest = NULL;
+
+		for (size_t i = 0U; i < cache->lcnt; i++) {
+			struct storage_area_cache_line *line = &cache->lines[i];
+
+			if (!sa_cache_line_overlaps(cache, line, start, end)) {
+				continue;
+			}
+
+			if ((oldest == NULL) ||
+			    ((int32_t)(line->age - oldest->age) < 0)) {
+				oldest = line;
+			}
+		}
+
+		if (oldest == NULL) {
+			break;
+		}
+
+		rc = sa_cache_line_flush(cache, oldest);
+	}
+
+	return rc;
+}
+
+static int sa_cache_flush(const struct storage_area_cache *cache)
+{
+	return sa_cache_flush_range(cache, 0, STORAGE_AREA_SIZE((&cache->area)));
+}
+
+#ifdef SA_CACHE_FLUSH_TIMER
+static void sa_cache_flush_work(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct storage_area_cache_data *data =
+		CONTAINER_OF(dwork, struct storage_area_cache_data, flush);
+	const struct storage_area_cache *cache = data->cache;
+
+	sa_cache_lock(cache);
+	(void)sa_cache_flush(cache);
+	sa_cache_unlock(cache);
+}
+#endif /* SA_CACHE_FLUSH_TIMER */
+
+static void sa_cache_schedule_flush(const struct storage_area_cache *cache)
+{
+#ifdef SA_CACHE_FLUSH_TIMER
+	(void)k_work_schedule(&cache->data->flush,
+			      K_MSEC(CONFIG_STORAGE_AREA_CACHE_FLUSH_DELAY));
+#else
+	ARG_UNUSED(cache);
+#endif /* SA_CACHE_FLUSH_TIMER */
+}
+
+static int sa_cache_init(const struct storage_area_cache *cache)
+{
+	const struct storage_area *area = &cache->area;
+	const struct storage_area *backend = cache->backend;
+
+	if ((backend == NULL) || (backend->api == NULL)) {
+		LOG_DBG("Bad backend");
+		return -EINVAL;
+	}
+
+	if ((backend->write_size != area->write_size) ||
+	    (backend->erase_size != area->erase_size) ||
+	    (backend->erase_blocks != area->erase_blocks) ||
+	    (backend->props != area->props)) {
+		LOG_DBG("Backend definition differs");
+		return -EINVAL;
+	}
+
+	if (STORAGE_AREA_AUTOERASE(area)) {
+		LOG_DBG("Autoerase is not supported");
+		return -EINVAL;
+	}
+
+	for (size_t i = 0U; i < cache->lcnt; i++) {
+		cache->lines[i].start = 0U;
+		cache->lines[i].end = 0U;
+	}
+
+#ifdef SA_CACHE_FLUSH_TIMER
+	cache->data->cache = cache;
+	k_work_init_delayable(&cache->data->flush, sa_cache_flush_work);
+#endif /* SA_CACHE_FLUSH_TIMER */
+	return 0;
+}
+
+/* called with the cache locked */
+static int sa_cache_valid(const struct storage_area_cache *cache)
+{
+	int rc = 0;
+
+	if (!cache->data->ready) {
+		rc = sa_cache_init(cache);
+		cache->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
+/*
+ * Get the line to cache a write of len bytes at pos in the line at offset,
+ * the write is merged with the cached part of the line when they are
+ * adjacent. Otherwise the line is flushed first. When no line is available
+ * the oldest line is flushed.
+ */
+static int sa_cache_line_get(const struct storage_area_cache *cache,
+			     sa_off_t offset, size_t pos, size_t len,
+			     struct storage_area_cache_line **line)
+{
+	struct storage_area_cache_line *oldest = NULL;
+	struct storage_area_cache_line *free = NULL;
+	int rc = 0;
+
+	for (size_t i = 0U; i < cache->lcnt; i++) {
+		struct storage_area_cache_line *walk = &cache->lines[i];
+
+		if (!sa_cache_line_used(walk)) {
+			free = walk;
+			continue;
+		}
+
+		if (walk->offset == offset) {
+			*line = walk;
+			if ((pos > walk->end) || ((pos + len) < walk->start)) {
+				rc = sa_cache_line_flush(cache, walk);
+			}
+
+			return rc;
+		}
+
+		if ((oldest == NULL) ||
+		    ((int32_t)(walk->age - oldest->age) < 0)) {
+			oldest = walk;
+		}
+	}
+
+	if (free == NULL) {
+		rc = sa_cache_line_flush(cache, oldest);
+		free = oldest;
+	}
+
+	*line = free;
+	return rc;
+}
+
+/* copy len bytes of data at offset doff into a iovec read at offset rdoff */
+static void sa_cache_overlay(const struct storage_area_iovec *iovec,
+			     size_t iovcnt, sa_off_t rdoff, sa_off_t doff,
+			     const uint8_t *data, size_t len)
+{
+	for (size_t i = 0U; i < iovcnt; i++) {
+		const sa_off_t ivend = rdoff + iovec[i].len;
+		const sa_off_t start = MAX(rdoff, doff);
+		const sa_off_t end = MIN(ivend, doff + len);
+
+		if (start < end) {
+			memcpy((uint8_t *)iovec[i].data + (start - rdoff),
+			       data + (start - doff), end - start);
+		}
+
+		rdoff = ivend;
+	}
+}
+
+static int sa_cache_readv(const struct storage_area *area, sa_off_t offset,
+			  const struct storage_area_iovec *iovec, size_t iovcnt)
+{
+	const struct storage_area_cache *cache =
+		CONTAINER_OF(area, struct storage_area_cache, area);
+	sa_off_t end = offset;
+	int rc;
+
+	sa_cache_lock(cache);
+	rc = sa_cache_valid(cache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	rc = storage_area_readv(cache->backend, offset, iovec, iovcnt);
+	if (rc != 0) {
+		goto end;
+	}
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		end += iovec[i].len;
+	}
+
+	for (size_t i = 0U; i < cache->lcnt; i++) {
+		const struct storage_area_cache_line *line = &cache->lines[i];
+
+		if (!sa_cache_line_overlaps(cache, line, offset, end)) {
+			continue;
+		}
+
+		sa_cache_overlay(iovec, iovcnt, offset,
+				 line->offset + line->start,
+				 sa_cache_line_buf(cache, line) + line->start,
+				 line->end - line->start);
+	}
+end:
+	sa_cache_unlock(cache);
+	return rc;
+}
+
+static int sa_cache_writev(const struct storage_area *area, sa_off_t offset,
+			   const struct storage_area_iovec *iovec,
+			   size_t iovcnt)
+{
+	const struct storage_area_cache *cache =
+		CONTAINER_OF(area, struct storage_area_cache, area);
+	const size_t lsize = cache->lsize;
+	int rc;
+
+	sa_cache_lock(cache);
+	rc = sa_cache_valid(cache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		const uint8_t *data8 = (const uint8_t *)iovec[i].data;
+		size_t blen = iovec[i].len;
+
+		while (blen != 0U) {
+			const size_t pos = offset % lsize;
+			const size_t cplen = MIN(blen, lsize - pos);
+			struct storage_area_cache_line *line;
+
+			rc = sa_cache_line_get(cache, offset - pos, pos, cplen,
+					       &line);
+			if (rc != 0) {
+				goto end;
+			}
+
+			memcpy(sa_cache_line_buf(cache, line) + pos, data8,
+			       cplen);
+			if (sa_cache_line_used(line)) {
+				line->start = MIN(line->start, pos);
+				line->end = MAX(line->end, pos + cplen);
+			} else {
+				line->offset = offset - pos;
+				line->start = pos;
+				line->end = pos + cplen;
+				line->age = cache->data->age++;
+				sa_cache_schedule_flush(cache);
+			}
+
+			offset += cplen;
+			data8 += cplen;
+			blen -= cplen;
+		}
+	}
+end:
+	sa_cache_unlock(cache);
+	return rc;
+}
+
+/* lines do not cross erase blocks: drop the lines in the erased blocks */
+static void sa_cache_drop(const struct storage_area_cache *cache, size_t sblk,
+			  size_t bcnt)
+{
+	const struct storage_area *area = &cache->area;
+	const sa_off_t start = (sa_off_t)sblk * area->erase_size;
+	const sa_off_t end = start + (sa_off_t)bcnt * area->erase_size;
+
+	for (size_t i = 0U; i < cache->lcnt; i++) {
+		struct storage_area_cache_line *line = &cache->lines[i];
+
+		if (sa_cache_line_overlaps(cache, line, start, end)) {
+			line->start = 0U;
+			line->end = 0U;
+		}
+	}
+}
+
+static int sa_cache_erase(const struct storage_area *area, size_t sblk,
+			  size_t bcnt)
+{
+	const struct storage_area_cache *cache =
+		CONTAINER_OF(area, struct storage_area_cache, area);
+	int rc;
+
+	sa_cache_lock(cache);
+	rc = sa_cache_valid(cache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	sa_cache_drop(cache, sblk, bcnt);
+	rc = storage_area_erase(cache->backend, sblk, bcnt);
+end:
+	sa_cache_unlock(cache);
+	return rc;
+}
+
+static int sa_cache_blank_check(const struct storage_area *area,
+				sa_off_t offset, size_t len)
+{
+	const struct storage_area_cache *cache =
+		CONTAINER_OF(area, struct storage_area_cache, area);
+	int rc;
+
+	sa_cache_lock(cache);
+	rc = sa_cache_valid(cache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	rc = sa_cache_flush_range(cache, offset, offset + len);
+	if (rc != 0) {
+		goto end;
+	}
+
+	rc = storage_area_blank_check(cache->backend, offset, len);
+end:
+	sa_cache_unlock(cache);
+	return rc;
+}
+
+static int sa_cache_ioctl(const struct storage_area *area,
+			  enum storage_area_ioctl_cmd cmd, void *data)
+{
+	const struct storage_area_cache *cache =
+		CONTAINER_OF(area, struct storage_area_cache, area);
+	int rc;
+
+	sa_cache_lock(cache);
+	rc = sa_cache_valid(cache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	switch (cmd) {
+	case STORAGE_AREA_IOCTL_FLUSH:
+		rc = sa_cache_flush(cache);
+		if (rc != 0) {
+			break;
+		}
+
+		/* the backend can be a cache */
+		rc = storage_area_ioctl(cache->backend, cmd, data);
+		if (rc == -ENOTSUP) {
+			rc = 0;
+		}
+
+		break;
+	case STORAGE_AREA_IOCTL_XIPADDRESS:
+		/* a direct read would bypass the cache */
+		rc = -ENOTSUP;
+		break;
+	case STORAGE_AREA_IOCTL_DISCARD:
+		if (data == NULL) {
+			LOG_DBG("No blocks supplied");
+			rc = -EINVAL;
+			break;
+		}
+
+		const struct storage_area_blocks *blocks =
+			(const struct storage_area_blocks *)data;
+
+		if ((blocks->bcnt > area->erase_blocks) ||
+		    (blocks->sblk > (area->erase_blocks - blocks->bcnt))) {
+			LOG_DBG("Invalid blocks");
+			rc = -EINVAL;
+			break;
+		}
+
+		sa_cache_drop(cache, blocks->sblk, blocks->bcnt);
+		rc = storage_area_discard(cache->backend, blocks->sblk,
+					  blocks->bcnt);
+		break;
+	default:
+		rc = storage_area_ioctl(cache->backend, cmd, data);
+		break;
+	}
+end:
+	sa_cache_unlock(cache);
+	return rc;
+}
+
+const struct storage_area_api storage_area_cache_rw_api = {
+	.readv = sa_cache_readv,
+	.writev = sa_cache_writev,
+	.erase = sa_cache_erase,
+	.blank_check = sa_cache_blank_check,
+	.ioctl = sa_cache_ioctl,
+};
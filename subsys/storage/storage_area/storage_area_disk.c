@@ -7,11 +7,14 @@
 #include <errno.h>
 #include <string.h>
 #include <zephyr/storage/storage_area/storage_area_disk.h>
+#ifdef CONFIG_STORAGE_AREA_DISK_TRIM
+#include <zephyr/drivers/disk/eepromdisk.h>
+#endif /* CONFIG_STORAGE_AREA_DISK_TRIM */
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(storage_area_disk, CONFIG_STORAGE_AREA_LOG_LEVEL);
 
-static int sa_disk_valid(const struct storage_area_disk *disk)
+static int sa_disk_init(const struct storage_area_disk *disk)
 {
 	int rc = disk_access_init(disk->name);
 
@@ -20,8 +23,8 @@ static int sa_disk_valid(const struct storage_area_disk *disk)
 	}
 
 	if (IS_ENABLED(CONFIG_STORAGE_AREA_VERIFY)) {
-		size_t scount;
-		size_t ssize;
+		uint32_t scount;
+		uint32_t ssize;
 
 		rc = disk_access_ioctl(disk->name, DISK_IOCTL_GET_SECTOR_COUNT,
 				       &scount);
@@ -44,7 +47,7 @@ static int sa_disk_valid(const struct storage_area_disk *disk)
 
 		const struct storage_area *area = &disk->area;
 		const size_t asz = area->erase_blocks * area->erase_size;
-		const size_t esz = scount * ssize;
+		const size_t esz = (size_t)scount * ssize;
 
 		if (esz < ((disk->start * ssize) + asz)) {
 			LOG_DBG("Bad area size");
@@ -65,111 +68,289 @@ static int sa_disk_valid(const struct storage_area_disk *disk)
 	return 0;
 }
 
+static int sa_disk_valid(const struct storage_area_disk *disk)
+{
+	int rc = 0;
+
+	if (!disk->data->ready) {
+		rc = sa_disk_init(disk);
+		disk->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
+static void sa_disk_lock(const struct storage_area_disk *disk)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(disk->lock, K_FOREVER);
+#else
+	ARG_UNUSED(disk);
+#endif
+}
+
+static void sa_disk_unlock(const struct storage_area_disk *disk)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(disk->lock);
+#else
+	ARG_UNUSED(disk);
+#endif
+}
+
+/* called with the disk locked before the buffer or the disk content changes */
+static void sa_disk_buf_invalidate(const struct storage_area_disk *disk)
+{
+	disk->data->buf_cnt = 0U;
+}
+
+/*
+ * get the number of sectors (up to scnt) from sector (relative to the area
+ * start) that are all discarded or all not discarded.
+ */
+static uint32_t sa_disk_extent(const struct storage_area_disk *disk,
+			       uint32_t sector, uint32_t scnt, bool *discarded)
+{
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if (disk->discard != NULL) {
+		const size_t ext = storage_area_discard_extent(
+			&disk->area, disk->discard,
+			(sa_off_t)sector * disk->ssize,
+			(size_t)scnt * disk->ssize, discarded);
+
+		return MAX(1U, ext / disk->ssize);
+	}
+#else
+	ARG_UNUSED(disk);
+	ARG_UNUSED(sector);
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+	*discarded = false;
+	return scnt;
+}
+
+/* read sectors with as few disk reads as possible */
+static int sa_disk_read_sectors(const struct storage_area_disk *disk,
+				uint8_t *buf, uint32_t sector, uint32_t scnt)
+{
+	const struct storage_area *area = &disk->area;
+	int rc = 0;
+
+	while (scnt != 0U) {
+		bool discarded;
+		const uint32_t cnt = sa_disk_extent(disk, sector, scnt,
+						    &discarded);
+
+		/* only read sectors that are not discarded */
+		if (discarded) {
+			memset(buf, STORAGE_AREA_ERASEVALUE(area),
+			       cnt * disk->ssize);
+		} else {
+			rc = disk_access_read(disk->name, buf,
+					      disk->start + sector, cnt);
+			if (rc != 0) {
+				break;
+			}
+		}
+
+		buf += cnt * disk->ssize;
+		sector += cnt;
+		scnt -= cnt;
+	}
+
+	return rc;
+}
+
+/*
+ * get the data of a sector from the buffer, when the sector is not in the
+ * buffer it is refilled with up to CONFIG_STORAGE_AREA_DISK_READAHEAD sectors
+ * (at least one) starting at the sector.
+ */
+static int sa_disk_buffered(const struct storage_area_disk *disk,
+			    uint32_t sector, const uint8_t **sdata)
+{
+	const struct storage_area *area = &disk->area;
+	struct storage_area_disk_data *data = disk->data;
+	const uint32_t asectors =
+		(area->erase_blocks * area->erase_size) / disk->ssize;
+
+	if ((data->buf_cnt == 0U) || (sector < data->buf_start) ||
+	    (sector >= (data->buf_start + data->buf_cnt))) {
+		const uint32_t scnt =
+			MIN(STORAGE_AREA_DISK_BUF_SECTORS, asectors - sector);
+		int rc;
+
+		data->buf_cnt = 0U;
+		rc = sa_disk_read_sectors(disk, disk->buf, sector, scnt);
+		if (rc != 0) {
+			return rc;
+		}
+
+		data->buf_start = sector;
+		data->buf_cnt = scnt;
+	}
+
+	*sdata = disk->buf + (sector - data->buf_start) * disk->ssize;
+	return 0;
+}
+
 static int sa_disk_readv(const struct storage_area *area, sa_off_t offset,
 			 const struct storage_area_iovec *iovec, size_t iovcnt)
 {
 	const struct storage_area_disk *disk =
 		CONTAINER_OF(area, struct storage_area_disk, area);
-	uint32_t starts = offset / disk->ssize;
-	uint32_t bpos = offset % disk->ssize;
-	uint8_t buf[disk->ssize];
+	const size_t ssize = disk->ssize;
+	uint32_t sector = offset / ssize;
+	size_t bpos = offset % ssize;
 	int rc = sa_disk_valid(disk);
 
 	if (rc != 0) {
 		goto end;
 	}
 
-	starts += disk->start;
-	rc = disk_access_read(disk->name, buf, starts, 1U);
-	if (rc != 0) {
-		goto end;
+	/* without readahead the buffer is not kept between reads */
+	sa_disk_lock(disk);
+	if (CONFIG_STORAGE_AREA_DISK_READAHEAD == 0) {
+		sa_disk_buf_invalidate(disk);
 	}
 
-	for (size_t i = 0U; i < iovcnt; i++) {
+	for (size_t i = 0U; (i < iovcnt) && (rc == 0); i++) {
 		uint8_t *data8 = (uint8_t *)iovec[i].data;
 		size_t blen = iovec[i].len;
 
 		while (blen != 0U) {
-			size_t cplen = MIN(blen, disk->ssize - bpos);
+			size_t cplen;
 
-			memcpy(data8, buf + bpos, cplen);
-			bpos += cplen;
-			blen -= cplen;
-			data8 += cplen;
+			if ((bpos == 0U) && (blen >= ssize)) {
+				/* whole sectors are read into the iovec */
+				const uint32_t rds = blen / ssize;
 
-			if (bpos == sizeof(buf)) {
-				starts++;
-				rc = disk_access_read(disk->name, buf, starts,
-						      1U);
+				rc = sa_disk_read_sectors(disk, data8, sector,
+							  rds);
 				if (rc != 0) {
 					break;
 				}
 
-				bpos = 0U;
+				cplen = rds * ssize;
+				sector += rds;
+			} else {
+				const uint8_t *sdata;
+
+				rc = sa_disk_buffered(disk, sector, &sdata);
+				if (rc != 0) {
+					break;
+				}
+
+				cplen = MIN(blen, ssize - bpos);
+				memcpy(data8, sdata + bpos, cplen);
+				bpos += cplen;
+				if (bpos == ssize) {
+					sector++;
+					bpos = 0U;
+				}
 			}
+
+			blen -= cplen;
+			data8 += cplen;
 		}
 	}
 
+	sa_disk_unlock(disk);
 	if (rc != 0) {
-		LOG_DBG("read failed at %lx",
-			(starts - disk->start) * disk->ssize);
+		LOG_DBG("read failed at %zx", (size_t)sector * ssize);
 	}
 end:
 	return rc;
 }
 
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+/* write the erase value in the discarded gap before a write at offset */
+static int sa_disk_fill_gap(const struct storage_area_disk *disk,
+			    sa_off_t offset, uint8_t *buf, size_t bsize)
+{
+	const struct storage_area *area = &disk->area;
+	size_t gap = storage_area_discard_gap(area, disk->discard, offset);
+	uint32_t starts = disk->start + (offset - gap) / disk->ssize;
+	int rc = 0;
+
+	memset(buf, STORAGE_AREA_ERASEVALUE(area), bsize);
+	while (gap != 0U) {
+		const size_t wrlen = MIN(gap, bsize);
+		const uint32_t wrs = wrlen / disk->ssize;
+
+		rc = disk_access_write(disk->name, buf, starts, wrs);
+		if (rc != 0) {
+			break;
+		}
+
+		starts += wrs;
+		gap -= wrlen;
+	}
+
+	return rc;
+}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
 static int sa_disk_writev(const struct storage_area *area, sa_off_t offset,
 			  const struct storage_area_iovec *iovec, size_t iovcnt)
 {
 	const struct storage_area_disk *disk =
 		CONTAINER_OF(area, struct storage_area_disk, area);
-	const size_t align = area->write_size;
-	const uint32_t spws = align / disk->ssize;
-	uint8_t buf[align];
+	const size_t ssize = disk->ssize;
+	uint8_t *buf = disk->buf;
 	size_t bpos = 0U;
-	uint32_t starts = offset / disk->ssize;
+	uint32_t starts = offset / ssize;
 	int rc = sa_disk_valid(disk);
 
 	if (rc != 0) {
 		goto end;
 	}
 
+	sa_disk_lock(disk);
+	sa_disk_buf_invalidate(disk);
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if (disk->discard != NULL) {
+		rc = sa_disk_fill_gap(disk, offset, buf,
+				      STORAGE_AREA_DISK_BUF_SECTORS * ssize);
+	}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+	/* parts of sectors are assembled in the buffer */
 	starts += disk->start;
-	for (size_t i = 0U; i < iovcnt; i++) {
+	for (size_t i = 0U; (rc == 0) && (i < iovcnt); i++) {
 		uint8_t *data8 = (uint8_t *)iovec[i].data;
 		size_t blen = iovec[i].len;
 
 		if (bpos != 0U) {
-			size_t cplen = MIN(blen, align - bpos);
+			size_t cplen = MIN(blen, ssize - bpos);
 
 			memcpy(buf + bpos, data8, cplen);
 			bpos += cplen;
 			blen -= cplen;
 			data8 += cplen;
 
-			if (bpos == align) {
+			if (bpos == ssize) {
 				rc = disk_access_write(disk->name, buf, starts,
-						       spws);
+						       1U);
 				if (rc != 0) {
 					break;
 				}
 
-				starts += spws;
+				starts++;
 				bpos = 0U;
 			}
 		}
 
-		if (blen >= align) {
-			size_t wrlen = blen & ~(align - 1);
-			uint32_t wrs = wrlen / disk->ssize;
+		if (blen >= ssize) {
+			uint32_t wrs = blen / ssize;
 
 			rc = disk_access_write(disk->name, data8, starts, wrs);
 			if (rc != 0) {
 				break;
 			}
 
-			blen -= wrlen;
-			data8 += wrlen;
+			blen -= wrs * ssize;
+			data8 += wrs * ssize;
 			starts += wrs;
 		}
 
@@ -183,42 +364,91 @@ static int sa_disk_writev(const struct storage_area *area, sa_off_t offset,
 		LOG_DBG("write failed at %lx",
 			(starts - disk->start) * disk->ssize);
 	}
+
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if ((rc == 0) && (disk->discard != NULL)) {
+		storage_area_discard_written(
+			area, disk->discard, offset,
+			(starts - disk->start) * disk->ssize - offset);
+	}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+	sa_disk_unlock(disk);
 end:
 	return rc;
 }
 
+/* the erase value is written in chunks of the buffer size */
 static int sa_disk_erase(const struct storage_area *area, size_t sblk,
 			 size_t bcnt)
 {
 	const struct storage_area_disk *disk =
 		CONTAINER_OF(area, struct storage_area_disk, area);
-	const uint32_t spws = area->erase_size / disk->ssize;
-	uint32_t starts = disk->start + sblk * spws;
-	uint8_t buf[area->erase_size];
+	const uint32_t spes = area->erase_size / disk->ssize;
+	uint32_t starts = disk->start + sblk * spes;
+	uint32_t scnt = bcnt * spes;
 	int rc = sa_disk_valid(disk);
 
 	if (rc != 0) {
 		goto end;
 	}
 
-	memset(buf, STORAGE_AREA_ERASEVALUE(area), sizeof(buf));
-	for (size_t i = 0; i < bcnt; i++) {
-		rc = disk_access_write(disk->name, buf, starts, spws);
+	sa_disk_lock(disk);
+	sa_disk_buf_invalidate(disk);
+	memset(disk->buf, STORAGE_AREA_ERASEVALUE(area),
+	       STORAGE_AREA_DISK_BUF_SECTORS * disk->ssize);
+	while (scnt != 0U) {
+		const uint32_t wrs = MIN(scnt, STORAGE_AREA_DISK_BUF_SECTORS);
+
+		rc = disk_access_write(disk->name, disk->buf, starts, wrs);
 		if (rc != 0) {
 			break;
 		}
 
-		starts += spws;
+		starts += wrs;
+		scnt -= wrs;
 	}
 
 	if (rc != 0) {
 		LOG_DBG("write failed at %x",
 			(starts - disk->start) * disk->ssize);
 	}
+
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if ((rc == 0) && (disk->discard != NULL)) {
+		storage_area_discard_set(area, disk->discard, sblk, bcnt, false);
+	}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+	sa_disk_unlock(disk);
 end:
 	return rc;
 }
 
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+/* called with the disk locked to trim the sectors of discarded blocks */
+static void sa_disk_trim(const struct storage_area_disk *disk,
+			 const struct storage_area_blocks *blocks)
+{
+#ifdef CONFIG_STORAGE_AREA_DISK_TRIM
+	const uint32_t spes = disk->area.erase_size / disk->ssize;
+	struct eeprom_disk_trim trim = {
+		.sector = disk->start + blocks->sblk * spes,
+		.count = blocks->bcnt * spes,
+	};
+	int rc = disk_access_ioctl(disk->name, EEPROM_DISK_IOCTL_CTRL_TRIM,
+				   &trim);
+
+	if (rc != 0) {
+		LOG_DBG("trim failed at %x [%d]", trim.sector, rc);
+	}
+#else
+	ARG_UNUSED(disk);
+	ARG_UNUSED(blocks);
+#endif /* CONFIG_STORAGE_AREA_DISK_TRIM */
+}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
 static int sa_disk_ioctl(const struct storage_area *area,
 			 enum storage_area_ioctl_cmd cmd, void *data)
 {
@@ -230,9 +460,35 @@ static int sa_disk_ioctl(const struct storage_area *area,
 		goto end;
 	}
 
-	rc = -ENOTSUP;
 	switch (cmd) {
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	case STORAGE_AREA_IOCTL_DISCARD:
+		if (disk->discard == NULL) {
+			rc = -ENOTSUP;
+			break;
+		}
+
+		const struct storage_area_blocks *blocks =
+			(const struct storage_area_blocks *)data;
+
+		if ((blocks == NULL) ||
+		    (blocks->bcnt > area->erase_blocks) ||
+		    (blocks->sblk > (area->erase_blocks - blocks->bcnt))) {
+			LOG_DBG("Invalid blocks");
+			rc = -EINVAL;
+			break;
+		}
+
+		sa_disk_lock(disk);
+		sa_disk_buf_invalidate(disk);
+		storage_area_discard_set(area, disk->discard, blocks->sblk,
+					 blocks->bcnt, true);
+		sa_disk_trim(disk, blocks);
+		sa_disk_unlock(disk);
+		break;
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
 	default:
+		rc = -ENOTSUP;
 		break;
 	}
 end:
@@ -11,7 +11,7 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(storage_area_eeprom, CONFIG_STORAGE_AREA_LOG_LEVEL);
 
-static int sa_eeprom_valid(const struct storage_area_eeprom *eeprom)
+static int sa_eeprom_init(const struct storage_area_eeprom *eeprom)
 {
 	if (!device_is_ready(eeprom->dev)) {
 		LOG_DBG("Device is not ready");
@@ -32,6 +32,18 @@ static int sa_eeprom_valid(const struct storage_area_eeprom *eeprom)
 	return 0;
 }
 
+static int sa_eeprom_valid(const struct storage_area_eeprom *eeprom)
+{
+	int rc = 0;
+
+	if (!eeprom->data->ready) {
+		rc = sa_eeprom_init(eeprom);
+		eeprom->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
 static int sa_eeprom_readv(const struct storage_area *area, sa_off_t offset,
 			   const struct storage_area_iovec *iovec, size_t iovcnt)
 {
@@ -45,14 +57,38 @@ static int sa_eeprom_readv(const struct storage_area *area, sa_off_t offset,
 
 	off_t rdoff = eeprom->doffset + (off_t)offset;
 
-	for (size_t i = 0U; i < iovcnt; i++) {
-		rc = eeprom_read(eeprom->dev, rdoff, iovec[i].data,
-				 iovec[i].len);
-		if (rc != 0) {
-			break;
-		}
+	for (size_t i = 0U; (i < iovcnt) && (rc == 0); i++) {
+		uint8_t *data8 = (uint8_t *)iovec[i].data;
+		size_t blen = iovec[i].len;
+
+		while (blen != 0U) {
+			size_t rdlen = blen;
+			bool discarded = false;
 
-		rdoff += iovec[i].len;
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+			if (eeprom->discard != NULL) {
+				rdlen = storage_area_discard_extent(
+					area, eeprom->discard,
+					rdoff - eeprom->doffset, blen,
+					&discarded);
+			}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+			if (discarded) {
+				memset(data8, STORAGE_AREA_ERASEVALUE(area),
+				       rdlen);
+			} else {
+				rc = eeprom_read(eeprom->dev, rdoff, data8,
+						 rdlen);
+				if (rc != 0) {
+					break;
+				}
+			}
+
+			rdoff += rdlen;
+			data8 += rdlen;
+			blen -= rdlen;
+		}
 	}
 
 	if (rc != 0) {
@@ -62,14 +98,43 @@ end:
 	return rc;
 }
 
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+/* write the erase value in the discarded gap before a write at offset */
+static int sa_eeprom_fill_gap(const struct storage_area_eeprom *eeprom,
+			      sa_off_t offset, uint8_t *buf, size_t bsize)
+{
+	const struct storage_area *area = &eeprom->area;
+	size_t gap = storage_area_discard_gap(area, eeprom->discard, offset);
+	off_t wroff = eeprom->doffset + (off_t)(offset - gap);
+	int rc = 0;
+
+	memset(buf, STORAGE_AREA_ERASEVALUE(area), bsize);
+	while (gap != 0U) {
+		const size_t wrlen = MIN(gap, bsize);
+
+		rc = eeprom_write(eeprom->dev, wroff, buf, wrlen);
+		if (rc != 0) {
+			break;
+		}
+
+		wroff += wrlen;
+		gap -= wrlen;
+	}
+
+	return rc;
+}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
 static int sa_eeprom_writev(const struct storage_area *area, sa_off_t offset,
 			    const struct storage_area_iovec *iovec,
 			    size_t iovcnt)
 {
 	const struct storage_area_eeprom *eeprom =
 		CONTAINER_OF(area, struct storage_area_eeprom, area);
-	const size_t align = area->write_size;
-	uint8_t buf[align];
+	/* larger write blocks are written in parts of the buffer size */
+	const size_t align =
+		MIN(area->write_size, CONFIG_STORAGE_AREA_WRITE_BUFSIZE);
+	uint8_t buf[CONFIG_STORAGE_AREA_WRITE_BUFSIZE];
 	size_t bpos = 0U;
 	int rc = sa_eeprom_valid(eeprom);
 
@@ -78,64 +143,87 @@ static int sa_eeprom_writev(const struct storage_area *area, sa_off_t offset,
 	}
 
 	off_t wroff = eeprom->doffset + (off_t)offset;
-	
-	for (size_t i = 0U; i < iovcnt; i++) {
-		uint8_t *data8 = (uint8_t *)iovec[i].data;
-		size_t blen = iovec[i].len;
 
-		if (bpos != 0U) {
-			size_t cplen = MIN(blen, align - bpos);
-
-			memcpy(buf + bpos, data8, cplen);
-			bpos += cplen;
-			blen -= cplen;
-			data8 += cplen;
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if (eeprom->discard != NULL) {
+		rc = sa_eeprom_fill_gap(eeprom, offset, buf, sizeof(buf));
+		if (rc != 0) {
+			goto end;
+		}
+	}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
+
+	/*
+	 * the elements are gathered in the buffer and written when it is full,
+	 * parts of an element that fill the buffer are written directly
+	 */
+	for (size_t i = 0U; (rc == 0) && (i < iovcnt); i++) {
+		const uint8_t *data8 = (const uint8_t *)iovec[i].data;
+		size_t blen = iovec[i].len;
 
-			if (bpos == align) {
-				rc = eeprom_write(eeprom->dev, wroff, buf,
-						  align);
-				if (rc != 0) {
-					break;
+		while ((rc == 0) && (blen != 0U)) {
+			size_t wrlen;
+
+			if ((bpos == 0U) && (blen >= sizeof(buf))) {
+				wrlen = blen & ~(align - 1);
+				rc = eeprom_write(eeprom->dev, wroff, data8,
+						  wrlen);
+				if (rc == 0) {
+					wroff += wrlen;
+					data8 += wrlen;
+					blen -= wrlen;
 				}
 
-				wroff += align;
-				bpos = 0U;
+				continue;
 			}
-		}
 
-		if (blen >= align) {
-			size_t wrlen = blen & ~(align - 1);
+			wrlen = MIN(blen, sizeof(buf) - bpos);
+			memcpy(buf + bpos, data8, wrlen);
+			bpos += wrlen;
+			data8 += wrlen;
+			blen -= wrlen;
 
-			rc = eeprom_write(eeprom->dev, wroff, data8, wrlen);
-			if (rc != 0) {
-				break;
+			if (bpos == sizeof(buf)) {
+				rc = eeprom_write(eeprom->dev, wroff, buf,
+						  bpos);
+				if (rc == 0) {
+					wroff += bpos;
+					bpos = 0U;
+				}
 			}
-
-			blen -= wrlen;
-			data8 += wrlen;
-			wroff += wrlen;
 		}
+	}
 
-		if (blen > 0U) {
-			memcpy(buf, data8, blen);
-			bpos = blen;
+	if ((rc == 0) && (bpos != 0U)) {
+		rc = eeprom_write(eeprom->dev, wroff, buf, bpos);
+		if (rc == 0) {
+			wroff += bpos;
 		}
 	}
 
 	if (rc != 0) {
 		LOG_DBG("write failed at %lx", wroff - eeprom->doffset);
 	}
+
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if ((rc == 0) && (eeprom->discard != NULL)) {
+		storage_area_discard_written(area, eeprom->discard, offset,
+					     wroff - eeprom->doffset - offset);
+	}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
 end:
 	return rc;
 }
 
+/* the erase value is written in chunks of the buffer size */
 static int sa_eeprom_erase(const struct storage_area *area, size_t sblk,
 			   size_t bcnt)
 {
 	const struct storage_area_eeprom *eeprom =
 		CONTAINER_OF(area, struct storage_area_eeprom, area);
 	off_t eoff = eeprom->doffset + sblk * area->erase_size;
-	uint8_t buf[area->erase_size];
+	size_t elen = bcnt * area->erase_size;
+	uint8_t buf[CONFIG_STORAGE_AREA_EEPROM_ERASE_BUFSIZE];
 	int rc = sa_eeprom_valid(eeprom);
 
 	if (rc != 0) {
@@ -143,18 +231,28 @@ static int sa_eeprom_erase(const struct storage_area *area, size_t sblk,
 	}
 
 	memset(buf, STORAGE_AREA_ERASEVALUE(area), sizeof(buf));
-	for (size_t i = 0; i < bcnt; i++) {
-		rc = eeprom_write(eeprom->dev, eoff, buf, sizeof(buf));
+	while (elen != 0U) {
+		const size_t wrlen = MIN(elen, sizeof(buf));
+
+		rc = eeprom_write(eeprom->dev, eoff, buf, wrlen);
 		if (rc != 0) {
 			break;
 		}
 
-		eoff += area->erase_size;
+		eoff += wrlen;
+		elen -= wrlen;
 	}
 
 	if (rc != 0) {
 		LOG_DBG("write failed at %lx", eoff - eeprom->doffset);
 	}
+
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	if ((rc == 0) && (eeprom->discard != NULL)) {
+		storage_area_discard_set(area, eeprom->discard, sblk, bcnt,
+					 false);
+	}
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
 end:
 	return rc;
 }
@@ -170,9 +268,31 @@ static int sa_eeprom_ioctl(const struct storage_area *area,
 		goto end;
 	}
 
-	rc = -ENOTSUP;
 	switch (cmd) {
+#ifdef CONFIG_STORAGE_AREA_DISCARD
+	case STORAGE_AREA_IOCTL_DISCARD:
+		if (eeprom->discard == NULL) {
+			rc = -ENOTSUP;
+			break;
+		}
+
+		const struct storage_area_blocks *blocks =
+			(const struct storage_area_blocks *)data;
+
+		if ((blocks == NULL) ||
+		    (blocks->bcnt > area->erase_blocks) ||
+		    (blocks->sblk > (area->erase_blocks - blocks->bcnt))) {
+			LOG_DBG("Invalid blocks");
+			rc = -EINVAL;
+			break;
+		}
+
+		storage_area_discard_set(area, eeprom->discard, blocks->sblk,
+					 blocks->bcnt, true);
+		break;
+#endif /* CONFIG_STORAGE_AREA_DISCARD */
 	default:
+		rc = -ENOTSUP;
 		break;
 	}
 end:
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/storage/storage_area/storage_area_file.h>
+#include "storage_area_file_native.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(storage_area_file, CONFIG_STORAGE_AREA_LOG_LEVEL);
+
+static size_t sa_file_size(const struct storage_area *area)
+{
+	return area->erase_blocks * area->erase_size;
+}
+
+static int sa_file_init(const struct storage_area_file *file)
+{
+	const struct storage_area *area = &file->area;
+	void *map;
+
+	if (sa_file_native_map(file->path, sa_file_size(area),
+			       STORAGE_AREA_ERASEVALUE(area), &map) != 0) {
+		LOG_DBG("Unable to map %s",
+			(file->path != NULL) ? file->path : "temporary file");
+		return -EIO;
+	}
+
+	file->data->map = map;
+	return 0;
+}
+
+/* the file is mapped on first use */
+static int sa_file_valid(const struct storage_area_file *file)
+{
+	int rc = 0;
+
+	if (file->data->ready) {
+		return 0;
+	}
+
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(file->lock, K_FOREVER);
+#endif
+	if (!file->data->ready) {
+		rc = sa_file_init(file);
+		file->data->ready = (rc == 0);
+	}
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(file->lock);
+#endif
+	return rc;
+}
+
+static int sa_file_readv(const struct storage_area *area, sa_off_t offset,
+			 const struct storage_area_iovec *iovec, size_t iovcnt)
+{
+	const struct storage_area_file *file =
+		CONTAINER_OF(area, struct storage_area_file, area);
+	int rc = sa_file_valid(file);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	const uint8_t *rd = file->data->map + offset;
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		memcpy(iovec[i].data, rd, iovec[i].len);
+		rd += iovec[i].len;
+	}
+
+	return 0;
+}
+
+/* copy to the mapping, only changing bits from the erase value on nor */
+static void sa_file_program(const struct storage_area *area, uint8_t *wr,
+			    const uint8_t *data, size_t len)
+{
+	const uint8_t erase_value = STORAGE_AREA_ERASEVALUE(area);
+
+	if (STORAGE_AREA_FOVRWRITE(area)) {
+		memcpy(wr, data, len);
+	} else if (erase_value == 0x00) {
+		for (size_t i = 0U; i < len; i++) {
+			wr[i] |= data[i];
+		}
+	} else {
+		for (size_t i = 0U; i < len; i++) {
+			wr[i] &= data[i];
+		}
+	}
+}
+
+static int sa_file_writev(const struct storage_area *area, sa_off_t offset,
+			  const struct storage_area_iovec *iovec,
+			  size_t iovcnt)
+{
+	const struct storage_area_file *file =
+		CONTAINER_OF(area, struct storage_area_file, area);
+	const size_t esz = area->erase_size;
+	const bool autoerase = STORAGE_AREA_AUTOERASE(area) &&
+			       !STORAGE_AREA_FOVRWRITE(area);
+	int rc = sa_file_valid(file);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		const uint8_t *data8 = (const uint8_t *)iovec[i].data;
+		size_t blen = iovec[i].len;
+
+		while (blen != 0U) {
+			const size_t wrlen = MIN(esz - (offset % esz), blen);
+			uint8_t *wr = file->data->map + offset;
+
+			if ((autoerase) && ((offset % esz) == 0U)) {
+				(void)memset(wr, STORAGE_AREA_ERASEVALUE(area),
+					     esz);
+			}
+
+			sa_file_program(area, wr, data8, wrlen);
+			offset += wrlen;
+			data8 += wrlen;
+			blen -= wrlen;
+		}
+	}
+
+	return 0;
+}
+
+static int sa_file_erase(const struct storage_area *area, size_t sblk,
+			 size_t bcnt)
+{
+	const struct storage_area_file *file =
+		CONTAINER_OF(area, struct storage_area_file, area);
+	int rc = sa_file_valid(file);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	(void)memset(file->data->map + sblk * area->erase_size,
+		     STORAGE_AREA_ERASEVALUE(area), bcnt * area->erase_size);
+	return 0;
+}
+
+static int sa_file_blank_check(const struct storage_area *area,
+			       sa_off_t offset, size_t len)
+{
+	const struct storage_area_file *file =
+		CONTAINER_OF(area, struct storage_area_file, area);
+	int rc = sa_file_valid(file);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	if (!storage_area_mem_blank(file->data->map + offset, len,
+				    STORAGE_AREA_ERASEVALUE(area))) {
+		return -ENOTEMPTY;
+	}
+
+	return 0;
+}
+
+static int sa_file_ioctl(const struct storage_area *area,
+			 enum storage_area_ioctl_cmd cmd, void *data)
+{
+	const struct storage_area_file *file =
+		CONTAINER_OF(area, struct storage_area_file, area);
+	int rc = sa_file_valid(file);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	switch (cmd) {
+	case STORAGE_AREA_IOCTL_XIPADDRESS:
+		if (data == NULL) {
+			LOG_DBG("No return data supplied");
+			rc = -EINVAL;
+			break;
+		}
+
+		uintptr_t *xip_address = (uintptr_t *)data;
+		*xip_address = (uintptr_t)file->data->map;
+		break;
+	case STORAGE_AREA_IOCTL_FLUSH:
+		if (sa_file_native_sync(file->data->map,
+					sa_file_size(area)) != 0) {
+			rc = -EIO;
+		}
+
+		break;
+	default:
+		rc = -ENOTSUP;
+		break;
+	}
+
+	return rc;
+}
+
+const struct storage_area_api storage_area_file_rw_api = {
+	.readv = sa_file_readv,
+	.writev = sa_file_writev,
+	.erase = sa_file_erase,
+	.blank_check = sa_file_blank_check,
+	.ioctl = sa_file_ioctl,
+};
+
+const struct storage_area_api storage_area_file_ro_api = {
+	.readv = sa_file_readv,
+	.blank_check = sa_file_blank_check,
+	.ioctl = sa_file_ioctl,
+};
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "storage_area_file_native.h"
+
+/* open a file in the temporary directory that is removed when unmapped */
+static int sa_file_native_open_tmp(void)
+{
+	const char *dir = getenv("TMPDIR");
+	char path[256];
+	int fd;
+
+	if ((dir == NULL) || (*dir == '\0')) {
+		dir = "/tmp";
+	}
+
+	if (snprintf(path, sizeof(path), "%s/storage_area_XXXXXX", dir) >=
+	    (int)sizeof(path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+
+	fd = mkstemp(path);
+	if (fd >= 0) {
+		(void)unlink(path);
+	}
+
+	return fd;
+}
+
+int sa_file_native_map(const char *path, size_t size,
+		       unsigned char erase_value, void **map)
+{
+	struct stat st;
+	void *addr;
+	int fd;
+
+	if (path == NULL) {
+		path = "temporary file";
+		fd = sa_file_native_open_tmp();
+	} else {
+		fd = open(path, O_RDWR | O_CREAT, 0600);
+	}
+
+	if (fd < 0) {
+		fprintf(stderr, "storage_area_file: cannot open %s (%s)\n", path,
+			strerror(errno));
+		return -1;
+	}
+
+	if ((fstat(fd, &st) < 0) ||
+	    (((size_t)st.st_size < size) && (ftruncate(fd, size) < 0))) {
+		fprintf(stderr, "storage_area_file: cannot size %s (%s)\n", path,
+			strerror(errno));
+		(void)close(fd);
+		return -1;
+	}
+
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	/* the mapping stays valid after close */
+	(void)close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, "storage_area_file: cannot map %s (%s)\n", path,
+			strerror(errno));
+		return -1;
+	}
+
+	if ((size_t)st.st_size < size) {
+		(void)memset((unsigned char *)addr + st.st_size, erase_value,
+			     size - (size_t)st.st_size);
+	}
+
+	*map = addr;
+	return 0;
+}
+
+int sa_file_native_sync(void *map, size_t size)
+{
+	return (msync(map, size, MS_SYNC) < 0) ? -1 : 0;
+}
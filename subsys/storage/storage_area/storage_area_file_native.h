@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host side of the storage area on a host file, this is built with the host
+ * libc (no zephyr headers).
+ */
+
+#ifndef SUBSYS_STORAGE_STORAGE_AREA_FILE_NATIVE_H_
+#define SUBSYS_STORAGE_STORAGE_AREA_FILE_NATIVE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Map size bytes of the file at path (created when needed, a NULL path maps a
+ * temporary file that is removed at exit), the part of the file that is added
+ * is filled with erase_value. Returns 0 on success, -1 on failure.
+ */
+int sa_file_native_map(const char *path, size_t size,
+		       unsigned char erase_value, void **map);
+
+/* Write the mapping to the file. Returns 0 on success, -1 on failure. */
+int sa_file_native_sync(void *map, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SUBSYS_STORAGE_STORAGE_AREA_FILE_NATIVE_H_ */
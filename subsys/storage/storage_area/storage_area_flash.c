@@ -11,7 +11,7 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(storage_area_flash, CONFIG_STORAGE_AREA_LOG_LEVEL);
 
-static int sa_flash_valid(const struct storage_area_flash *flash)
+static int sa_flash_init(const struct storage_area_flash *flash)
 {
 	if (!device_is_ready(flash->dev)) {
 		LOG_DBG("Device is not ready");
@@ -35,6 +35,11 @@ static int sa_flash_valid(const struct storage_area_flash *flash)
 			return -EINVAL;
 		}
 
+		if (wbs > CONFIG_STORAGE_AREA_WRITE_BUFSIZE) {
+			LOG_DBG("Write block size exceeds write buffer size");
+			return -EINVAL;
+		}
+
 		for (size_t i = 0; i < area->erase_blocks; i++) {
 			off_t off = flash->doffset + i * area->erase_size;
 			int rc;
@@ -56,11 +61,24 @@ static int sa_flash_valid(const struct storage_area_flash *flash)
 	return 0;
 }
 
+static int sa_flash_valid(const struct storage_area_flash *flash)
+{
+	int rc = 0;
+
+	if (!flash->data->ready) {
+		rc = sa_flash_init(flash);
+		flash->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
 static int sa_flash_readv(const struct storage_area *area, sa_off_t offset,
 			  const struct storage_area_iovec *iovec, size_t iovcnt)
 {
 	const struct storage_area_flash *flash =
 		CONTAINER_OF(area, struct storage_area_flash, area);
+	uint8_t buf[CONFIG_STORAGE_AREA_WRITE_BUFSIZE];
 	int rc = sa_flash_valid(flash);
 
 	if (rc != 0) {
@@ -69,13 +87,38 @@ static int sa_flash_readv(const struct storage_area *area, sa_off_t offset,
 
 	off_t rdoff = flash->doffset + (off_t)offset;
 
-	for (size_t i = 0U; i < iovcnt; i++) {
-		rc = flash_read(flash->dev, rdoff, iovec[i].data, iovec[i].len);
+	for (size_t i = 0U; i < iovcnt;) {
+		size_t cnt = 1U;
+		size_t len = iovec[i].len;
+
+		/* adjacent small elements are read in one flash access */
+		while (((i + cnt) < iovcnt) &&
+		       ((len + iovec[i + cnt].len) <= sizeof(buf))) {
+			len += iovec[i + cnt].len;
+			cnt++;
+		}
+
+		if (cnt == 1U) {
+			rc = flash_read(flash->dev, rdoff, iovec[i].data, len);
+		} else {
+			rc = flash_read(flash->dev, rdoff, buf, len);
+		}
+
 		if (rc != 0) {
 			break;
 		}
 
-		rdoff += iovec[i].len;
+		if (cnt > 1U) {
+			const uint8_t *rd = buf;
+
+			for (size_t j = i; j < (i + cnt); j++) {
+				memcpy(iovec[j].data, rd, iovec[j].len);
+				rd += iovec[j].len;
+			}
+		}
+
+		i += cnt;
+		rdoff += len;
 	}
 
 	if (rc != 0) {
@@ -130,8 +173,10 @@ static int sa_flash_writev(const struct storage_area *area, sa_off_t offset,
 {
 	const struct storage_area_flash *flash =
 		CONTAINER_OF(area, struct storage_area_flash, area);
-	const size_t align = area->write_size;
-	uint8_t buf[align];
+	/* larger write blocks are written in parts of the buffer size */
+	const size_t align =
+		MIN(area->write_size, CONFIG_STORAGE_AREA_WRITE_BUFSIZE);
+	uint8_t buf[CONFIG_STORAGE_AREA_WRITE_BUFSIZE];
 	size_t bpos = 0U;
 	int rc = sa_flash_valid(flash);
 
@@ -139,46 +184,43 @@ static int sa_flash_writev(const struct storage_area *area, sa_off_t offset,
 		goto end;
 	}
 
-	for (size_t i = 0U; i < iovcnt; i++) {
-		uint8_t *data8 = (uint8_t *)iovec[i].data;
+	/*
+	 * the elements are gathered in the buffer and written when it is full,
+	 * parts of an element that fill the buffer are written directly
+	 */
+	for (size_t i = 0U; (rc == 0) && (i < iovcnt); i++) {
+		const uint8_t *data8 = (const uint8_t *)iovec[i].data;
 		size_t blen = iovec[i].len;
 
-		if (bpos != 0U) {
-			size_t cplen = MIN(blen, align - bpos);
-
-			memcpy(buf + bpos, data8, cplen);
-			bpos += cplen;
-			blen -= cplen;
-			data8 += cplen;
-
-			if (bpos == align) {
-				rc = sa_flash_write(flash, offset, buf, align);
-				if (rc != 0) {
-					break;
-				}
-
-				offset += align;
-				bpos = 0U;
+		while ((rc == 0) && (blen != 0U)) {
+			size_t wrlen;
+
+			if ((bpos == 0U) && (blen >= sizeof(buf))) {
+				wrlen = blen & ~(align - 1);
+				rc = sa_flash_write(flash, offset, data8,
+						    wrlen);
+				offset += wrlen;
+				data8 += wrlen;
+				blen -= wrlen;
+				continue;
 			}
-		}
 
-		if (blen >= align) {
-			size_t wrlen = blen & ~(align - 1);
+			wrlen = MIN(blen, sizeof(buf) - bpos);
+			memcpy(buf + bpos, data8, wrlen);
+			bpos += wrlen;
+			data8 += wrlen;
+			blen -= wrlen;
 
-			rc = sa_flash_write(flash, offset, data8, wrlen);
-			if (rc != 0) {
-				break;
+			if (bpos == sizeof(buf)) {
+				rc = sa_flash_write(flash, offset, buf, bpos);
+				offset += bpos;
+				bpos = 0U;
 			}
-
-			blen -= wrlen;
-			data8 += wrlen;
-			offset += wrlen;
 		}
+	}
 
-		if (blen > 0U) {
-			memcpy(buf, data8, blen);
-			bpos = blen;
-		}
+	if ((rc == 0) && (bpos != 0U)) {
+		rc = sa_flash_write(flash, offset, buf, bpos);
 	}
 end:
 	return rc;
@@ -206,6 +248,32 @@ end:
 	return rc;
 }
 
+static int sa_flash_blank_check(const struct storage_area *area,
+				sa_off_t offset, size_t len)
+{
+	const struct storage_area_flash *flash =
+		CONTAINER_OF(area, struct storage_area_flash, area);
+	int rc = sa_flash_valid(flash);
+
+	if (rc != 0) {
+		goto end;
+	}
+
+	if (flash->xip_address == STORAGE_AREA_FLASH_NO_XIP) {
+		/* read back by storage_area_blank_check() */
+		rc = -ENOTSUP;
+		goto end;
+	}
+
+	const void *rd = (const void *)(flash->xip_address + (uintptr_t)offset);
+
+	if (!storage_area_mem_blank(rd, len, STORAGE_AREA_ERASEVALUE(area))) {
+		rc = -ENOTEMPTY;
+	}
+end:
+	return rc;
+}
+
 static int sa_flash_ioctl(const struct storage_area *area,
 			  enum storage_area_ioctl_cmd cmd, void *data)
 {
@@ -247,10 +315,12 @@ const struct storage_area_api storage_area_flash_rw_api = {
 	.readv = sa_flash_readv,
 	.writev = sa_flash_writev,
 	.erase = sa_flash_erase,
+	.blank_check = sa_flash_blank_check,
 	.ioctl = sa_flash_ioctl,
 };
 
 const struct storage_area_api storage_area_flash_ro_api = {
 	.readv = sa_flash_readv,
+	.blank_check = sa_flash_blank_check,
 	.ioctl = sa_flash_ioctl,
 };
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <zephyr/storage/storage_area/storage_area_mirror.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(storage_area_mirror, CONFIG_STORAGE_AREA_LOG_LEVEL);
+
+static void sa_mirror_lock(const struct storage_area_mirror *mirror)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(mirror->lock, K_FOREVER);
+#else
+	ARG_UNUSED(mirror);
+#endif
+}
+
+static void sa_mirror_unlock(const struct storage_area_mirror *mirror)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(mirror->lock);
+#else
+	ARG_UNUSED(mirror);
+#endif
+}
+
+static int sa_mirror_init(const struct storage_area_mirror *mirror)
+{
+	const struct storage_area *area = &mirror->area;
+
+	for (size_t i = 0U; i < mirror->cnt; i++) {
+		const struct storage_area *replica = mirror->replicas[i];
+
+		if ((replica == NULL) || (replica->api == NULL)) {
+			LOG_DBG("Bad replica %zu", i);
+			return -EINVAL;
+		}
+
+		if ((replica->write_size != area->write_size) ||
+		    (replica->erase_size != area->erase_size) ||
+		    (replica->erase_blocks != area->erase_blocks) ||
+		    (replica->props != area->props)) {
+			LOG_DBG("Replica %zu definition differs", i);
+			return -EINVAL;
+		}
+	}
+
+	for (size_t i = 0U; i < mirror->cnt; i++) {
+		(void)atomic_set(&mirror->busy[i], 0);
+	}
+
+	(void)atomic_set(&mirror->data->next, 0);
+	(void)atomic_set(&mirror->data->failed, 0);
+	return 0;
+}
+
+/* called with the mirror locked */
+static int sa_mirror_valid(const struct storage_area_mirror *mirror)
+{
+	int rc = 0;
+
+	if (!mirror->data->ready) {
+		rc = sa_mirror_init(mirror);
+		mirror->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
+/* the lock is only taken for the first use verification */
+static int sa_mirror_ready(const struct storage_area_mirror *mirror)
+{
+	int rc;
+
+	if (mirror->data->ready) {
+		return 0;
+	}
+
+	sa_mirror_lock(mirror);
+	rc = sa_mirror_valid(mirror);
+	sa_mirror_unlock(mirror);
+	return rc;
+}
+
+static bool sa_mirror_failed(const struct storage_area_mirror *mirror,
+			     size_t idx)
+{
+	return atomic_test_bit(&mirror->data->failed, idx);
+}
+
+/* a replica that failed a write or erase no longer holds the mirror data */
+static void sa_mirror_fail(const struct storage_area_mirror *mirror,
+			   size_t idx, int rc)
+{
+	LOG_DBG("replica %zu failed [%d], it is no longer used", idx, rc);
+	atomic_set_bit(&mirror->data->failed, idx);
+}
+
+/* select the replica for a read, returns mirror->cnt when none is left */
+static size_t sa_mirror_select(const struct storage_area_mirror *mirror)
+{
+	const size_t start = (size_t)atomic_inc(&mirror->data->next);
+	size_t idx = mirror->cnt;
+
+	for (size_t i = 0U; i < mirror->cnt; i++) {
+		const size_t walk = (start + i) % mirror->cnt;
+
+		if (sa_mirror_failed(mirror, walk)) {
+			continue;
+		}
+
+		if (idx == mirror->cnt) {
+			idx = walk;
+#ifdef CONFIG_STORAGE_AREA_MIRROR_READ_LEAST_BUSY
+		/* equally busy replicas are used round-robin */
+		} else if (atomic_get(&mirror->busy[walk]) <
+			   atomic_get(&mirror->busy[idx])) {
+			idx = walk;
+#endif /* CONFIG_STORAGE_AREA_MIRROR_READ_LEAST_BUSY */
+		}
+	}
+
+	return idx;
+}
+
+/* next replica to retry a read on, returns mirror->cnt when none is left */
+static size_t sa_mirror_retry(const struct storage_area_mirror *mirror,
+			      size_t start, size_t idx)
+{
+	do {
+		idx = (idx + 1U) % mirror->cnt;
+	} while ((idx != start) && (sa_mirror_failed(mirror, idx)));
+
+	return (idx == start) ? mirror->cnt : idx;
+}
+
+/*
+ * Reads and blank checks run without the lock (see storage_area_mirror.h):
+ * the replica selection, the busy counters and the failed replicas are atomic,
+ * and sa_mirror_ready() takes the lock for the first use verification.
+ */
+static int sa_mirror_readv(const struct storage_area *area, sa_off_t offset,
+			   const struct storage_area_iovec *iovec,
+			   size_t iovcnt)
+{
+	const struct storage_area_mirror *mirror =
+		CONTAINER_OF(area, struct storage_area_mirror, area);
+	size_t start, idx;
+	int rc;
+
+	rc = sa_mirror_ready(mirror);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = -EIO;
+	start = sa_mirror_select(mirror);
+	for (idx = start; idx < mirror->cnt;
+	     idx = sa_mirror_retry(mirror, start, idx)) {
+		(void)atomic_inc(&mirror->busy[idx]);
+		rc = storage_area_readv(mirror->replicas[idx], offset, iovec,
+					iovcnt);
+		(void)atomic_dec(&mirror->busy[idx]);
+		if (rc == 0) {
+			break;
+		}
+
+		LOG_DBG("read failed on replica %zu [%d]", idx, rc);
+	}
+
+	return rc;
+}
+
+static int sa_mirror_writev(const struct storage_area *area, sa_off_t offset,
+			    const struct storage_area_iovec *iovec,
+			    size_t iovcnt)
+{
+	const struct storage_area_mirror *mirror =
+		CONTAINER_OF(area, struct storage_area_mirror, area);
+	bool done = false;
+	int rc;
+
+	sa_mirror_lock(mirror);
+	rc = sa_mirror_valid(mirror);
+	if (rc != 0) {
+		goto end;
+	}
+
+	/* write all working replicas, report the first failure */
+	for (size_t i = 0U; i < mirror->cnt; i++) {
+		if (sa_mirror_failed(mirror, i)) {
+			continue;
+		}
+
+		int rrc = storage_area_writev(mirror->replicas[i], offset,
+					      iovec, iovcnt);
+
+		if (rrc != 0) {
+			sa_mirror_fail(mirror, i, rrc);
+			rc = (rc == 0) ? rrc : rc;
+		}
+
+		done = true;
+	}
+
+	rc = done ? rc : -EIO;
+end:
+	sa_mirror_unlock(mirror);
+	return rc;
+}
+
+static int sa_mirror_erase(const struct storage_area *area, size_t sblk,
+			   size_t bcnt)
+{
+	const struct storage_area_mirror *mirror =
+		CONTAINER_OF(area, struct storage_area_mirror, area);
+	bool done = false;
+	int rc;
+
+	sa_mirror_lock(mirror);
+	rc = sa_mirror_valid(mirror);
+	if (rc != 0) {
+		goto end;
+	}
+
+	for (size_t i = 0U; i < mirror->cnt; i++) {
+		if (sa_mirror_failed(mirror, i)) {
+			continue;
+		}
+
+		int rrc = storage_area_erase(mirror->replicas[i], sblk, bcnt);
+
+		if (rrc != 0) {
+			sa_mirror_fail(mirror, i, rrc);
+			rc = (rc == 0) ? rrc : rc;
+		}
+
+		done = true;
+	}
+
+	rc = done ? rc : -EIO;
+end:
+	sa_mirror_unlock(mirror);
+	return rc;
+}
+
+static int sa_mirror_blank_check(const struct storage_area *area,
+				 sa_off_t offset, size_t len)
+{
+	const struct storage_area_mirror *mirror =
+		CONTAINER_OF(area, struct storage_area_mirror, area);
+	size_t start, idx;
+	int rc;
+
+	rc = sa_mirror_ready(mirror);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = -EIO;
+	start = sa_mirror_select(mirror);
+	for (idx = start; idx < mirror->cnt;
+	     idx = sa_mirror_retry(mirror, start, idx)) {
+		(void)atomic_inc(&mirror->busy[idx]);
+		rc = storage_area_blank_check(mirror->replicas[idx], offset,
+					      len);
+		(void)atomic_dec(&mirror->busy[idx]);
+		/* only retry when the replica could not be checked */
+		if ((rc == 0) || (rc == -ENOTEMPTY)) {
+			break;
+		}
+
+		LOG_DBG("blank check failed on replica %zu [%d]", idx, rc);
+	}
+
+	return rc;
+}
+
+static int sa_mirror_ioctl(const struct storage_area *area,
+			   enum storage_area_ioctl_cmd cmd, void *data)
+{
+	const struct storage_area_mirror *mirror =
+		CONTAINER_OF(area, struct storage_area_mirror, area);
+	int rc;
+
+	sa_mirror_lock(mirror);
+	rc = sa_mirror_valid(mirror);
+	if (rc != 0) {
+		goto end;
+	}
+
+	switch (cmd) {
+	case STORAGE_AREA_IOCTL_FLUSH:
+		for (size_t i = 0U; i < mirror->cnt; i++) {
+			if (sa_mirror_failed(mirror, i)) {
+				continue;
+			}
+
+			rc = storage_area_ioctl(mirror->replicas[i], cmd, data);
+			if (rc == -ENOTSUP) {
+				rc = 0;
+			}
+
+			if (rc != 0) {
+				sa_mirror_fail(mirror, i, rc);
+				break;
+			}
+		}
+
+		break;
+	case STORAGE_AREA_IOCTL_DISCARD:
+		if (data == NULL) {
+			rc = -EINVAL;
+			break;
+		}
+
+		const struct storage_area_blocks *blocks =
+			(const struct storage_area_blocks *)data;
+
+		for (size_t i = 0U; i < mirror->cnt; i++) {
+			if (sa_mirror_failed(mirror, i)) {
+				continue;
+			}
+
+			int rrc = storage_area_discard(mirror->replicas[i],
+						       blocks->sblk,
+						       blocks->bcnt);
+
+			if (rrc != 0) {
+				sa_mirror_fail(mirror, i, rrc);
+				rc = (rc == 0) ? rrc : rc;
+			}
+		}
+
+		break;
+	case STORAGE_AREA_IOCTL_XIPADDRESS:
+		/* all working replicas hold the same data */
+		rc = -EIO;
+		for (size_t i = 0U; i < mirror->cnt; i++) {
+			if (sa_mirror_failed(mirror, i)) {
+				continue;
+			}
+
+			rc = storage_area_ioctl(mirror->replicas[i], cmd, data);
+			break;
+		}
+
+		break;
+	case STORAGE_AREA_IOCTL_MIRROR_FAILED:
+		if (data == NULL) {
+			rc = -EINVAL;
+			break;
+		}
+
+		*(uint32_t *)data = (uint32_t)atomic_get(&mirror->data->failed);
+		break;
+	case STORAGE_AREA_IOCTL_MIRROR_RESTORE:
+		(void)atomic_set(&mirror->data->failed, 0);
+		break;
+	default:
+		rc = -ENOTSUP;
+		break;
+	}
+end:
+	sa_mirror_unlock(mirror);
+	return rc;
+}
+
+const struct storage_area_api storage_area_mirror_rw_api = {
+	.readv = sa_mirror_readv,
+	.writev = sa_mirror_writev,
+	.erase = sa_mirror_erase,
+	.blank_check = sa_mirror_blank_check,
+	.ioctl = sa_mirror_ioctl,
+};
+
+const struct storage_area_api storage_area_mirror_ro_api = {
+	.readv = sa_mirror_readv,
+	.blank_check = sa_mirror_blank_check,
+	.ioctl = sa_mirror_ioctl,
+};
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/storage/storage_area/storage_area_nor_sim.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(storage_area_nor_sim, CONFIG_STORAGE_AREA_LOG_LEVEL);
+
+static void sa_nor_sim_lock(const struct storage_area_nor_sim *nor)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(nor->lock, K_FOREVER);
+#else
+	ARG_UNUSED(nor);
+#endif
+}
+
+static void sa_nor_sim_unlock(const struct storage_area_nor_sim *nor)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(nor->lock);
+#else
+	ARG_UNUSED(nor);
+#endif
+}
+
+static size_t sa_nor_sim_size(const struct storage_area *area)
+{
+	return area->erase_blocks * area->erase_size;
+}
+
+/* called with the nor flash locked, the flash starts erased */
+static void sa_nor_sim_valid(const struct storage_area_nor_sim *nor)
+{
+	const struct storage_area *area = &nor->area;
+
+	if (nor->data->ready) {
+		return;
+	}
+
+	(void)memset(nor->mem, STORAGE_AREA_ERASEVALUE(area),
+		     sa_nor_sim_size(area));
+	(void)memset(nor->programs, 0,
+		     sa_nor_sim_size(area) / area->write_size);
+	nor->data->ready = true;
+}
+
+static void sa_nor_sim_busy(const struct storage_area_nor_sim *nor,
+			    uint32_t us)
+{
+	nor->data->stats.busy_us += us;
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM_BUSY_WAIT
+	if (us != 0U) {
+		k_busy_wait(us);
+	}
+#endif /* CONFIG_STORAGE_AREA_NOR_SIM_BUSY_WAIT */
+}
+
+/* the program time below 1 us is kept for the next write */
+static void sa_nor_sim_program_time(const struct storage_area_nor_sim *nor,
+				    size_t len)
+{
+	struct storage_area_nor_sim_data *data = nor->data;
+	const uint64_t ns = (uint64_t)len * nor->program_ns + data->program_ns;
+
+	data->program_ns = (uint32_t)(ns % 1000U);
+	sa_nor_sim_busy(nor, (uint32_t)(ns / 1000U));
+}
+
+static void sa_nor_sim_erase_block(const struct storage_area_nor_sim *nor,
+				   size_t blk)
+{
+	const struct storage_area *area = &nor->area;
+	const size_t esz = area->erase_size;
+	const size_t wbcnt = esz / area->write_size;
+
+	(void)memset(nor->mem + blk * esz, STORAGE_AREA_ERASEVALUE(area), esz);
+	(void)memset(nor->programs + blk * wbcnt, 0, wbcnt);
+	if (nor->wear[blk] != UINT32_MAX) {
+		nor->wear[blk]++;
+	}
+
+	nor->data->stats.erases++;
+	sa_nor_sim_busy(nor, nor->erase_us);
+}
+
+static int sa_nor_sim_readv(const struct storage_area *area, sa_off_t offset,
+			    const struct storage_area_iovec *iovec,
+			    size_t iovcnt)
+{
+	const struct storage_area_nor_sim *nor =
+		CONTAINER_OF(area, struct storage_area_nor_sim, area);
+	struct storage_area_nor_sim_stats *stats = &nor->data->stats;
+
+	sa_nor_sim_lock(nor);
+	sa_nor_sim_valid(nor);
+
+	const uint8_t *rd = nor->mem + (size_t)offset;
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		memcpy(iovec[i].data, rd, iovec[i].len);
+		rd += iovec[i].len;
+		stats->read_bytes += iovec[i].len;
+	}
+
+	stats->reads++;
+	sa_nor_sim_unlock(nor);
+	return 0;
+}
+
+/*
+ * verify that a write follows the nor flash rules, the flash from offset
+ * erased onwards is checked as if it is erased (autoerase).
+ */
+static int sa_nor_sim_check(const struct storage_area_nor_sim *nor,
+			    size_t offset, size_t erased,
+			    const struct storage_area_iovec *iovec,
+			    size_t iovcnt, size_t len)
+{
+	const struct storage_area *area = &nor->area;
+	const size_t ws = area->write_size;
+	const uint8_t limit = STORAGE_AREA_LOVRWRITE(area)
+				      ? CONFIG_STORAGE_AREA_NOR_SIM_PROGRAM_LIMIT
+				      : 1U;
+	const bool zeroerase =
+		STORAGE_AREA_HAS_PROPERTY(area, STORAGE_AREA_PROP_ZEROERASE);
+	const uint8_t erase_value = STORAGE_AREA_ERASEVALUE(area);
+	size_t off = offset;
+
+	if ((offset & (ws - 1)) != 0U) {
+		LOG_DBG("Write at 0x%zx is not aligned", offset);
+		return -EINVAL;
+	}
+
+	for (size_t wb = offset / ws; wb < (MIN(offset + len, erased) / ws);
+	     wb++) {
+		if (nor->programs[wb] >= limit) {
+			LOG_DBG("Write block at 0x%zx is programmed %u times",
+				wb * ws, nor->programs[wb]);
+			return -EIO;
+		}
+	}
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		const uint8_t *data8 = (const uint8_t *)iovec[i].data;
+
+		for (size_t j = 0U; j < iovec[i].len; j++) {
+			const uint8_t mem =
+				(off < erased) ? nor->mem[off] : erase_value;
+			const uint8_t set = zeroerase ? (mem & ~data8[j])
+						      : (data8[j] & ~mem);
+
+			if (set != 0U) {
+				LOG_DBG("Write at 0x%zx changes erased bits",
+					off);
+				return -EIO;
+			}
+
+			off++;
+		}
+	}
+
+	return 0;
+}
+
+static int sa_nor_sim_writev(const struct storage_area *area, sa_off_t offset,
+			     const struct storage_area_iovec *iovec,
+			     size_t iovcnt)
+{
+	const struct storage_area_nor_sim *nor =
+		CONTAINER_OF(area, struct storage_area_nor_sim, area);
+	struct storage_area_nor_sim_stats *stats = &nor->data->stats;
+	const size_t esz = area->erase_size;
+	const size_t ws = area->write_size;
+	const size_t start = (size_t)offset;
+	size_t len = 0U;
+	size_t erased;
+	int rc;
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		len += iovec[i].len;
+	}
+
+	/* autoerase: the blocks that start in the write are erased first */
+	erased = start + len;
+	if (STORAGE_AREA_AUTOERASE(area)) {
+		erased = MIN(erased, ROUND_UP(start, esz));
+	}
+
+	sa_nor_sim_lock(nor);
+	sa_nor_sim_valid(nor);
+
+	/* a refused write leaves the flash (and the wear) unchanged */
+	rc = sa_nor_sim_check(nor, start, erased, iovec, iovcnt, len);
+	if (rc != 0) {
+		stats->violations++;
+		goto end;
+	}
+
+	if (STORAGE_AREA_AUTOERASE(area)) {
+		for (size_t blk = DIV_ROUND_UP(start, esz);
+		     (blk * esz) < (start + len); blk++) {
+			sa_nor_sim_erase_block(nor, blk);
+		}
+	}
+
+	uint8_t *wr = nor->mem + start;
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		memcpy(wr, iovec[i].data, iovec[i].len);
+		wr += iovec[i].len;
+	}
+
+	for (size_t wb = start / ws; wb < ((start + len) / ws); wb++) {
+		nor->programs[wb]++;
+	}
+
+	stats->writes++;
+	stats->write_bytes += len;
+	sa_nor_sim_program_time(nor, len);
+end:
+	sa_nor_sim_unlock(nor);
+	return rc;
+}
+
+static int sa_nor_sim_erase(const struct storage_area *area, size_t sblk,
+			    size_t bcnt)
+{
+	const struct storage_area_nor_sim *nor =
+		CONTAINER_OF(area, struct storage_area_nor_sim, area);
+
+	sa_nor_sim_lock(nor);
+	sa_nor_sim_valid(nor);
+	for (size_t blk = sblk; blk < (sblk + bcnt); blk++) {
+		sa_nor_sim_erase_block(nor, blk);
+	}
+
+	sa_nor_sim_unlock(nor);
+	return 0;
+}
+
+static int sa_nor_sim_blank_check(const struct storage_area *area,
+				  sa_off_t offset, size_t len)
+{
+	const struct storage_area_nor_sim *nor =
+		CONTAINER_OF(area, struct storage_area_nor_sim, area);
+	int rc = 0;
+
+	sa_nor_sim_lock(nor);
+	sa_nor_sim_valid(nor);
+	if (!storage_area_mem_blank(nor->mem + (size_t)offset, len,
+				    STORAGE_AREA_ERASEVALUE(area))) {
+		rc = -ENOTEMPTY;
+	}
+
+	sa_nor_sim_unlock(nor);
+	return rc;
+}
+
+static int sa_nor_sim_ioctl(const struct storage_area *area,
+			    enum storage_area_ioctl_cmd cmd, void *data)
+{
+	const struct storage_area_nor_sim *nor =
+		CONTAINER_OF(area, struct storage_area_nor_sim, area);
+	struct storage_area_nor_sim_wear *wear =
+		(struct storage_area_nor_sim_wear *)data;
+	int rc = 0;
+
+	sa_nor_sim_lock(nor);
+	switch (cmd) {
+	case STORAGE_AREA_IOCTL_NOR_SIM_STATS:
+		if (data == NULL) {
+			LOG_DBG("No return data supplied");
+			rc = -EINVAL;
+			break;
+		}
+
+		memcpy(data, &nor->data->stats,
+		       sizeof(struct storage_area_nor_sim_stats));
+		break;
+	case STORAGE_AREA_IOCTL_NOR_SIM_WEAR:
+		if ((wear == NULL) || (wear->blk >= area->erase_blocks)) {
+			rc = -EINVAL;
+			break;
+		}
+
+		wear->erases = nor->wear[wear->blk];
+		break;
+	default:
+		rc = -ENOTSUP;
+		break;
+	}
+
+	sa_nor_sim_unlock(nor);
+	return rc;
+}
+
+const struct storage_area_api storage_area_nor_sim_rw_api = {
+	.readv = sa_nor_sim_readv,
+	.writev = sa_nor_sim_writev,
+	.erase = sa_nor_sim_erase,
+	.blank_check = sa_nor_sim_blank_check,
+	.ioctl = sa_nor_sim_ioctl,
+};
+
+const struct storage_area_api storage_area_nor_sim_ro_api = {
+	.readv = sa_nor_sim_readv,
+	.blank_check = sa_nor_sim_blank_check,
+	.ioctl = sa_nor_sim_ioctl,
+};
@@ -31,47 +31,15 @@ static int sa_ram_writev(const struct storage_area *area, sa_off_t offset,
 {
 	const struct storage_area_ram *ram =
 		CONTAINER_OF(area, struct storage_area_ram, area);
-	const size_t align = area->write_size;
 	uint8_t *wr = (uint8_t *)(ram->start + (uintptr_t)offset);
-	uint8_t buf[align];
-	size_t bpos = 0U;
-	int rc = 0;
 
+	/* ram is byte addressable: parts of write blocks are copied in place */
 	for (size_t i = 0U; i < iovcnt; i++) {
-		uint8_t *data8 = (uint8_t *)iovec[i].data;
-		size_t blen = iovec[i].len;
-
-		if (bpos != 0U) {
-			size_t cplen = MIN(blen, align - bpos);
-
-			memcpy(buf + bpos, data8, cplen);
-			bpos += cplen;
-			blen -= cplen;
-			data8 += cplen;
-
-			if (bpos == align) {
-				memcpy(wr, buf, align);
-				wr += align;
-				bpos = 0U;
-			}
-		}
-
-		if (blen >= align) {
-			size_t wrlen = blen & ~(align - 1);
-
-			memcpy(wr, data8, wrlen);
-			blen -= wrlen;
-			data8 += wrlen;
-			wr += wrlen;
-		}
-
-		if (blen > 0U) {
-			memcpy(buf, data8, blen);
-			bpos = blen;
-		}
+		memcpy(wr, iovec[i].data, iovec[i].len);
+		wr += iovec[i].len;
 	}
 
-	return rc;
+	return 0;
 }
 
 static int sa_ram_erase(const struct storage_area *area, size_t sblk,
@@ -85,6 +53,20 @@ static int sa_ram_erase(const struct storage_area *area, size_t sblk,
 	return 0;
 }
 
+static int sa_ram_blank_check(const struct storage_area *area,
+			      sa_off_t offset, size_t len)
+{
+	const struct storage_area_ram *ram =
+		CONTAINER_OF(area, struct storage_area_ram, area);
+	const void *rd = (const void *)(ram->start + (uintptr_t)offset);
+
+	if (!storage_area_mem_blank(rd, len, STORAGE_AREA_ERASEVALUE(area))) {
+		return -ENOTEMPTY;
+	}
+
+	return 0;
+}
+
 static int sa_ram_ioctl(const struct storage_area *area,
 			enum storage_area_ioctl_cmd cmd, void *data)
 {
@@ -117,10 +99,12 @@ const struct storage_area_api storage_area_ram_rw_api = {
 	.readv = sa_ram_readv,
 	.writev = sa_ram_writev,
 	.erase = sa_ram_erase,
+	.blank_check = sa_ram_blank_check,
 	.ioctl = sa_ram_ioctl,
 };
 
 const struct storage_area_api storage_area_ram_ro_api = {
 	.readv = sa_ram_readv,
+	.blank_check = sa_ram_blank_check,
 	.ioctl = sa_ram_ioctl,
 };
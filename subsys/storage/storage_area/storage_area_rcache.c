@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/storage/storage_area/storage_area_rcache.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(storage_area_rcache, CONFIG_STORAGE_AREA_LOG_LEVEL);
+
+static void sa_rcache_lock(const struct storage_area_rcache *rcache)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(rcache->lock, K_FOREVER);
+#else
+	ARG_UNUSED(rcache);
+#endif
+}
+
+static void sa_rcache_unlock(const struct storage_area_rcache *rcache)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(rcache->lock);
+#else
+	ARG_UNUSED(rcache);
+#endif
+}
+
+static uint8_t *sa_rcache_line_buf(const struct storage_area_rcache *rcache,
+				   const struct storage_area_rcache_line *line)
+{
+	return rcache->buf + (line - rcache->lines) * rcache->lsize;
+}
+
+/* invalidate the lines that overlap [start, end) */
+static void sa_rcache_invalidate(const struct storage_area_rcache *rcache,
+				 sa_off_t start, sa_off_t end)
+{
+	for (size_t i = 0U; i < rcache->lcnt; i++) {
+		struct storage_area_rcache_line *line = &rcache->lines[i];
+
+		if ((line->valid) && (line->offset < end) &&
+		    ((line->offset + rcache->lsize) > start)) {
+			line->valid = false;
+		}
+	}
+}
+
+static int sa_rcache_init(const struct storage_area_rcache *rcache)
+{
+	const struct storage_area *area = &rcache->area;
+	const struct storage_area *backend = rcache->backend;
+
+	if ((backend == NULL) || (backend->api == NULL)) {
+		LOG_DBG("Bad backend");
+		return -EINVAL;
+	}
+
+	if ((backend->write_size != area->write_size) ||
+	    (backend->erase_size != area->erase_size) ||
+	    (backend->erase_blocks != area->erase_blocks) ||
+	    (backend->props != area->props)) {
+		LOG_DBG("Backend definition differs");
+		return -EINVAL;
+	}
+
+	for (size_t i = 0U; i < rcache->lcnt; i++) {
+		rcache->lines[i].valid = false;
+	}
+
+	rcache->data->stats.hits = 0U;
+	rcache->data->stats.misses = 0U;
+	return 0;
+}
+
+/* called with the cache locked */
+static int sa_rcache_valid(const struct storage_area_rcache *rcache)
+{
+	int rc = 0;
+
+	if (!rcache->data->ready) {
+		rc = sa_rcache_init(rcache);
+		rcache->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
+/*
+ * Get the line at offset, on a miss the least recently used (or an invalid)
+ * line is filled from the backend.
+ */
+static int sa_rcache_line_get(const struct storage_area_rcache *rcache,
+			      sa_off_t offset,
+			      struct storage_area_rcache_line **line)
+{
+	struct storage_area_rcache_data *data = rcache->data;
+	struct storage_area_rcache_line *lru = NULL;
+	int rc;
+
+	for (size_t i = 0U; i < rcache->lcnt; i++) {
+		struct storage_area_rcache_line *walk = &rcache->lines[i];
+
+		if (!walk->valid) {
+			lru = walk;
+			continue;
+		}
+
+		if (walk->offset == offset) {
+			walk->used = data->clock++;
+			data->stats.hits++;
+			*line = walk;
+			return 0;
+		}
+
+		if ((lru == NULL) ||
+		    ((lru->valid) && ((int32_t)(walk->used - lru->used) < 0))) {
+			lru = walk;
+		}
+	}
+
+	data->stats.misses++;
+	lru->valid = false;
+	rc = storage_area_read(rcache->backend, offset,
+			       sa_rcache_line_buf(rcache, lru), rcache->lsize);
+	if (rc != 0) {
+		LOG_DBG("line fill failed at %lx", (long)offset);
+		return rc;
+	}
+
+	lru->offset = offset;
+	lru->used = data->clock++;
+	lru->valid = true;
+	*line = lru;
+	return 0;
+}
+
+static int sa_rcache_readv(const struct storage_area *area, sa_off_t offset,
+			   const struct storage_area_iovec *iovec,
+			   size_t iovcnt)
+{
+	const struct storage_area_rcache *rcache =
+		CONTAINER_OF(area, struct storage_area_rcache, area);
+	const size_t lsize = rcache->lsize;
+	int rc;
+
+	sa_rcache_lock(rcache);
+	rc = sa_rcache_valid(rcache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		uint8_t *data8 = (uint8_t *)iovec[i].data;
+		size_t blen = iovec[i].len;
+
+		while (blen != 0U) {
+			const size_t pos = offset % lsize;
+			const size_t cplen = MIN(blen, lsize - pos);
+			struct storage_area_rcache_line *line;
+
+			rc = sa_rcache_line_get(rcache, offset - pos, &line);
+			if (rc != 0) {
+				goto end;
+			}
+
+			memcpy(data8, sa_rcache_line_buf(rcache, line) + pos,
+			       cplen);
+			offset += cplen;
+			data8 += cplen;
+			blen -= cplen;
+		}
+	}
+end:
+	sa_rcache_unlock(rcache);
+	return rc;
+}
+
+static int sa_rcache_writev(const struct storage_area *area, sa_off_t offset,
+			    const struct storage_area_iovec *iovec,
+			    size_t iovcnt)
+{
+	const struct storage_area_rcache *rcache =
+		CONTAINER_OF(area, struct storage_area_rcache, area);
+	sa_off_t start = offset;
+	sa_off_t end = offset;
+	int rc;
+
+	sa_rcache_lock(rcache);
+	rc = sa_rcache_valid(rcache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		end += iovec[i].len;
+	}
+
+	/* autoerase can erase the blocks that are written */
+	if (STORAGE_AREA_AUTOERASE(area)) {
+		start -= start % area->erase_size;
+		end = ROUND_UP(end, area->erase_size);
+	}
+
+	sa_rcache_invalidate(rcache, start, end);
+	rc = storage_area_writev(rcache->backend, offset, iovec, iovcnt);
+end:
+	sa_rcache_unlock(rcache);
+	return rc;
+}
+
+static int sa_rcache_erase(const struct storage_area *area, size_t sblk,
+			   size_t bcnt)
+{
+	const struct storage_area_rcache *rcache =
+		CONTAINER_OF(area, struct storage_area_rcache, area);
+	const sa_off_t start = (sa_off_t)sblk * area->erase_size;
+	const sa_off_t end = start + (sa_off_t)bcnt * area->erase_size;
+	int rc;
+
+	sa_rcache_lock(rcache);
+	rc = sa_rcache_valid(rcache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	sa_rcache_invalidate(rcache, start, end);
+	rc = storage_area_erase(rcache->backend, sblk, bcnt);
+end:
+	sa_rcache_unlock(rcache);
+	return rc;
+}
+
+static int sa_rcache_blank_check(const struct storage_area *area,
+				 sa_off_t offset, size_t len)
+{
+	const struct storage_area_rcache *rcache =
+		CONTAINER_OF(area, struct storage_area_rcache, area);
+
+	return storage_area_blank_check(rcache->backend, offset, len);
+}
+
+static int sa_rcache_ioctl(const struct storage_area *area,
+			   enum storage_area_ioctl_cmd cmd, void *data)
+{
+	const struct storage_area_rcache *rcache =
+		CONTAINER_OF(area, struct storage_area_rcache, area);
+	int rc;
+
+	sa_rcache_lock(rcache);
+	rc = sa_rcache_valid(rcache);
+	if (rc != 0) {
+		goto end;
+	}
+
+	switch (cmd) {
+	case STORAGE_AREA_IOCTL_CACHE_STATS:
+		if (data == NULL) {
+			rc = -EINVAL;
+			break;
+		}
+
+		memcpy(data, &rcache->data->stats,
+		       sizeof(struct storage_area_cache_stats));
+		break;
+	case STORAGE_AREA_IOCTL_DISCARD:
+		if (data == NULL) {
+			rc = -EINVAL;
+			break;
+		}
+
+		const struct storage_area_blocks *blocks =
+			(const struct storage_area_blocks *)data;
+		const sa_off_t start = (sa_off_t)blocks->sblk * area->erase_size;
+
+		sa_rcache_invalidate(rcache, start,
+				     start + blocks->bcnt * area->erase_size);
+		rc = storage_area_discard(rcache->backend, blocks->sblk,
+					  blocks->bcnt);
+		break;
+	default:
+		/* the cache is coherent with the backend */
+		rc = storage_area_ioctl(rcache->backend, cmd, data);
+		break;
+	}
+end:
+	sa_rcache_unlock(rcache);
+	return rc;
+}
+
+const struct storage_area_api storage_area_rcache_rw_api = {
+	.readv = sa_rcache_readv,
+	.writev = sa_rcache_writev,
+	.erase = sa_rcache_erase,
+	.blank_check = sa_rcache_blank_check,
+	.ioctl = sa_rcache_ioctl,
+};
+
+const struct storage_area_api storage_area_rcache_ro_api = {
+	.readv = sa_rcache_readv,
+	.blank_check = sa_rcache_blank_check,
+	.ioctl = sa_rcache_ioctl,
+};
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/shell/shell.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+
+static void sa_shell_op(const struct shell *sh, const char *name,
+			const struct storage_area_op_stats *ops)
+{
+	shell_print(sh, "  %-5s ops %u errors %u bytes %llu", name, ops->ops,
+		    ops->errors, (unsigned long long)ops->bytes);
+	for (size_t i = 0U; i < STORAGE_AREA_STATS_BUCKETS; i++) {
+		if (ops->latency[i] == 0U) {
+			continue;
+		}
+
+		if (i == (STORAGE_AREA_STATS_BUCKETS - 1)) {
+			shell_print(sh, "    >= %lu us: %u", BIT(i - 1),
+				    ops->latency[i]);
+		} else {
+			shell_print(sh, "    < %lu us: %u", BIT(i),
+				    ops->latency[i]);
+		}
+	}
+}
+
+static void sa_shell_stats(const struct storage_area *area,
+			   const struct storage_area_stats *stats, void *ctx)
+{
+	const struct shell *sh = (const struct shell *)ctx;
+
+	shell_print(sh, "area %p: %zu blocks of %zu bytes", (void *)area,
+		    area->erase_blocks, area->erase_size);
+	sa_shell_op(sh, "read", &stats->read);
+	sa_shell_op(sh, "write", &stats->write);
+	sa_shell_op(sh, "erase", &stats->erase);
+	shell_print(sh, "  erased blocks %llu",
+		    (unsigned long long)stats->erased_blocks);
+	for (size_t i = 0U; i < STORAGE_AREA_STATS_ERASE_BLOCKS; i++) {
+		if (stats->block_erases[i] == 0U) {
+			continue;
+		}
+
+		shell_print(sh, "    block %zu: %u erases", i,
+			    stats->block_erases[i]);
+	}
+}
+
+static void sa_shell_reset(const struct storage_area *area,
+			   const struct storage_area_stats *stats, void *ctx)
+{
+	ARG_UNUSED(stats);
+	ARG_UNUSED(ctx);
+
+	(void)storage_area_ioctl(area, STORAGE_AREA_IOCTL_STATS_RESET, NULL);
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	return storage_area_stats_foreach(sa_shell_stats, (void *)sh);
+}
+
+static int cmd_stats_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(sh);
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	return storage_area_stats_foreach(sa_shell_reset, NULL);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	sub_storage_area,
+	SHELL_CMD(stats, NULL, "Show the storage area i/o statistics",
+		  cmd_stats),
+	SHELL_CMD(stats_reset, NULL, "Clear the storage area i/o statistics",
+		  cmd_stats_reset),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(storage_area, &sub_storage_area, "Storage area commands",
+		   NULL);
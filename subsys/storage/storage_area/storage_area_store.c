@@ -7,6 +7,7 @@
 #include <errno.h>
 #include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/crc.h>
+#include <zephyr/init.h>
 #include <zephyr/storage/storage_area/storage_area_store.h>
 
 #include <zephyr/logging/log.h>
@@ -15,18 +16,86 @@ LOG_MODULE_REGISTER(storage_area_store, CONFIG_STORAGE_AREA_LOG_LEVEL);
 /* record magic: chosen to be different from the erase-value (0x00 or 0xFF) */
 #define SAS_MAGIC      0xF0
 #define SAS_FILLVAL    0xFF
+/* magic of a dropped record copy: differs from the record magic and fill */
+#define SAS_DROPMAGIC  0x00
 
 /* header size: record magic (1 BYTE) + wrapcnt (1 BYTE) + size (2 BYTE) */
 #define SAS_HDRSIZE    4
 #define SAS_CRCINIT    0
 #define SAS_CRCSIZE    sizeof(uint32_t)
 #define SAS_MINBUFSIZE 32
+/* buffer for fill data, larger fills repeat the buffer in an iovec */
+#define SAS_WBUFSIZE                                                           \
+	SAS_MAX(SAS_MINBUFSIZE, CONFIG_STORAGE_AREA_WRITE_BUFSIZE)
+/* buffer for record moves and updates (limits the write size) */
+#define SAS_MOVEBUFSIZE                                                        \
+	SAS_MAX(CONFIG_STORAGE_AREA_STORE_MOVE_BUFSIZE, SAS_WBUFSIZE)
+/* iovec elements needed for the fill of a write block (or less) */
+#define SAS_FILLCNT    DIV_ROUND_UP(SAS_MOVEBUFSIZE, SAS_WBUFSIZE)
+/* maximum iovec elements in a record write */
+#define SAS_MAXIOVCNT  CONFIG_STORAGE_AREA_STORE_MAX_IOVCNT
+
+/* summary magic: chosen to be different from the record magic and erase-value */
+#define SAS_SUMMAGIC   0xF5
+
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+/*
+ * summary header size: summary magic (1 BYTE) + wrapcnt (1 BYTE) + record
+ * count (2 BYTE) + first record location (4 BYTE) + last record location
+ * (4 BYTE)
+ */
+#define SAS_SUMHDRSIZE 12
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM
+#define SAS_BLOOMSIZE   CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM_SIZE
+#define SAS_BLOOMHASHES 3
+#else
+#define SAS_BLOOMSIZE   0
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM */
+#define SAS_SUMSIZE    (SAS_SUMHDRSIZE + SAS_BLOOMSIZE + SAS_CRCSIZE)
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+/* a retired erase block is marked with the maximum erase count */
+#define SAS_RETIRED    UINT32_MAX
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST
+/* erase counter after the sector cookie: uint32_t (4 BYTE) */
+#define SAS_WEARSIZE   4U
+#else
+#define SAS_WEARSIZE   0U
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST */
 
 #define SAS_MIN(a, b)             (a < b ? a : b)
 #define SAS_MAX(a, b)             (a < b ? b : a)
 #define SAS_ALIGNUP(num, align)   (((num) + ((align) - 1)) & ~((align) - 1))
 #define SAS_ALIGNDOWN(num, align) ((num) & ~((align) - 1))
 
+/* the public write iovec count of a store should follow the definitions */
+BUILD_ASSERT(SAS_MAXIOVCNT + 2U + SAS_FILLCNT == STORAGE_AREA_STORE_AREA_IOVCNT,
+	     "Store area iovec count mismatch");
+
+/*
+ * describe len bytes of fill data with iovec elements that all point to the
+ * fill buffer (SAS_WBUFSIZE bytes), returns the number of elements used. A
+ * fill of at most a write block (or of SAS_MOVEBUFSIZE) uses no more than
+ * SAS_FILLCNT elements.
+ */
+static size_t store_fill_iovec(struct storage_area_iovec *iovec, uint8_t *fill,
+			       size_t len)
+{
+	size_t cnt = 0U;
+
+	do {
+		iovec[cnt].data = fill;
+		iovec[cnt].len = SAS_MIN(len, SAS_WBUFSIZE);
+		len -= iovec[cnt].len;
+		cnt++;
+	} while (len != 0U);
+
+	return cnt;
+}
+
 static void sector_advance(const struct storage_area_store *store,
 			   size_t *sector, size_t cnt)
 {
@@ -39,6 +108,127 @@ static void sector_advance(const struct storage_area_store *store,
 	}
 }
 
+/* end of the sector space that is available for records */
+static size_t store_sector_end(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	const size_t align = store->area->write_size;
+
+	return store->sector_size - SAS_ALIGNUP(SAS_SUMSIZE, align);
+#else
+	return store->sector_size;
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+}
+
+/* size of the cookie (and erase counter) at the start of a sector */
+static size_t store_cookie_size(const struct storage_area_store *store)
+{
+	size_t cksz = SAS_WEARSIZE;
+
+	if (store->sector_cookie != NULL) {
+		cksz += store->sector_cookie_size;
+	}
+
+	return SAS_ALIGNUP(cksz, store->area->write_size);
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+/* sectors in an erase unit (an erase block or a sector) */
+static size_t store_unit_sectors(const struct storage_area_store *store)
+{
+	return MAX(1U, store->area->erase_size / store->sector_size);
+}
+
+/* erase counter index of the erase unit that contains sector */
+static size_t store_wear_unit(const struct storage_area_store *store,
+			      size_t sector)
+{
+	return sector / store_unit_sectors(store);
+}
+
+static bool store_wear_worn(const struct storage_area_store *store,
+			    size_t sector)
+{
+	const struct storage_area_store_data *data = store->data;
+	const uint32_t erases = data->wear[store_wear_unit(store, sector)];
+
+	return (erases == SAS_RETIRED) ||
+	       ((data->wear_limit != 0U) && (erases >= data->wear_limit));
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
+/* count an erase of the erase unit that contains sector */
+static void store_wear_add(const struct storage_area_store *store,
+			   size_t sector)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	uint32_t *erases = &store->data->wear[store_wear_unit(store, sector)];
+
+	if ((*erases) < (SAS_RETIRED - 1U)) {
+		(*erases)++;
+	}
+#else
+	ARG_UNUSED(store);
+	ARG_UNUSED(sector);
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+/* a retired erase unit is not used by a circular buffer */
+static bool store_wear_retired(const struct storage_area_store *store,
+			       size_t sector)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	const struct storage_area_store_data *data = store->data;
+
+	return (data->wear_skip) &&
+	       (data->wear[store_wear_unit(store, sector)] == SAS_RETIRED);
+#else
+	ARG_UNUSED(store);
+	ARG_UNUSED(sector);
+	return false;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+static void store_wear_set_skip(const struct storage_area_store *store,
+				bool skip)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	store->data->wear_skip = skip;
+#else
+	ARG_UNUSED(store);
+	ARG_UNUSED(skip);
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+/* restore the erase counters from the start of the erase units */
+static void store_wear_restore(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST
+	const size_t uscnt = store_unit_sectors(store);
+	const size_t ckoff =
+		(store->sector_cookie != NULL) ? store->sector_cookie_size : 0U;
+	uint32_t *wear = store->data->wear;
+	uint8_t buf[SAS_WEARSIZE];
+
+	for (size_t i = 0U; i < store->sector_cnt; i += uscnt) {
+		const sa_off_t rdoff = i * store->sector_size + ckoff;
+
+		if (storage_area_read(store->area, rdoff, buf, sizeof(buf)) != 0) {
+			continue;
+		}
+
+		const uint32_t erases = sys_get_le32(buf);
+
+		/* a blank unit has no erase counter */
+		if ((erases != SAS_RETIRED) && (erases > wear[i / uscnt])) {
+			wear[i / uscnt] = erases;
+		}
+	}
+#else
+	ARG_UNUSED(store);
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST */
+}
+
 static ALWAYS_INLINE int
 store_init_semaphore(const struct storage_area_store *store)
 {
@@ -69,6 +259,17 @@ store_give_semaphore(const struct storage_area_store *store)
 #endif /* CONFIG_STORAGE_AREA_STORE_SEMAPHORE */
 }
 
+/* check the crc of a mapped record (the data followed by the crc) */
+static bool store_record_crc_mapped(const struct storage_area_record *record,
+				    const uint8_t *rdata)
+{
+	const size_t crc_skip = record->store->crc_skip;
+	const uint32_t crc = crc32_ieee_update(SAS_CRCINIT, &rdata[crc_skip],
+					       record->size - crc_skip);
+
+	return crc == sys_get_le32(&rdata[record->size]);
+}
+
 static bool store_record_valid(const struct storage_area_record *record)
 {
 	const struct storage_area *area = record->store->area;
@@ -76,12 +277,26 @@ static bool store_record_valid(const struct storage_area_record *record)
 	const size_t recpos = record->sector * record->store->sector_size +
 			      record->loc + SAS_HDRSIZE + crc_skip;
 	uint32_t crc = SAS_CRCINIT;
-	uint8_t buf[SAS_MAX(SAS_MINBUFSIZE, area->write_size)];
+	uint8_t buf[SAS_WBUFSIZE];
 	struct storage_area_iovec rd = {
 		.data = &buf,
 	};
 	size_t rdlen = record->size - crc_skip;
 	sa_off_t rdoff = recpos;
+	const void *rdata;
+
+	/* check the crc in place when the area is memory addressable */
+	if (storage_area_map(area, recpos - crc_skip,
+			     record->size + SAS_CRCSIZE, NULL, &rdata) == 0) {
+		const bool valid = store_record_crc_mapped(record, rdata);
+
+		(void)storage_area_unmap(area, rdata);
+		if (!valid) {
+			goto end;
+		}
+
+		return true;
+	}
 
 	while (rdlen != 0U) {
 		rd.len = SAS_MIN(sizeof(buf), rdlen);
@@ -109,30 +324,150 @@ end:
 	return false;
 }
 
-static int store_record_next_in_sector(struct storage_area_record *record,
-				       bool wrapcheck)
+/* read buffer used to serve several small reads from one area read */
+struct store_rdbuf {
+	uint8_t *buf;
+	size_t size;
+	sa_off_t off;
+	size_t len;
+};
+
+static int store_rdbuf_read(const struct storage_area *area,
+			    struct store_rdbuf *rdbuf, sa_off_t off, void *data,
+			    size_t len)
+{
+	const sa_off_t asize = STORAGE_AREA_SIZE(area);
+	int rc;
+
+	if ((rdbuf == NULL) || (len > rdbuf->size) || (off >= asize) ||
+	    (len > (asize - off))) {
+		return storage_area_read(area, off, data, len);
+	}
+
+	if ((rdbuf->len == 0U) || (off < rdbuf->off) ||
+	    ((off + len) > (rdbuf->off + rdbuf->len))) {
+		rdbuf->off = off;
+		rdbuf->len = SAS_MIN(rdbuf->size, asize - off);
+		rc = storage_area_read(area, off, rdbuf->buf, rdbuf->len);
+		if (rc != 0) {
+			rdbuf->len = 0U;
+			return rc;
+		}
+	}
+
+	memcpy(data, &rdbuf->buf[off - rdbuf->off], len);
+	return 0;
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+/* get the summary of a (closed) sector, returns -ENOENT if there is none */
+static int store_summary_get(const struct storage_area_store *store,
+			     size_t sector, struct store_rdbuf *rdbuf,
+			     uint8_t *summary)
+{
+	const sa_off_t rdoff =
+		sector * store->sector_size + store_sector_end(store);
+	const size_t crcpos = SAS_SUMSIZE - SAS_CRCSIZE;
+	int rc;
+
+	rc = store_rdbuf_read(store->area, rdbuf, rdoff, summary, SAS_SUMSIZE);
+	if (rc != 0) {
+		return rc;
+	}
+
+	if ((summary[0] != SAS_SUMMAGIC) ||
+	    (crc32_ieee(summary, crcpos) != sys_get_le32(&summary[crcpos]))) {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+/* get the summary of a sector and check it was written in the current wrap */
+static int store_summary_read(const struct storage_area_store *store,
+			      size_t sector, struct store_rdbuf *rdbuf,
+			      uint8_t *summary)
+{
+	const struct storage_area_store_data *data = store->data;
+	uint8_t wrapcnt;
+	int rc;
+
+	rc = store_summary_get(store, sector, rdbuf, summary);
+	if (rc != 0) {
+		return rc;
+	}
+
+	wrapcnt = summary[1];
+	if (sector > data->sector) {
+		wrapcnt++;
+	}
+
+	if (wrapcnt != data->wrapcnt) {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+
+/*
+ * At the start of a closed sector the summary is used to skip empty sectors
+ * and to jump to the first record. Returns -ENOENT for an empty sector.
+ */
+static int store_summary_start(struct storage_area_record *record,
+			       struct store_rdbuf *rdbuf)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	const struct storage_area_store *store = record->store;
+	uint8_t summary[SAS_SUMSIZE];
+
+	if ((record->loc != 0U) || (record->size != 0U) ||
+	    (record->sector == store->data->sector) ||
+	    (store_summary_read(store, record->sector, rdbuf, summary) != 0)) {
+		return 0;
+	}
+
+	const size_t first = (size_t)sys_get_le32(&summary[4]);
+
+	if (sys_get_le16(&summary[2]) == 0U) {
+		return -ENOENT;
+	}
+
+	if ((first < store_sector_end(store)) &&
+	    ((first & (store->area->write_size - 1)) == 0U)) {
+		record->loc = first;
+	}
+#else
+	ARG_UNUSED(record);
+	ARG_UNUSED(rdbuf);
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+	return 0;
+}
+
+static int store_record_scan(struct storage_area_record *record,
+			     bool wrapcheck, struct store_rdbuf *rdbuf)
 {
 	const struct storage_area_store *store = record->store;
 	const struct storage_area_store_data *data = store->data;
 	const struct storage_area *area = store->area;
 	const size_t secpos = record->sector * store->sector_size;
+	const size_t secend = store_sector_end(store);
 	bool check_crc = false;
 	bool found = false;
 	int rc = 0;
 
-	if ((record->loc == 0U) && (store->sector_cookie != NULL) &&
-	    (store->sector_cookie_size != 0U)) {
-		const size_t cksz = store->sector_cookie_size;
+	if ((store_wear_retired(store, record->sector)) ||
+	    ((wrapcheck) && (store_summary_start(record, rdbuf) != 0))) {
+		record->size = 0U;
+		return -ENOENT;
+	}
 
-		record->loc = SAS_ALIGNUP(cksz, area->write_size);
+	if (record->loc == 0U) {
+		record->loc = store_cookie_size(store);
 	}
 
 	while (!found) {
 		uint8_t header[SAS_HDRSIZE];
-		struct storage_area_iovec rd = {
-			.data = &header,
-			.len = sizeof(header),
-		};
 		size_t rdpos = record->loc;
 		sa_off_t rdoff;
 
@@ -149,12 +484,14 @@ static int store_record_next_in_sector(struct storage_area_record *record,
 		}
 
 		rdoff = secpos + rdpos;
-		rc = storage_area_readv(area, rdoff, &rd, 1U);
+		rc = store_rdbuf_read(area, rdbuf, rdoff, header,
+				      sizeof(header));
 		if (rc != 0) {
 			break;
 		}
 
-		if (header[0] == SAS_FILLVAL) {
+		if ((header[0] == SAS_FILLVAL) ||
+		    ((rdpos == secend) && (header[0] == SAS_SUMMAGIC))) {
 			record->loc = rdpos;
 			record->size = 0U;
 			break;
@@ -163,7 +500,7 @@ static int store_record_next_in_sector(struct storage_area_record *record,
 		size_t rsize = (size_t)sys_get_le16(&header[2]);
 		size_t avail =
 			store->sector_size - rdpos - SAS_CRCSIZE - SAS_HDRSIZE;
-		bool size_ok = ((rsize > 0U) && (rsize < avail));
+		bool size_ok = ((rsize > 0U) && (rsize <= avail));
 
 		if (record->sector > data->sector) {
 			header[1]++;
@@ -173,6 +510,16 @@ static int store_record_next_in_sector(struct storage_area_record *record,
 			header[1] = data->wrapcnt;
 		}
 
+		if ((header[0] == SAS_DROPMAGIC) && (!check_crc) &&
+		    (header[1] == data->wrapcnt) && (rsize <= avail)) {
+			/* a dropped copy at a record boundary is skipped */
+			record->loc = SAS_ALIGNUP(rdpos + SAS_HDRSIZE + rsize +
+							  SAS_CRCSIZE,
+						  area->write_size);
+			record->size = 0U;
+			continue;
+		}
+
 		if ((header[0] == SAS_MAGIC) && (header[1] == data->wrapcnt) &&
 		    (size_ok)) {
 			found = true;
@@ -211,37 +558,53 @@ static int store_record_next_in_sector(struct storage_area_record *record,
 	return rc;
 }
 
+static int store_record_next_in_sector(struct storage_area_record *record,
+				       bool wrapcheck)
+{
+	return store_record_scan(record, wrapcheck, NULL);
+}
+
 static int store_add_cookie(const struct storage_area_store *store)
 {
-	if ((store->data->loc != 0) || (store->sector_cookie == NULL) ||
-	    (store->sector_cookie_size == 0U)) {
+	const size_t ckend = store_cookie_size(store);
+
+	if ((store->data->loc != 0) || (ckend == 0U)) {
 		return 0;
 	}
 
 	const sa_off_t wroff = store->data->sector * store->sector_size;
-	const size_t cksize = store->sector_cookie_size;
-	const size_t align = store->area->write_size;
-	const size_t flen = SAS_ALIGNUP(cksize, align) - cksize;
-	uint8_t fill[align];
-	struct storage_area_iovec wr[2] = {
-		{
-			.data = store->sector_cookie,
-			.len = cksize,
-		},
-		{
-			.data = fill,
-			.len = flen,
-		},
-	};
+	const size_t cksize =
+		(store->sector_cookie != NULL) ? store->sector_cookie_size : 0U;
+	const size_t flen = ckend - cksize - SAS_WEARSIZE;
+	uint8_t fill[SAS_WBUFSIZE];
+	struct storage_area_iovec wr[2U + SAS_FILLCNT];
+	size_t wrcnt = 0U;
 	int rc;
 
+	if (cksize != 0U) {
+		wr[wrcnt].data = store->sector_cookie;
+		wr[wrcnt].len = cksize;
+		wrcnt++;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST
+	const size_t unit = store_wear_unit(store, store->data->sector);
+	uint8_t wear[SAS_WEARSIZE];
+
+	sys_put_le32(store->data->wear[unit], wear);
+	wr[wrcnt].data = wear;
+	wr[wrcnt].len = sizeof(wear);
+	wrcnt++;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST */
+
 	memset(fill, SAS_FILLVAL, sizeof(fill));
-	rc = storage_area_writev(store->area, wroff, wr, 2U);
+	wrcnt += store_fill_iovec(&wr[wrcnt], fill, flen);
+	rc = storage_area_writev(store->area, wroff, wr, wrcnt);
 	if (rc != 0) {
 		goto end;
 	}
 
-	store->data->loc = cksize + flen;
+	store->data->loc = ckend;
 end:
 	if (rc != 0) {
 		LOG_DBG("add cookie failed for sector %x", store->data->sector);
@@ -267,23 +630,25 @@ static int store_fill_sector(const struct storage_area_store *store)
 	struct storage_area_store_data *data = store->data;
 	const struct storage_area *area = store->area;
 	const size_t secpos = data->sector * store->sector_size;
-	uint8_t buf[SAS_MAX(SAS_MINBUFSIZE, area->write_size)];
-	struct storage_area_iovec wr = {
-		.data = buf,
-	};
+	const size_t secend = store_sector_end(store);
+	const size_t bsize = SAS_MAX(SAS_ALIGNDOWN(SAS_WBUFSIZE, area->write_size),
+				     area->write_size);
+	uint8_t buf[SAS_WBUFSIZE];
+	struct storage_area_iovec wr[SAS_FILLCNT];
 	int rc = 0;
 
 	memset(buf, SAS_FILLVAL, sizeof(buf));
-	while (data->loc < store->sector_size) {
-		sa_off_t wroff = secpos + data->loc;
+	while (data->loc < secend) {
+		const sa_off_t wroff = secpos + data->loc;
+		const size_t len = SAS_MIN(bsize, secend - data->loc);
+		const size_t wrcnt = store_fill_iovec(wr, buf, len);
 
-		wr.len = SAS_MIN(sizeof(buf), store->sector_size - data->loc);
-		rc = storage_area_writev(area, wroff, &wr, 1U);
+		rc = storage_area_writev(area, wroff, wr, wrcnt);
 		if (rc != 0) {
 			break;
 		}
 
-		data->loc += wr.len;
+		data->loc += len;
 	}
 
 	if (rc != 0) {
@@ -293,133 +658,604 @@ static int store_fill_sector(const struct storage_area_store *store)
 	return rc;
 }
 
-static int store_erase_block(const struct storage_area_store *store)
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM
+/* add (set == true) or test a key in a bloom filter */
+static bool store_bloom(uint8_t *bloom, uint32_t key, bool set)
 {
-	const struct storage_area *area = store->area;
-	const size_t erase_size = area->erase_size;
-	struct storage_area_store_data *data = store->data;
-	int rc = 0;
-
-	if ((data->sector * store->sector_size) % erase_size != 0U) {
-		goto end;
+	const uint32_t bits = 8U * SAS_BLOOMSIZE;
+	const uint32_t step = ((key >> 16) | (key << 16)) | 1U;
+	bool rv = true;
+
+	for (uint32_t i = 0U; i < SAS_BLOOMHASHES; i++) {
+		const uint32_t bit = (key + i * step) % bits;
+		const uint8_t mask = BIT(bit & 7U);
+
+		if (set) {
+			bloom[bit >> 3] |= mask;
+		} else if ((bloom[bit >> 3] & mask) == 0U) {
+			rv = false;
+		}
 	}
 
-	size_t sblock = (data->sector * store->sector_size) / erase_size;
-	size_t bcnt = MAX(1U, store->sector_size / erase_size);
-
-	rc = storage_area_erase(area, sblock, bcnt);
-
-	if (rc != 0) {
-		LOG_DBG("erase failed at block %d", sblock);
-	}
-end:
-	return rc;
+	return rv;
 }
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM */
 
-static int store_move_record(struct storage_area_record *record,
-			     const struct storage_area_store_compact_cb *cb)
+/*
+ * Close the current sector with a summary. The summary is an optimization, a
+ * failure to write it is not reported: sectors without a (valid) summary are
+ * scanned record by record.
+ */
+static void store_add_summary(const struct storage_area_store *store)
 {
-	if ((cb == NULL) || (cb->move == NULL) || (!cb->move(record))) {
-		return 0;
-	}
-
-	if (!store_record_valid(record)) {
-		LOG_DBG("invalid record, skipping move");
-		return 0;
-	}
-
-	const struct storage_area_store *store = record->store;
-	struct storage_area_store_data *data = store->data;
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	const struct storage_area_store_data *data = store->data;
 	const struct storage_area *area = store->area;
-	const size_t sector_size = store->sector_size;
-	const size_t align = area->write_size;
-	const struct storage_area_record dest = {
-		.store = record->store,
+	const size_t secend = store_sector_end(store);
+	const size_t flen = store->sector_size - secend - SAS_SUMSIZE;
+	const size_t crcpos = SAS_SUMSIZE - SAS_CRCSIZE;
+	struct storage_area_record walk = {
+		.store = (struct storage_area_store *)store,
 		.sector = data->sector,
-		.loc = data->loc,
-		.size = record->size};
-	const size_t rdpos = record->sector * sector_size + record->loc;
-	const size_t wrpos = data->sector * sector_size + data->loc;
-	const size_t alsize =
-		SAS_ALIGNUP(SAS_HDRSIZE + record->size + SAS_CRCSIZE, align);
-	uint8_t buf[SAS_MAX(SAS_MINBUFSIZE, align)];
-	struct storage_area_iovec rdwr = {
-		.data = buf,
+		.loc = 0U,
+		.size = 0U,
 	};
-	size_t start = 0U;
-	int rc = 0;
+	uint8_t summary[SAS_SUMSIZE];
+	uint8_t fill[SAS_WBUFSIZE];
+	struct storage_area_iovec wr[1U + SAS_FILLCNT];
+	size_t cnt = 0U, first = 0U, last = 0U;
+	sa_off_t wroff;
 
-	if ((store->sector_size - alsize) < data->loc) {
-		rc = -ENOSPC;
-		goto end;
+	if (data->loc > secend) {
+		return;
 	}
 
-	while (start < alsize) {
-		sa_off_t rdwroff = rdpos + start;
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM
+	uint8_t *bloom = &summary[SAS_SUMHDRSIZE];
 
-		rdwr.len = SAS_MIN(sizeof(buf), alsize - start);
-		rc = storage_area_readv(area, rdwroff, &rdwr, 1U);
-		if (rc != 0) {
-			goto end;
-		}
+	/* without key callback the filter matches all keys */
+	memset(bloom, (data->key == NULL) ? 0xFF : 0x00, SAS_BLOOMSIZE);
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM */
 
-		if (start == 0U) {
-			buf[1] = data->wrapcnt;
+	while (store_record_next_in_sector(&walk, true) == 0) {
+		if (cnt == 0U) {
+			first = walk.loc;
 		}
 
-		rdwroff = wrpos + start;
-		rc = storage_area_writev(area, rdwroff, &rdwr, 1U);
-		if (rc != 0) {
-			goto end;
+		last = walk.loc;
+		cnt++;
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM
+		if (data->key != NULL) {
+			(void)store_bloom(bloom, data->key(&walk), true);
 		}
-
-		data->loc += rdwr.len;
-		start += rdwr.len;
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM */
 	}
 
-	if (cb->move_cb != NULL) {
-		cb->move_cb(record, &dest);
-	}
+	summary[0] = SAS_SUMMAGIC;
+	summary[1] = data->wrapcnt;
+	sys_put_le16((uint16_t)cnt, &summary[2]);
+	sys_put_le32((uint32_t)first, &summary[4]);
+	sys_put_le32((uint32_t)last, &summary[8]);
+	sys_put_le32(crc32_ieee(summary, crcpos), &summary[crcpos]);
+	memset(fill, STORAGE_AREA_ERASEVALUE(area), sizeof(fill));
+	wr[0].data = summary;
+	wr[0].len = sizeof(summary);
 
-end:
-	if (rc != 0) {
-		LOG_DBG("failed to move record at [%d-%d]", record->sector,
-			record->loc);
-	}
+	const size_t wrcnt = 1U + store_fill_iovec(&wr[1], fill, flen);
 
-	return rc;
+	wroff = data->sector * store->sector_size + secend;
+	if (storage_area_writev(area, wroff, wr, wrcnt) != 0) {
+		LOG_DBG("failed to add summary to sector %d", data->sector);
+	}
+#else
+	ARG_UNUSED(store);
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
 }
 
-/* store advance for circular buffer without persistence (no records copy) */
-static int store_advance_simple(const struct storage_area_store *store,
-				const struct storage_area_store_compact_cb *cb)
+/* erase the erase unit that starts at sector, a blank unit is not erased */
+static int store_erase_unit(const struct storage_area_store *store,
+			    size_t sector)
 {
-	ARG_UNUSED(cb);
-
 	const struct storage_area *area = store->area;
-	struct storage_area_store_data *data = store->data;
-	int rc = 0;
+	const size_t erase_size = area->erase_size;
+	const size_t sblock = (sector * store->sector_size) / erase_size;
+	const size_t bcnt = MAX(1U, store->sector_size / erase_size);
+	int rc;
 
-	if (STORAGE_AREA_FOVRWRITE(area)) {
-		rc = store_fill_sector(store);
-		if (rc != 0) {
-			goto end;
+	rc = storage_area_blank_check(area, sblock * erase_size,
+				      bcnt * erase_size);
+	if (rc != 0) {
+		rc = storage_area_erase(area, sblock, bcnt);
+		if (rc == 0) {
+			store_wear_add(store, sector);
 		}
 	}
 
-	sector_advance(store, &data->sector, 1U);
-	if (data->sector == 0U) {
-		data->wrapcnt++;
+	if (rc != 0) {
+		LOG_DBG("erase failed at block %d", sblock);
 	}
 
-	data->loc = 0U;
+	return rc;
+}
 
-	if ((!STORAGE_AREA_FOVRWRITE(area)) &&
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+static K_THREAD_STACK_DEFINE(store_compactor_stack,
+			     CONFIG_STORAGE_AREA_STORE_COMPACTOR_STACK_SIZE);
+static struct k_work_q store_compactor_wq;
+
+static int store_compactor_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "sas_compactor",
+	};
+
+	k_work_queue_start(&store_compactor_wq, store_compactor_stack,
+			   K_THREAD_STACK_SIZEOF(store_compactor_stack),
+			   CONFIG_STORAGE_AREA_STORE_COMPACTOR_PRIORITY, &cfg);
+	return 0;
+}
+
+SYS_INIT(store_compactor_init, POST_KERNEL,
+	 CONFIG_APPLICATION_INIT_PRIORITY);
+
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
+
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+/* erase the units ahead of the current erase unit, one unit at a time */
+static void store_preerase_work(struct k_work *work)
+{
+	struct storage_area_store_preerase *preerase = CONTAINER_OF(
+		work, struct storage_area_store_preerase, work);
+	const struct storage_area_store *store = preerase->store;
+	const struct storage_area_store_data *data = store->data;
+	const size_t uscnt =
+		MAX(1U, store->area->erase_size / store->sector_size);
+
+	(void)store_take_semaphore(store);
+	while ((preerase->active) && (preerase->erased < preerase->units)) {
+		size_t sector = data->sector - (data->sector % uscnt);
+
+		sector_advance(store, &sector, (preerase->erased + 1U) * uscnt);
+		if ((!store_wear_retired(store, sector)) &&
+		    (store_erase_unit(store, sector) != 0)) {
+			break;
+		}
+
+		preerase->erased++;
+		/* allow other store users in between erases */
+		store_give_semaphore(store);
+		(void)store_take_semaphore(store);
+	}
+
+	store_give_semaphore(store);
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_PREERASE */
+
+/*
+ * Take a new erase unit into use: returns true when it was erased in the
+ * background.
+ */
+static bool store_preerase_take(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+	struct storage_area_store_preerase *preerase = &store->data->preerase;
+	bool rv = false;
+
+	if (preerase->erased > 0U) {
+		preerase->erased--;
+		rv = true;
+	}
+
+	if (preerase->active) {
+		(void)k_work_submit_to_queue(&store_compactor_wq,
+					     &preerase->work);
+	}
+
+	return rv;
+#else
+	ARG_UNUSED(store);
+	return false;
+#endif /* CONFIG_STORAGE_AREA_STORE_PREERASE */
+}
+
+static void store_preerase_stop(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+	struct storage_area_store_preerase *preerase = &store->data->preerase;
+	struct k_work_sync sync;
+
+	if (!preerase->active) {
+		return;
+	}
+
+	(void)store_take_semaphore(store);
+	preerase->active = false;
+	store_give_semaphore(store);
+	(void)k_work_cancel_sync(&preerase->work, &sync);
+	preerase->erased = 0U;
+#else
+	ARG_UNUSED(store);
+#endif /* CONFIG_STORAGE_AREA_STORE_PREERASE */
+}
+
+static int store_erase_block(const struct storage_area_store *store)
+{
+	const size_t erase_size = store->area->erase_size;
+	const struct storage_area_store_data *data = store->data;
+
+	if (((data->sector * store->sector_size) % erase_size != 0U) ||
+	    (store_preerase_take(store))) {
+		return 0;
+	}
+
+	return store_erase_unit(store, data->sector);
+}
+
+/* update the crc and collect the stored crc from a part of a record */
+static void store_move_crc(const struct storage_area_record *record,
+			   size_t start, const uint8_t *buf, size_t len,
+			   uint32_t *crc, uint8_t *rdcrc)
+{
+	const size_t crcstart = SAS_HDRSIZE + record->store->crc_skip;
+	const size_t crcpos = SAS_HDRSIZE + record->size;
+	const size_t end = start + len;
+	size_t cs, ce;
+
+	cs = SAS_MAX(start, crcstart);
+	ce = SAS_MIN(end, crcpos);
+	if (cs < ce) {
+		*crc = crc32_ieee_update(*crc, &buf[cs - start], ce - cs);
+	}
+
+	cs = SAS_MAX(start, crcpos);
+	ce = SAS_MIN(end, crcpos + SAS_CRCSIZE);
+	if (cs < ce) {
+		memcpy(&rdcrc[cs - crcpos], &buf[cs - start], ce - cs);
+	}
+}
+
+/*
+ * Move a record that is mapped in place: the record is validated on the
+ * mapping and is written from the mapping without a copy. The write blocks
+ * that hold the header are written last.
+ */
+static int store_move_record_mapped(struct storage_area_record *record,
+				    const uint8_t *src, bool *valid)
+{
+	const struct storage_area_store *store = record->store;
+	struct storage_area_store_data *data = store->data;
+	const struct storage_area *area = store->area;
+	const size_t wrpos = data->sector * store->sector_size + data->loc;
+	const size_t head = SAS_ALIGNUP(SAS_HDRSIZE, area->write_size);
+	const size_t alsize = SAS_ALIGNUP(
+		SAS_HDRSIZE + record->size + SAS_CRCSIZE, area->write_size);
+	uint8_t header[SAS_HDRSIZE];
+	struct storage_area_iovec wr[2] = {
+		{
+			.data = header,
+			.len = sizeof(header),
+		},
+		{
+			.data = (void *)&src[SAS_HDRSIZE],
+			.len = head - SAS_HDRSIZE,
+		},
+	};
+	int rc = 0, hrc;
+
+	*valid = store_record_crc_mapped(record, &src[SAS_HDRSIZE]);
+	if (!(*valid)) {
+		return 0;
+	}
+
+	if (alsize > head) {
+		rc = storage_area_write(area, wrpos + head, &src[head],
+					alsize - head);
+	}
+
+	/* a failed copy gets a header that marks it as dropped */
+	memcpy(header, src, sizeof(header));
+	header[0] = (rc == 0) ? SAS_MAGIC : SAS_DROPMAGIC;
+	header[1] = data->wrapcnt;
+	hrc = storage_area_writev(area, wrpos, wr, 2U);
+	data->loc += alsize;
+	return (rc != 0) ? rc : hrc;
+}
+
+/*
+ * Move a record by streaming it once through a buffer, the crc is calculated
+ * while copying. The write blocks that hold the header are written last: a
+ * copy that is interrupted has no header, a copy that is invalid or fails
+ * gets a header that marks it as dropped.
+ */
+static int store_move_record_buffered(struct storage_area_record *record,
+				      bool *valid)
+{
+	const struct storage_area_store *store = record->store;
+	struct storage_area_store_data *data = store->data;
+	const struct storage_area *area = store->area;
+	const size_t align = area->write_size;
+	const size_t rdpos = record->sector * store->sector_size + record->loc;
+	const size_t wrpos = data->sector * store->sector_size + data->loc;
+	const size_t head = SAS_ALIGNUP(SAS_HDRSIZE, align);
+	const size_t alsize =
+		SAS_ALIGNUP(SAS_HDRSIZE + record->size + SAS_CRCSIZE, align);
+	uint8_t buf[SAS_MOVEBUFSIZE];
+	const size_t bsize = SAS_ALIGNDOWN(sizeof(buf), align);
+	uint8_t rdcrc[SAS_CRCSIZE];
+	struct storage_area_iovec rdwr = {
+		.data = buf,
+	};
+	uint32_t crc = SAS_CRCINIT;
+	size_t start = 0U;
+	bool written = false;
+	int rc = 0, hrc;
+
+	*valid = true;
+	while (start < alsize) {
+		const size_t skip = (start == 0U) ? head : 0U;
+
+		rdwr.len = SAS_MIN(bsize, alsize - start);
+		rc = storage_area_readv(area, rdpos + start, &rdwr, 1U);
+		if (rc != 0) {
+			break;
+		}
+
+		store_move_crc(record, start, buf, rdwr.len, &crc, rdcrc);
+		if (((start + rdwr.len) == alsize) &&
+		    (crc != sys_get_le32(rdcrc))) {
+			*valid = false;
+			/* the rest of a partial copy is written as garbage */
+			if (start == 0U) {
+				break;
+			}
+		}
+
+		if (rdwr.len > skip) {
+			written = true;
+			rc = storage_area_write(area, wrpos + start + skip,
+						&buf[skip], rdwr.len - skip);
+			if (rc != 0) {
+				break;
+			}
+		}
+
+		start += rdwr.len;
+	}
+
+	if ((!written) && ((rc != 0) || (!(*valid)))) {
+		/* nothing was written */
+		return rc;
+	}
+
+	/* the header is still in the buffer when the record fits in it */
+	if ((rc == 0) && (*valid) && (alsize > bsize)) {
+		rdwr.len = head;
+		rc = storage_area_readv(area, rdpos, &rdwr, 1U);
+	}
+
+	if ((rc == 0) && (*valid)) {
+		buf[1] = data->wrapcnt;
+	} else {
+		/* the dropped copy keeps its size to be skipped */
+		memset(buf, SAS_DROPMAGIC, head);
+		buf[1] = data->wrapcnt;
+		sys_put_le16((uint16_t)record->size, &buf[2]);
+	}
+
+	hrc = storage_area_write(area, wrpos, buf, head);
+	data->loc += alsize;
+	return (rc != 0) ? rc : hrc;
+}
+
+static int store_move_record(struct storage_area_record *record,
+			     const struct storage_area_store_compact_cb *cb)
+{
+	if ((cb == NULL) || (cb->move == NULL) || (!cb->move(record))) {
+		return 0;
+	}
+
+	const struct storage_area_store *store = record->store;
+	struct storage_area_store_data *data = store->data;
+	const struct storage_area *area = store->area;
+	const struct storage_area_record dest = {
+		.store = record->store,
+		.sector = data->sector,
+		.loc = data->loc,
+		.size = record->size};
+	const size_t rdpos = record->sector * store->sector_size + record->loc;
+	const size_t alsize = SAS_ALIGNUP(
+		SAS_HDRSIZE + record->size + SAS_CRCSIZE, area->write_size);
+	const void *src;
+	bool valid;
+	int rc = 0;
+
+	if ((store_sector_end(store) - alsize) < data->loc) {
+		rc = -ENOSPC;
+		goto end;
+	}
+
+	if (storage_area_map(area, rdpos, alsize, NULL, &src) == 0) {
+		rc = store_move_record_mapped(record, src, &valid);
+		(void)storage_area_unmap(area, src);
+	} else {
+		rc = store_move_record_buffered(record, &valid);
+	}
+
+	if (rc != 0) {
+		goto end;
+	}
+
+	if (!valid) {
+		LOG_DBG("invalid record, skipping move");
+		goto end;
+	}
+
+	if (cb->move_cb != NULL) {
+		cb->move_cb(record, &dest);
+	}
+
+end:
+	if (rc != 0) {
+		LOG_DBG("failed to move record at [%d-%d]", record->sector,
+			record->loc);
+	}
+
+	return rc;
+}
+
+/* take the next sector into use, wrapping the store at the end */
+static void store_next_sector(const struct storage_area_store *store)
+{
+	struct storage_area_store_data *data = store->data;
+
+	sector_advance(store, &data->sector, 1U);
+	if (data->sector == 0U) {
+		data->wrapcnt++;
+	}
+}
+
+/* check that an erase unit is left when a new unit is taken into use */
+static int store_wear_check(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	const struct storage_area_store_data *data = store->data;
+	const size_t uscnt = store_unit_sectors(store);
+	size_t sector = data->sector;
+
+	sector_advance(store, &sector, 1U);
+	if ((!data->wear_skip) || ((sector % uscnt) != 0U)) {
+		return 0;
+	}
+
+	for (size_t i = 0U; i < store->sector_cnt; i += uscnt) {
+		if (!store_wear_worn(store, i)) {
+			return 0;
+		}
+	}
+
+	LOG_DBG("No usable erase blocks");
+	return -ENOSPC;
+#else
+	ARG_UNUSED(store);
+	return 0;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+/*
+ * Remove the records of the worn unit at the current sector, the unit only
+ * keeps its cookie (and erase counter) so the erase counter is restored when
+ * the store is mounted. A unit that is already marked is not erased again.
+ */
+static int store_wear_mark(const struct storage_area_store *store,
+			   bool erased)
+{
+	struct storage_area_store_data *data = store->data;
+	const struct storage_area *area = store->area;
+	const size_t ckend = store_cookie_size(store);
+	const size_t usize = store_unit_sectors(store) * store->sector_size;
+	const sa_off_t uoff = data->sector * store->sector_size;
+	int rc = 0;
+
+	if ((!erased) &&
+	    (storage_area_blank_check(area, uoff + ckend, usize - ckend) != 0)) {
+		rc = store_erase_unit(store, data->sector);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	if (storage_area_blank_check(area, uoff, ckend) == 0) {
+		data->loc = 0U;
+		rc = store_add_cookie(store);
+		data->loc = 0U;
+	}
+
+	return rc;
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
+/*
+ * Skip retired and worn erase units (circular buffer only), a usable unit is
+ * available (see store_wear_check()). The records of a worn unit are removed
+ * (see store_wear_mark()): they would otherwise be found when the store is
+ * mounted.
+ */
+static int store_wear_skip(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	struct storage_area_store_data *data = store->data;
+	const size_t uscnt = store_unit_sectors(store);
+	int rc = 0;
+
+	if (!data->wear_skip) {
+		return 0;
+	}
+
+	while (((data->sector % uscnt) == 0U) &&
+	       (store_wear_worn(store, data->sector))) {
+		/* a unit that is erased in the background is taken as well */
+		const bool erased = store_preerase_take(store);
+
+		if (!store_wear_retired(store, data->sector)) {
+			rc = store_wear_mark(store, erased);
+			if (rc != 0) {
+				break;
+			}
+		}
+
+		do {
+			store_next_sector(store);
+		} while (((data->sector % uscnt) != 0U) && (data->sector != 0U));
+	}
+
+	return rc;
+#else
+	ARG_UNUSED(store);
+	return 0;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+/* store advance for circular buffer without persistence (no records copy) */
+static int store_advance_simple(const struct storage_area_store *store,
+				const struct storage_area_store_compact_cb *cb)
+{
+	ARG_UNUSED(cb);
+
+	const struct storage_area *area = store->area;
+	struct storage_area_store_data *data = store->data;
+	int rc;
+
+	rc = store_wear_check(store);
+	if (rc != 0) {
+		goto end;
+	}
+
+	if (STORAGE_AREA_FOVRWRITE(area)) {
+		rc = store_fill_sector(store);
+		if (rc != 0) {
+			goto end;
+		}
+	}
+
+	store_add_summary(store);
+	store_next_sector(store);
+	data->loc = 0U;
+	rc = store_wear_skip(store);
+	if (rc != 0) {
+		goto end;
+	}
+
+	if ((!STORAGE_AREA_FOVRWRITE(area)) &&
 	    (!STORAGE_AREA_AUTOERASE(area))) {
 		rc = store_erase_block(store);
 		if (rc != 0) {
 			goto end;
 		}
+	} else if (((data->sector * store->sector_size) % area->erase_size) ==
+		   0U) {
+		/* the unit is erased or overwritten while it is written */
+		store_wear_add(store, data->sector);
 	}
 
 	rc = store_add_cookie(store);
@@ -427,56 +1263,183 @@ end:
 	return rc;
 }
 
-/* store advance for circular buffer with persistence (with record copy) */
-static int store_advance(const struct storage_area_store *store,
-			 const struct storage_area_store_compact_cb *cb)
+/* move a record, new sectors are taken into use when space is exhausted */
+static int store_move_record_advance(struct storage_area_record *record,
+				     const struct storage_area_store_compact_cb *cb)
 {
-	const struct storage_area_store_data *data = store->data;
-	int rc = store_advance_simple(store, NULL);
+	int rc;
 
-	if ((cb == NULL) || (cb->move == NULL) || (rc != 0)) {
-		goto end;
+	while (true) {
+		rc = store_move_record(record, cb);
+		if (rc != -ENOSPC) {
+			break;
+		}
+
+		rc = store_advance_simple(record->store, NULL);
+		if (rc != 0) {
+			break;
+		}
 	}
 
+	return rc;
+}
+
+/*
+ * Start a compaction when the current sector is the start of a block: the
+ * records of the victim block (spare_sectors ahead) are walked by
+ * store_compact_walk().
+ */
+static void store_compact_init(const struct storage_area_store *store,
+			       const struct storage_area_store_compact_cb *cb,
+			       size_t sector)
+{
+	struct storage_area_store_data *data = store->data;
 	const size_t erase_size = store->area->erase_size;
 	const size_t sector_size = store->sector_size;
 
-	if ((data->sector * sector_size) % erase_size != 0U) {
-		goto end;
+	data->compact_cb = cb;
+	data->compact_sector = sector;
+	sector_advance(store, &data->compact_sector, store->spare_sectors);
+	data->compact_loc = 0U;
+	data->compact_size = 0U;
+	data->compact_scnt = MAX(1U, erase_size / sector_size);
+}
+
+static void store_compact_start(const struct storage_area_store *store,
+				const struct storage_area_store_compact_cb *cb)
+{
+	struct storage_area_store_data *data = store->data;
+	const size_t erase_size = store->area->erase_size;
+	const size_t sector_size = store->sector_size;
+
+	if ((cb == NULL) || (cb->move == NULL) ||
+	    ((data->sector * sector_size) % erase_size != 0U)) {
+		return;
+	}
+
+	if (data->compact_early) {
+		data->compact_early = false;
+		if (data->compact_block == data->sector) {
+			/* the victim block was walked ahead of the advance */
+			return;
+		}
+	}
+
+	store_compact_init(store, cb, data->sector);
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+/*
+ * Start the compaction for the next block while the current sector (the last
+ * sector of its block) is still written: the victim records are moved ahead of
+ * the advance.
+ */
+static void store_compact_early(const struct storage_area_store *store,
+				const struct storage_area_store_compact_cb *cb)
+{
+	struct storage_area_store_data *data = store->data;
+	const size_t erase_size = store->area->erase_size;
+	size_t next = data->sector;
+
+	sector_advance(store, &next, 1U);
+	if ((cb == NULL) || (cb->move == NULL) ||
+	    ((next * store->sector_size) % erase_size != 0U) ||
+	    ((data->compact_early) && (data->compact_block == next))) {
+		return;
 	}
 
-	size_t scnt = MAX(1U, erase_size / sector_size);
+	store_compact_init(store, cb, next);
+	data->compact_early = true;
+	data->compact_block = next;
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
+
+/*
+ * Walk the victim sectors of a pending compaction and move the records that
+ * need keeping. The walk stops after budget bytes of records (at least one
+ * record), the position is kept to resume the walk.
+ */
+static int store_compact_walk(const struct storage_area_store *store,
+			      size_t budget)
+{
+	struct storage_area_store_data *data = store->data;
 	struct storage_area_record walk = {
 		.store = (struct storage_area_store *)store,
-		.sector = data->sector,
+		.sector = data->compact_sector,
+		.loc = data->compact_loc,
+		.size = data->compact_size,
 	};
+	size_t used = 0U;
+	int rc = 0;
 
-	sector_advance(store, &walk.sector, store->spare_sectors);
-	while (scnt > 0U) {
-		walk.loc = 0U;
-		walk.size = 0U;
-		while (store_record_next_in_sector(&walk, true) == 0) {
-			while (true) {
-				rc = store_move_record(&walk, cb);
-				if ((rc == 0) || (rc != -ENOSPC)) {
-					break;
-				}
-
-				rc = store_advance_simple(store, NULL);
-				if (rc != 0) {
-					break;
-				}
-			}
+	while ((data->compact_scnt > 0U) && ((used == 0U) || (used < budget))) {
+		if (store_record_next_in_sector(&walk, true) != 0) {
+			sector_advance(store, &walk.sector, 1U);
+			walk.loc = 0U;
+			walk.size = 0U;
+			data->compact_scnt--;
+			continue;
+		}
 
-			if (rc != 0) {
-				break;
-			}
+		rc = store_move_record_advance(&walk, data->compact_cb);
+		if (rc != 0) {
+			/* retry the record on the next walk */
+			walk.size = 0U;
+			break;
 		}
 
-		sector_advance(store, &walk.sector, 1U);
-		scnt--;
+		used += SAS_HDRSIZE + walk.size + SAS_CRCSIZE;
+	}
+
+	data->compact_sector = walk.sector;
+	data->compact_loc = walk.loc;
+	data->compact_size = walk.size;
+	return rc;
+}
+
+/*
+ * A pending compaction needs at most one empty sector for each victim sector
+ * that is (partly) left to walk, other writes can only use the current sector
+ * when enough empty sectors remain in the block (or in the next block for a
+ * compaction that started early).
+ */
+static bool store_compact_room(const struct storage_area_store *store)
+{
+	const struct storage_area_store_data *data = store->data;
+	const size_t bscnt = MAX(1U, store->area->erase_size / store->sector_size);
+	size_t room = bscnt - 1U - (data->sector % bscnt);
+	size_t next = data->sector;
+
+	if (data->compact_scnt == 0U) {
+		return true;
 	}
 
+	sector_advance(store, &next, 1U);
+	if ((data->compact_early) && (data->compact_block == next)) {
+		room += bscnt;
+	}
+
+	return room >= data->compact_scnt;
+}
+
+/* store advance for circular buffer with persistence (with record copy) */
+static int store_advance(const struct storage_area_store *store,
+			 const struct storage_area_store_compact_cb *cb)
+{
+	/* finish a pending compaction before a new sector is used */
+	int rc = store_compact_walk(store, SIZE_MAX);
+
+	if (rc != 0) {
+		goto end;
+	}
+
+	rc = store_advance_simple(store, NULL);
+	if (rc != 0) {
+		goto end;
+	}
+
+	store_compact_start(store, cb);
+	rc = store_compact_walk(store, SIZE_MAX);
 end:
 	return rc;
 }
@@ -494,99 +1457,119 @@ static void sector_reverse(const struct storage_area_store *store,
 	}
 }
 
-static void store_reverse(const struct storage_area_store *store)
+static int store_record_crc(const struct storage_area_record *record,
+			    uint32_t *crc)
 {
-	sector_reverse(store, &store->data->sector, 1U);
-	store->data->loc = store->sector_size;
-	if (store->data->sector == (store->sector_cnt - 1)) {
-		store->data->wrapcnt--;
+	const struct storage_area_store *store = record->store;
+	const size_t rdpos = record->sector * store->sector_size + record->loc +
+			     SAS_HDRSIZE + record->size;
+	uint8_t buf[SAS_CRCSIZE];
+	int rc;
+
+	rc = storage_area_read(store->area, rdpos, buf, sizeof(buf));
+	if (rc == 0) {
+		*crc = sys_get_le32(buf);
+	}
+
+	return rc;
+}
+
+/*
+ * Search a copy (same size and crc) of a record from dest up to the current
+ * write position, dest is left at the copy.
+ */
+static bool store_record_find_copy(const struct storage_area_record *record,
+				   struct storage_area_record *dest)
+{
+	const struct storage_area_store *store = record->store;
+	const struct storage_area_store_data *data = store->data;
+	uint32_t crc, dcrc;
+
+	if (store_record_crc(record, &crc) != 0) {
+		return false;
+	}
+
+	while (true) {
+		if (store_record_next_in_sector(dest, true) != 0) {
+			if (dest->sector == data->sector) {
+				return false;
+			}
+
+			sector_advance(store, &dest->sector, 1U);
+			dest->loc = 0U;
+			dest->size = 0U;
+			continue;
+		}
+
+		if ((dest->size == record->size) &&
+		    (store_record_crc(dest, &dcrc) == 0) && (dcrc == crc)) {
+			return true;
+		}
 	}
 }
 
+/*
+ * Recover an interrupted compaction (by store_advance() or by compaction
+ * steps) of the victim block of the current block. Records are moved in
+ * order and other records can be written in between, so the victim records
+ * that need keeping are matched to their copies in the current block and the
+ * move is resumed from the first record without a copy.
+ */
 static int store_recover(const struct storage_area_store *store,
 			 const struct storage_area_store_compact_cb *cb)
 {
-	struct storage_area_store_data *data = store->data;
-
 	if ((cb == NULL) || (cb->move == NULL)) {
 		return 0;
 	}
 
 	const size_t erase_size = store->area->erase_size;
 	const size_t sec_size = store->sector_size;
-	const size_t dsector = data->sector;
-	const size_t dloc = data->loc;
-	const size_t dwrapcnt = data->wrapcnt;
+	struct storage_area_record dest = {
+		.store = (struct storage_area_store *)store,
+		.sector = store->data->sector,
+	};
+	struct storage_area_record walk = {
+		.store = (struct storage_area_store *)store,
+	};
+	size_t scnt = MAX(1U, erase_size / sec_size);
+	bool moving = false;
 	int rc = 0;
 
-	for (size_t loop = 0; loop < 2; loop++) {
-		size_t rscnt = 0U;
-
-		while (((data->sector * sec_size) % erase_size) != 0U) {
-			store_reverse(store);
-			rscnt++;
-		}
-
-		store_reverse(store);
-		rscnt++;
-		if (loop != 0U) {
-			/* some data was not moved, restart the move */
-			rc = store_advance(store, cb);
-			break;
-		}
-
-		struct storage_area_record walk = {
-			.store = (struct storage_area_store *)store,
-		};
-		size_t mrcnt = 0U; /* cnt records that should be moved */
-		size_t vrcnt = 0U; /* cnt records that are moved and valid */
+	while (((dest.sector * sec_size) % erase_size) != 0U) {
+		sector_reverse(store, &dest.sector, 1U);
+	}
 
-		walk.sector = data->sector;
-		sector_advance(store, &walk.sector, store->spare_sectors + 1U);
-		for (size_t cnt = 0U; cnt < erase_size / sec_size; cnt++) {
-			walk.loc = 0U;
-			walk.size = 0U;
-			while (store_record_next_in_sector(&walk, true) == 0) {
-				if ((cb->move(&walk)) &&
-				    (store_record_valid(&walk))) {
-					mrcnt++;
-				}
+	walk.sector = dest.sector;
+	sector_advance(store, &walk.sector, store->spare_sectors);
+	/* a compaction that started early moved records to the sector before */
+	sector_reverse(store, &dest.sector, 1U);
+	while (scnt > 0U) {
+		walk.loc = 0U;
+		walk.size = 0U;
+		while (store_record_next_in_sector(&walk, true) == 0) {
+			if ((!cb->move(&walk)) || (!store_record_valid(&walk))) {
+				continue;
 			}
 
-			sector_advance(store, &walk.sector, 1U);
-		}
-
-		data->sector = dsector;
-		data->loc = dloc;
-		data->wrapcnt = dwrapcnt;
-
-		if (mrcnt == 0U) {
-			break;
-		}
-
-		walk.sector = data->sector;
-		while (((walk.sector * sec_size) % erase_size) != 0U) {
-			sector_reverse(store, &walk.sector, 1U);
-		}
+			if (!moving) {
+				moving = !store_record_find_copy(&walk, &dest);
+			}
 
-		for (size_t cnt = 0U; cnt < rscnt; cnt++) {
-			walk.loc = 0U;
-			walk.size = 0U;
-			while (store_record_next_in_sector(&walk, true) == 0) {
-				if (store_record_valid(&walk)) {
-					vrcnt++;
-				}
+			if (!moving) {
+				continue;
 			}
 
-			sector_advance(store, &walk.sector, 1U);
+			rc = store_move_record_advance(&walk, cb);
+			if (rc != 0) {
+				goto end;
+			}
 		}
 
-		if (vrcnt >= mrcnt) {
-			/* all records were moved */
-			break;
-		}
+		sector_advance(store, &walk.sector, 1U);
+		scnt--;
 	}
 
+end:
 	return rc;
 }
 
@@ -603,7 +1586,8 @@ static size_t store_iovec_size(const struct storage_area_iovec *iovec,
 }
 
 static int store_writev(const struct storage_area_store *store,
-			const struct storage_area_iovec *iovec, size_t iovcnt)
+			const struct storage_area_iovec *iovec, size_t iovcnt,
+			struct storage_area_record *record)
 {
 	struct storage_area_store_data *data = store->data;
 
@@ -611,30 +1595,47 @@ static int store_writev(const struct storage_area_store *store,
 		return -ENOTSUP;
 	}
 
+	if (iovcnt > SAS_MAXIOVCNT) {
+		LOG_DBG("iovcnt exceeds %d", SAS_MAXIOVCNT);
+		return -EINVAL;
+	}
+
+	int rc = 0;
+
+	if (!store_compact_room(store)) {
+		/* the pending compaction needs the empty sectors, finish it */
+		rc = store_compact_walk(store, SIZE_MAX);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
 	const size_t len =
 		SAS_HDRSIZE + store_iovec_size(iovec, iovcnt) + SAS_CRCSIZE;
+	const size_t secend = store_sector_end(store);
 
-	if ((store->sector_size - len) < data->loc) {
+	if ((secend - len) < data->loc) {
 		return -ENOSPC;
 	}
 
 	const struct storage_area *area = store->area;
 	const size_t secpos = data->sector * store->sector_size;
 	const uint8_t erasevalue = STORAGE_AREA_ERASEVALUE(area);
-	struct storage_area_iovec wr[iovcnt + 2];
+	const size_t flen = SAS_ALIGNUP(len, area->write_size) - len;
+	struct storage_area_iovec wr[SAS_MAXIOVCNT + 2U + SAS_FILLCNT];
 	uint8_t header[SAS_HDRSIZE];
-	uint8_t cbuf[SAS_CRCSIZE + SAS_ALIGNUP(len, area->write_size) - len];
+	uint8_t crcbuf[SAS_CRCSIZE];
+	uint8_t fill[SAS_WBUFSIZE];
 	uint32_t crc = SAS_CRCINIT;
 	size_t crc_skip = store->crc_skip;
-	int rc;
 
 	header[0] = SAS_MAGIC;
 	header[1] = data->wrapcnt;
 	sys_put_le16((uint16_t)store_iovec_size(iovec, iovcnt), &header[2]);
 	wr[0].data = header;
 	wr[0].len = sizeof(header);
-	wr[iovcnt + 1].data = cbuf;
-	wr[iovcnt + 1].len = sizeof(cbuf);
+	wr[iovcnt + 1].data = crcbuf;
+	wr[iovcnt + 1].len = sizeof(crcbuf);
 
 	for (size_t i = 1; i < (iovcnt + 1); i++) {
 		wr[i].data = iovec[i - 1].data;
@@ -652,27 +1653,188 @@ static int store_writev(const struct storage_area_store *store,
 		crc_skip = 0U;
 	}
 
-	sys_put_le32(crc, cbuf);
-	memset(&cbuf[SAS_CRCSIZE], erasevalue, sizeof(cbuf) - SAS_CRCSIZE);
+	sys_put_le32(crc, crcbuf);
+	memset(fill, erasevalue, sizeof(fill));
+
+	const size_t wrcnt =
+		iovcnt + 2U + store_fill_iovec(&wr[iovcnt + 2], fill, flen);
+
 	while (true) {
 		sa_off_t wroff = secpos + data->loc;
 
-		rc = storage_area_writev(area, wroff, wr, iovcnt + 2);
+		rc = storage_area_writev(area, wroff, wr, wrcnt);
+		if (rc == 0) {
+			if (record != NULL) {
+				record->store = (struct storage_area_store *)store;
+				record->sector = data->sector;
+				record->loc = data->loc;
+				record->size = len - SAS_HDRSIZE - SAS_CRCSIZE;
+			}
+
+			data->loc += SAS_ALIGNUP(len, area->write_size);
+			break;
+		}
+
+		data->loc += area->write_size;
+		if ((secend - len) < data->loc) {
+			rc = -ENOSPC;
+			break;
+		}
+	}
+
+	return rc;
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+static bool store_compactor_needed(const struct storage_area_store *store)
+{
+	const struct storage_area_store_data *data = store->data;
+	const size_t secend = store_sector_end(store);
+
+	return ((data->loc > secend) ||
+		((secend - data->loc) < data->compactor.watermark));
+}
+
+/*
+ * The compactor starts the compaction for the next block at the watermark and
+ * walks pending compactions in steps of a sector, writes can use the store in
+ * between steps.
+ */
+static void store_compactor_work(struct k_work *work)
+{
+	struct storage_area_store_compactor *compactor = CONTAINER_OF(
+		work, struct storage_area_store_compactor, work);
+	const struct storage_area_store *store = compactor->store;
+	struct storage_area_store_data *data = store->data;
+	int rc = 0;
+
+	(void)store_take_semaphore(store);
+	if ((compactor->active) && (data->advance == store_advance) &&
+	    (data->compact_scnt == 0U) && (store_compactor_needed(store))) {
+		store_compact_early(store, compactor->cb);
+	}
+
+	while ((compactor->active) && (data->compact_scnt != 0U)) {
+		rc = store_compact_walk(store, store->sector_size);
+		if (rc != 0) {
+			LOG_DBG("background compaction failed");
+			break;
+		}
+
+		if (data->compact_scnt == 0U) {
+			compactor->stats.runs++;
+		}
+
+		store_give_semaphore(store);
+		(void)store_take_semaphore(store);
+	}
+
+	store_give_semaphore(store);
+}
+
+/*
+ * Take a new sector into use for a write: a pending compaction that did not
+ * start early is finished first, the compaction for a new block is left to
+ * the compactor.
+ */
+static int store_compactor_advance(const struct storage_area_store *store,
+				   const struct storage_area_store_compact_cb *cb)
+{
+	struct storage_area_store_data *data = store->data;
+	int rc = 0;
+
+	if (data->advance != store_advance) {
+		return data->advance(store, cb);
+	}
+
+	if (!data->compact_early) {
+		rc = store_compact_walk(store, SIZE_MAX);
+	}
+
+	if (rc == 0) {
+		rc = store_advance_simple(store, NULL);
+	}
+
+	if (rc == 0) {
+		store_compact_start(store, cb);
+	}
+
+	return rc;
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
+
+/*
+ * Write with background compactor: the compactor is started when a write
+ * leaves less than the watermark free, writes keep filling the sector. A
+ * write that runs out of space waits for a running compactor, takes a new
+ * sector into use and is retried.
+ */
+static int store_compactor_writev(const struct storage_area_store *store,
+				  const struct storage_area_iovec *iovec,
+				  size_t iovcnt,
+				  struct storage_area_record *record)
+{
+	int rc = store_writev(store, iovec, iovcnt, record);
+
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+	struct storage_area_store_data *data = store->data;
+	struct storage_area_store_compactor *compactor = &data->compactor;
+	struct k_work_sync sync;
+
+	if (!compactor->active) {
+		return rc;
+	}
+
+	if ((rc == -ENOSPC) &&
+	    ((k_work_busy_get(&compactor->work) &
+	      (K_WORK_QUEUED | K_WORK_RUNNING)) != 0)) {
+		compactor->stats.waits++;
+		store_give_semaphore(store);
+		(void)k_work_flush(&compactor->work, &sync);
+		(void)store_take_semaphore(store);
+		rc = store_writev(store, iovec, iovcnt, record);
+	}
+
+	if (rc == -ENOSPC) {
+		rc = store_compactor_advance(store, compactor->cb);
 		if (rc == 0) {
-			data->loc += SAS_ALIGNUP(len, area->write_size);
-			break;
+			rc = store_writev(store, iovec, iovcnt, record);
 		}
 
-		data->loc += area->write_size;
-		if ((store->sector_size - len) < data->loc) {
-			rc = -ENOSPC;
-			break;
+		if (rc == -ENOSPC) {
+			compactor->stats.nospc++;
 		}
 	}
 
+	if ((rc == 0) &&
+	    ((data->compact_scnt != 0U) || (store_compactor_needed(store)))) {
+		(void)k_work_submit_to_queue(&store_compactor_wq,
+					     &compactor->work);
+	}
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
 	return rc;
 }
 
+static void store_compactor_stop(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+	struct storage_area_store_compactor *compactor =
+		&store->data->compactor;
+	struct k_work_sync sync;
+
+	if (!compactor->active) {
+		return;
+	}
+
+	(void)store_take_semaphore(store);
+	compactor->active = false;
+	store_give_semaphore(store);
+	(void)k_work_cancel_sync(&compactor->work, &sync);
+#else
+	ARG_UNUSED(store);
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
+}
+
 static bool store_valid(const struct storage_area_store *store)
 {
 	if ((store == NULL) || (store->data == NULL) || (store->area == NULL)) {
@@ -703,6 +1865,12 @@ static bool store_config_valid(const struct storage_area_store *store)
 		return false;
 	}
 
+	/* record moves and updates rewrite a write block in one buffer */
+	if (area->write_size > SAS_MOVEBUFSIZE) {
+		LOG_DBG("Write block size exceeds move buffer size");
+		return false;
+	}
+
 	if (((area->erase_size & (store->sector_size - 1)) != 0U) &&
 	    ((store->sector_size & (area->erase_size - 1)) != 0U)) {
 		LOG_DBG("Sector incorrectly sized");
@@ -714,10 +1882,195 @@ static bool store_config_valid(const struct storage_area_store *store)
 		return false;
 	}
 
+	if (store_sector_end(store) > store->sector_size) {
+		LOG_DBG("Sector too small for summary");
+		return false;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	const size_t units =
+		DIV_ROUND_UP(store->sector_cnt, store_unit_sectors(store));
+
+	if (units > store->data->wear_cnt) {
+		LOG_DBG("Too few erase counters");
+		return false;
+	}
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
 	return true;
 }
 
-static int store_init(const struct storage_area_store *store)
+/*
+ * get the wrap counter of the first record in a sector, or of the summary of
+ * a closed sector without records.
+ */
+static int store_sector_wrapcnt(const struct storage_area_store *store,
+				size_t sector, struct store_rdbuf *rdbuf,
+				uint8_t *wrapcnt)
+{
+	struct storage_area_record record = {
+		.store = (struct storage_area_store *)store,
+		.sector = sector,
+		.loc = 0U,
+		.size = 0U,
+	};
+	int rc;
+
+	rc = store_record_scan(&record, false, rdbuf);
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	uint8_t summary[SAS_SUMSIZE];
+
+	if ((rc == -ENOENT) &&
+	    (store_summary_get(store, sector, rdbuf, summary) == 0)) {
+		*wrapcnt = summary[1];
+		return 0;
+	}
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+	if (rc != 0) {
+		return rc;
+	}
+
+	const sa_off_t rdoff = sector * store->sector_size + record.loc + 1U;
+
+	return store_rdbuf_read(store->area, rdbuf, rdoff, wrapcnt, 1U);
+}
+
+/*
+ * Find the start of the blank part of the current sector between from and end
+ * (the part after end is blank or not used) by a binary search.
+ */
+static int store_blank_search(const struct storage_area_store *store,
+			      size_t from, size_t end, size_t *start)
+{
+	const struct storage_area *area = store->area;
+	const size_t ws = area->write_size;
+	const sa_off_t secpos = store->data->sector * store->sector_size;
+	size_t first = from / ws;
+	size_t last = end / ws;
+	int rc = 0;
+
+	while (first < last) {
+		const size_t half = first + (last - first) / 2U;
+
+		rc = storage_area_blank_check(area, secpos + half * ws,
+					      end - half * ws);
+		if (rc == 0) {
+			last = half;
+		} else if (rc == -ENOTEMPTY) {
+			first = half + 1U;
+			rc = 0;
+		} else {
+			break;
+		}
+	}
+
+	if (rc == 0) {
+		*start = first * ws;
+	}
+
+	return rc;
+}
+
+/*
+ * Find the start of the blank part at the end of the current sector, only for
+ * sectors that are erased before use (otherwise old data can follow the
+ * written data). On areas that erase on write the data after the write
+ * position is stale (the erase value is not guaranteed), the header walk is
+ * used instead.
+ */
+static int store_sector_blank_start(const struct storage_area_store *store,
+				    size_t *start)
+{
+	const struct storage_area *area = store->area;
+
+	if ((STORAGE_AREA_FOVRWRITE(area)) || (STORAGE_AREA_AUTOERASE(area))) {
+		return -ENOTSUP;
+	}
+
+	return store_blank_search(store, 0U, store->sector_size, start);
+}
+
+/*
+ * A record move that is interrupted leaves a copy without header (the header
+ * is written last). When the store is mounted for writing the copy (up to the
+ * blank part at end) gets a header that marks it as dropped, the scanner then
+ * skips the copy by its size instead of stopping at it.
+ */
+static void store_drop_headless(const struct storage_area_store *store,
+				size_t loc, size_t end)
+{
+	struct storage_area_store_data *data = store->data;
+	const struct storage_area *area = store->area;
+	const size_t head = SAS_ALIGNUP(SAS_HDRSIZE, area->write_size);
+	const size_t dlen =
+		SAS_MAX(end - loc, SAS_ALIGNUP(SAS_HDRSIZE + SAS_CRCSIZE,
+					       area->write_size));
+	const size_t dsize = dlen - SAS_HDRSIZE - SAS_CRCSIZE;
+	const sa_off_t wroff = data->sector * store->sector_size + loc;
+	uint8_t header[SAS_HDRSIZE];
+	uint8_t buf[SAS_WBUFSIZE];
+	struct storage_area_iovec wr[1U + SAS_FILLCNT];
+	size_t wrcnt = 1U;
+
+	if (((loc + dlen) > store_sector_end(store)) || (dsize > UINT16_MAX) ||
+	    (storage_area_blank_check(area, wroff, head) != 0)) {
+		return;
+	}
+
+	LOG_DBG("dropping interrupted copy at [%d-%d]", data->sector, loc);
+	header[0] = SAS_DROPMAGIC;
+	header[1] = data->wrapcnt;
+	sys_put_le16((uint16_t)dsize, &header[2]);
+	wr[0].data = header;
+	wr[0].len = sizeof(header);
+	memset(buf, SAS_DROPMAGIC, sizeof(buf));
+	if (head > SAS_HDRSIZE) {
+		wrcnt += store_fill_iovec(&wr[1], buf, head - SAS_HDRSIZE);
+	}
+
+	if (storage_area_writev(area, wroff, wr, wrcnt) == 0) {
+		data->loc = SAS_MAX(data->loc, loc + dlen);
+	}
+}
+
+/*
+ * On areas that erase on write only the erase block of the write position is
+ * known to be erased, the next blocks hold stale data until they are written.
+ * Data after the last record in this block is an interrupted write: the write
+ * position moves to the blank part of the block (or to the end of the block,
+ * where the next write erases) and the interrupted write is dropped.
+ */
+static void store_autoerase_head(const struct storage_area_store *store,
+				 bool rw)
+{
+	struct storage_area_store_data *data = store->data;
+	const struct storage_area *area = store->area;
+	const size_t secpos = data->sector * store->sector_size;
+	const size_t loc = data->loc;
+	const size_t end =
+		SAS_MIN(SAS_ALIGNUP(secpos + loc, area->erase_size) - secpos,
+			store->sector_size);
+	size_t blank;
+
+	if ((loc == 0U) || (loc >= end) ||
+	    (store_blank_search(store, loc, end, &blank) != 0) ||
+	    (blank == loc)) {
+		return;
+	}
+
+	data->loc = blank;
+	if (rw) {
+		store_drop_headless(store, loc, blank);
+	}
+}
+
+/*
+ * The sectors that contain records written in the last wrap are found at the
+ * start of the store, sectors written in the previous wrap follow. This allows
+ * a binary search for the last sector written. Sectors without records are
+ * skipped by probing the next sector.
+ */
+static int store_init(const struct storage_area_store *store, bool rw)
 {
 	const struct storage_area *area = store->area;
 	struct storage_area_store_data *data = store->data;
@@ -725,57 +2078,94 @@ static int store_init(const struct storage_area_store *store)
 		.store = (struct storage_area_store *)store,
 		.size = 0U,
 	};
-	uint8_t rd_wrapcnt;
-	struct storage_area_iovec rd = {
-		.data = &rd_wrapcnt,
-		.len = 1U,
+	uint8_t buf[SAS_MAX(CONFIG_STORAGE_AREA_STORE_MOUNT_BUFSIZE,
+			    SAS_HDRSIZE)];
+	struct store_rdbuf rdbuf = {
+		.buf = buf,
+		.size = sizeof(buf),
+		.len = 0U,
 	};
+	size_t first = 0U;
+	size_t last = store->sector_cnt;
 
+	store_wear_restore(store);
 	data->sector = store->sector_cnt;
 	data->loc = store->sector_size;
 
-	for (size_t i = 0U; i < store->sector_cnt; i++) {
-		record.sector = i;
-		record.loc = 0U;
+	while ((first < last) &&
+	       (store_sector_wrapcnt(store, first, &rdbuf, &data->wrapcnt) != 0)) {
+		first++;
+	}
 
-		if (store_record_next_in_sector(&record, false) != 0) {
-			continue;
-		}
+	if (first == last) {
+		data->sector--;
+		goto end;
+	}
 
-		const sa_off_t rdoff = i * store->sector_size + record.loc + 1U;
+	while ((last - first) > 1U) {
+		const size_t half = first + (last - first) / 2U;
+		size_t probe = half;
+		uint8_t wrapcnt;
 
-		if (storage_area_readv(area, rdoff, &rd, 1U) != 0) {
-			continue;
+		while ((probe < last) &&
+		       (store_sector_wrapcnt(store, probe, &rdbuf, &wrapcnt) != 0)) {
+			probe++;
 		}
 
-		if (data->sector > i) {
-			data->wrapcnt = rd_wrapcnt;
+		if (probe == last) {
+			last = half;
+			continue;
 		}
 
-		if (rd_wrapcnt != data->wrapcnt) {
-			break;
+		if (wrapcnt == data->wrapcnt) {
+			first = probe;
+		} else {
+			last = probe;
 		}
-
-		data->sector = i;
 	}
 
-	if (data->sector == store->sector_cnt) {
-		data->sector--;
+	data->sector = first;
+
+	size_t loc = 0U;
+
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	uint8_t summary[SAS_SUMSIZE];
+
+	/* a sector with a summary is closed: no records can be added */
+	if (store_summary_read(store, data->sector, &rdbuf, summary) == 0) {
+		data->loc = store->sector_size;
+		data->ready = true;
 		goto end;
 	}
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
 
-	size_t loc = 0U;
+	/* the scan stops at the blank part of the sector (when known) */
+	size_t blank = store->sector_size;
+	const bool bounded = (store_sector_blank_start(store, &blank) == 0);
 
+	data->loc = blank;
 	record.sector = data->sector;
 	record.loc = 0U;
 	record.size = 0U;
-	while (store_record_next_in_sector(&record, true) == 0) {
+	while (store_record_scan(&record, true, &rdbuf) == 0) {
 		loc = record.loc +
 		      SAS_ALIGNUP(SAS_HDRSIZE + record.size + SAS_CRCSIZE,
 				  area->write_size);
 	}
 
 	data->loc = loc;
+	if (bounded) {
+		/* skip data that is not a record (e.g. an interrupted write) */
+		data->loc = SAS_MAX(loc, blank);
+		loc = SAS_MAX(loc, store_cookie_size(store));
+		if ((rw) && (loc < blank)) {
+			store_drop_headless(store, loc, blank);
+		}
+	} else if ((STORAGE_AREA_AUTOERASE(area)) &&
+		   (!STORAGE_AREA_FOVRWRITE(area))) {
+		store_autoerase_head(store, rw);
+	}
+
 	data->ready = true;
 end:
 	return 0;
@@ -798,7 +2188,8 @@ int storage_area_store_mount_ro(const struct storage_area_store *store)
 	}
 
 	(void)store_take_semaphore(store);
-	rc = store_init(store);
+	store_wear_set_skip(store, true);
+	rc = store_init(store, false);
 	if (rc != 0) {
 		goto end;
 	}
@@ -827,91 +2218,243 @@ int storage_area_store_mount_cb(const struct storage_area_store *store)
 	}
 
 	(void)store_take_semaphore(store);
-	rc = store_init(store);
+	store_wear_set_skip(store, true);
+	rc = store_init(store, true);
+	if (rc != 0) {
+		goto end;
+	}
+
+	if (!store->data->ready) {
+		rc = store_advance_simple(store, NULL);
+	}
+
+	if (rc != 0) {
+		goto end;
+	}
+
+	store->data->advance = store_advance_simple;
+	store->data->ready = true;
+end:
+	store_give_semaphore(store);
+	return rc;
+}
+
+int storage_area_store_mount(const struct storage_area_store *store,
+			     const struct storage_area_store_compact_cb *cb)
+{
+	if ((!store_valid(store)) || (!store_config_valid(store))) {
+		return -EINVAL;
+	}
+
+	const size_t spsize = store->spare_sectors * store->sector_size;
+
+	if ((cb != NULL) && (cb->move != NULL) &&
+	    (spsize < store->area->erase_size)) {
+		LOG_DBG("Not enough spare sectors");
+		return -EINVAL;
+	}
+
+	if (store->data->ready) {
+		return -EALREADY;
+	}
+
+	int rc = store_init_semaphore(store);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	(void)store_take_semaphore(store);
+	store_wear_set_skip(store, false);
+	rc = store_init(store, true);
+	if (rc != 0) {
+		goto end;
+	}
+
+	if (!store->data->ready) {
+		rc = store_advance_simple(store, NULL);
+	} else {
+		rc = store_recover(store, cb);
+	}
+
 	if (rc != 0) {
 		goto end;
 	}
 
-	if (!store->data->ready) {
-		rc = store_advance_simple(store, NULL);
+	store->data->advance = store_advance;
+	store->data->ready = true;
+end:
+	store_give_semaphore(store);
+	return rc;
+}
+
+int storage_area_store_unmount(const struct storage_area_store *store)
+{
+	if (!store_valid(store)) {
+		return -EINVAL;
+	}
+
+	store_compactor_stop(store);
+	store_preerase_stop(store);
+	if (store->data->ready) {
+		store->data->advance = NULL;
+		store->data->compact_scnt = 0U;
+		store->data->compact_early = false;
+		store->data->ready = false;
+	}
+
+	return 0;
+}
+
+int storage_area_store_advance(const struct storage_area_store *store)
+{
+	if (!store_ready(store)) {
+		return -EINVAL;
+	}
+
+	if (store->data->advance == NULL) {
+		return -ENOTSUP;
+	}
+
+	int rc;
+
+	(void)store_take_semaphore(store);
+	rc = store->data->advance(store, NULL);
+	store_give_semaphore(store);
+	return rc;
+}
+
+int storage_area_store_compact(const struct storage_area_store *store,
+			       const struct storage_area_store_compact_cb *cb)
+{
+	if (!store_ready(store)) {
+		return -EINVAL;
+	}
+
+	if (store->data->advance == NULL) {
+		return -ENOTSUP;
+	}
+
+	int rc;
+
+	(void)store_take_semaphore(store);
+	rc = store->data->advance(store, cb);
+	store_give_semaphore(store);
+	return rc;
+}
+
+int storage_area_store_compact_step(
+	const struct storage_area_store *store,
+	const struct storage_area_store_compact_cb *cb, size_t budget)
+{
+	if (!store_ready(store)) {
+		return -EINVAL;
+	}
+
+	struct storage_area_store_data *data = store->data;
+
+	if (data->advance == NULL) {
+		return -ENOTSUP;
+	}
+
+	int rc = 0;
+
+	(void)store_take_semaphore(store);
+	if (data->compact_scnt == 0U) {
+		rc = store_advance_simple(store, NULL);
+		if ((rc != 0) || (data->advance != store_advance)) {
+			goto end;
+		}
+
+		store_compact_start(store, cb);
 	}
 
-	if (rc != 0) {
-		goto end;
+	rc = store_compact_walk(store, budget);
+	if ((rc == 0) && (data->compact_scnt != 0U)) {
+		rc = -EAGAIN;
 	}
 
-	store->data->advance = store_advance_simple;
-	store->data->ready = true;
 end:
 	store_give_semaphore(store);
 	return rc;
 }
 
-int storage_area_store_mount(const struct storage_area_store *store,
-			     const struct storage_area_store_compact_cb *cb)
+int storage_area_store_compactor_start(
+	const struct storage_area_store *store,
+	const struct storage_area_store_compact_cb *cb, size_t watermark)
 {
-	if ((!store_valid(store)) || (!store_config_valid(store))) {
-		return -EINVAL;
-	}
-
-	const size_t spsize = store->spare_sectors * store->sector_size;
-
-	if ((cb != NULL) && (cb->move != NULL) &&
-	    (spsize < store->area->erase_size)) {
-		LOG_DBG("Not enough spare sectors");
+	if (!store_ready(store)) {
 		return -EINVAL;
 	}
 
-	if (store->data->ready) {
-		return -EALREADY;
+	if (store->data->advance == NULL) {
+		return -ENOTSUP;
 	}
 
-	int rc = store_init_semaphore(store);
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+	struct storage_area_store_compactor *compactor =
+		&store->data->compactor;
 
-	if (rc != 0) {
-		return rc;
+	if (compactor->active) {
+		return -EALREADY;
 	}
 
 	(void)store_take_semaphore(store);
-	rc = store_init(store);
-	if (rc != 0) {
-		goto end;
-	}
-
-	if (!store->data->ready) {
-		rc = store_advance_simple(store, NULL);
-	} else {
-		rc = store_recover(store, cb);
-	}
-
-	if (rc != 0) {
-		goto end;
+	k_work_init(&compactor->work, store_compactor_work);
+	compactor->store = store;
+	compactor->cb = cb;
+	compactor->watermark = watermark;
+	compactor->active = true;
+	if (store_compactor_needed(store)) {
+		(void)k_work_submit_to_queue(&store_compactor_wq,
+					     &compactor->work);
 	}
 
-	store->data->advance = store_advance;
-	store->data->ready = true;
-end:
 	store_give_semaphore(store);
-	return rc;
+	return 0;
+#else
+	ARG_UNUSED(cb);
+	ARG_UNUSED(watermark);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
 }
 
-int storage_area_store_unmount(const struct storage_area_store *store)
+int storage_area_store_compactor_stop(const struct storage_area_store *store)
 {
 	if (!store_valid(store)) {
 		return -EINVAL;
 	}
 
-	if (store->data->ready) {
-		store->data->advance = NULL;
-		store->data->ready = false;
+	if (!IS_ENABLED(CONFIG_STORAGE_AREA_STORE_COMPACTOR)) {
+		return -ENOTSUP;
 	}
 
+	store_compactor_stop(store);
 	return 0;
 }
 
-int storage_area_store_advance(const struct storage_area_store *store)
+int storage_area_store_compactor_get_stats(
+	const struct storage_area_store *store,
+	struct storage_area_store_compactor_stats *stats)
 {
-	if (!store_ready(store)) {
+	if ((!store_valid(store)) || (stats == NULL)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_COMPACTOR
+	(void)store_take_semaphore(store);
+	memcpy(stats, &store->data->compactor.stats, sizeof(*stats));
+	store_give_semaphore(store);
+	return 0;
+#else
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_COMPACTOR */
+}
+
+int storage_area_store_preerase_start(const struct storage_area_store *store,
+				      size_t sectors)
+{
+	if ((!store_ready(store)) || (sectors == 0U)) {
 		return -EINVAL;
 	}
 
@@ -919,31 +2462,54 @@ int storage_area_store_advance(const struct storage_area_store *store)
 		return -ENOTSUP;
 	}
 
-	int rc;
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+	const struct storage_area *area = store->area;
+	struct storage_area_store_preerase *preerase = &store->data->preerase;
+	const size_t uscnt = MAX(1U, area->erase_size / store->sector_size);
+	const size_t units = DIV_ROUND_UP(sectors, uscnt);
+
+	if ((STORAGE_AREA_FOVRWRITE(area)) || (STORAGE_AREA_AUTOERASE(area))) {
+		return -ENOTSUP;
+	}
+
+	/* the erased units are taken from the spare sectors, one erase unit
+	 * of spare sectors is left for the compaction.
+	 */
+	if (((units + 1U) * uscnt) > store->spare_sectors) {
+		LOG_DBG("Not enough spare sectors");
+		return -EINVAL;
+	}
+
+	if (preerase->active) {
+		return -EALREADY;
+	}
 
 	(void)store_take_semaphore(store);
-	rc = store->data->advance(store, NULL);
+	k_work_init(&preerase->work, store_preerase_work);
+	preerase->store = store;
+	preerase->units = units;
+	preerase->erased = 0U;
+	preerase->active = true;
+	(void)k_work_submit_to_queue(&store_compactor_wq, &preerase->work);
 	store_give_semaphore(store);
-	return rc;
+	return 0;
+#else
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_PREERASE */
 }
 
-int storage_area_store_compact(const struct storage_area_store *store,
-			       const struct storage_area_store_compact_cb *cb)
+int storage_area_store_preerase_stop(const struct storage_area_store *store)
 {
-	if (!store_ready(store)) {
+	if (!store_valid(store)) {
 		return -EINVAL;
 	}
 
-	if (store->data->advance == NULL) {
+	if (!IS_ENABLED(CONFIG_STORAGE_AREA_STORE_PREERASE)) {
 		return -ENOTSUP;
 	}
 
-	int rc;
-
-	(void)store_take_semaphore(store);
-	rc = store->data->advance(store, cb);
-	store_give_semaphore(store);
-	return rc;
+	store_preerase_stop(store);
+	return 0;
 }
 
 bool storage_area_record_valid(const struct storage_area_record *record)
@@ -958,6 +2524,14 @@ bool storage_area_record_valid(const struct storage_area_record *record)
 int storage_area_store_writev(const struct storage_area_store *store,
 			      const struct storage_area_iovec *iovec,
 			      size_t iovcnt)
+{
+	return storage_area_store_writev_record(store, iovec, iovcnt, NULL);
+}
+
+int storage_area_store_writev_record(const struct storage_area_store *store,
+				     const struct storage_area_iovec *iovec,
+				     size_t iovcnt,
+				     struct storage_area_record *record)
 {
 	if (!store_ready(store)) {
 		return -EINVAL;
@@ -966,7 +2540,7 @@ int storage_area_store_writev(const struct storage_area_store *store,
 	int rc;
 
 	(void)store_take_semaphore(store);
-	rc = store_writev(store, iovec, iovcnt);
+	rc = store_compactor_writev(store, iovec, iovcnt, record);
 	store_give_semaphore(store);
 	return rc;
 }
@@ -989,7 +2563,15 @@ int storage_area_record_next(const struct storage_area_store *store,
 		return -EINVAL;
 	}
 
-	if (record->store == NULL) {
+	if ((record->store == NULL) && (store->data->compact_scnt != 0U)) {
+		/*
+		 * a pending compaction (interrupted between steps): the walk
+		 * starts at the first record of the victim that is not moved
+		 */
+		record->loc = store->data->compact_loc;
+		record->size = store->data->compact_size;
+		record->sector = store->data->compact_sector;
+	} else if (record->store == NULL) {
 		record->loc = 0U;
 		record->size = 0U;
 		record->sector = store->data->sector;
@@ -1019,6 +2601,117 @@ int storage_area_record_next(const struct storage_area_store *store,
 	return rc;
 }
 
+int storage_area_store_set_key(const struct storage_area_store *store,
+			       uint32_t (*key)(const struct storage_area_record
+						       *record))
+{
+	if (!store_valid(store)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	(void)store_take_semaphore(store);
+	store->data->key = key;
+	store_give_semaphore(store);
+	return 0;
+#else
+	ARG_UNUSED(key);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+/* check if a sector can contain a record with key */
+static bool store_sector_has_key(const struct storage_area_store *store,
+				 size_t sector, uint32_t key)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM
+	uint8_t summary[SAS_SUMSIZE];
+
+	if ((sector == store->data->sector) ||
+	    (store_summary_read(store, sector, NULL, summary) != 0)) {
+		return true;
+	}
+
+	return store_bloom(&summary[SAS_SUMHDRSIZE], key, false);
+#else
+	ARG_UNUSED(store);
+	ARG_UNUSED(sector);
+	ARG_UNUSED(key);
+	return true;
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY_BLOOM */
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+
+int storage_area_record_find(const struct storage_area_store *store,
+			     struct storage_area_record *record, uint32_t key)
+{
+	if (!store_valid(store)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_SUMMARY
+	if (store->data->key == NULL) {
+		return -ENOTSUP;
+	}
+
+	if ((record->store == NULL) && (store->data->compact_scnt != 0U)) {
+		/*
+		 * a pending compaction (interrupted between steps): the walk
+		 * starts at the first record of the victim that is not moved
+		 */
+		record->loc = store->data->compact_loc;
+		record->size = store->data->compact_size;
+		record->sector = store->data->compact_sector;
+	} else if (record->store == NULL) {
+		record->loc = 0U;
+		record->size = 0U;
+		record->sector = store->data->sector;
+		sector_advance(store, &record->sector,
+			       store->spare_sectors + 1U);
+	}
+
+	record->store = (struct storage_area_store *)store;
+
+	int rc = 0;
+
+	while (true) {
+		if ((record->loc == 0U) && (record->size == 0U) &&
+		    (!store_sector_has_key(store, record->sector, key))) {
+			rc = -ENOENT;
+		} else {
+			rc = store_record_next_in_sector(record, true);
+		}
+
+		if ((rc == 0) && (store->data->key(record) == key)) {
+			break;
+		}
+
+		if (rc == 0) {
+			continue;
+		}
+
+		if (rc != -ENOENT) {
+			break;
+		}
+
+		if (record->sector == store->data->sector) {
+			break;
+		}
+
+		sector_advance(store, &record->sector, 1U);
+		record->loc = 0U;
+		record->size = 0U;
+	}
+
+	return rc;
+#else
+	ARG_UNUSED(record);
+	ARG_UNUSED(key);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_SUMMARY */
+}
+
 int storage_area_record_readv(const struct storage_area_record *record,
 			      size_t start,
 			      const struct storage_area_iovec *iovec,
@@ -1051,6 +2744,81 @@ int storage_area_record_read(const struct storage_area_record *record,
 	return storage_area_record_readv(record, start, &iovec, 1U);
 }
 
+int storage_area_record_map(const struct storage_area_record *record,
+			    size_t start, size_t len, void *buf,
+			    const void **ptr)
+{
+	if ((record == NULL) || (record->store == NULL) ||
+	    (!store_valid(record->store)) ||
+	    (record->loc > record->store->sector_size) ||
+	    (record->size > record->store->sector_size) ||
+	    (record->size < (start + len))) {
+		return -EINVAL;
+	}
+
+	const struct storage_area_store *store = record->store;
+	const size_t rdpos = record->sector * store->sector_size + record->loc +
+			     start + SAS_HDRSIZE;
+
+	return storage_area_map(store->area, (sa_off_t)rdpos, len, buf, ptr);
+}
+
+int storage_area_record_unmap(const struct storage_area_record *record,
+			      const void *ptr)
+{
+	if ((record == NULL) || (record->store == NULL)) {
+		return -EINVAL;
+	}
+
+	return storage_area_unmap(record->store->area, ptr);
+}
+
+int storage_area_record_view(const struct storage_area_record *record,
+			     const void **data, size_t *len)
+{
+	int rc;
+
+	if ((record == NULL) || (data == NULL) || (len == NULL)) {
+		return -EINVAL;
+	}
+
+	rc = storage_area_record_map(record, 0U, record->size, NULL, data);
+	if (rc == 0) {
+		*len = record->size;
+	}
+
+	return rc;
+}
+
+int storage_area_record_view_valid(const struct storage_area_record *record,
+				   const void **data, size_t *len)
+{
+	struct storage_area_record withcrc;
+	int rc;
+
+	if ((record == NULL) || (data == NULL) || (len == NULL)) {
+		return -EINVAL;
+	}
+
+	/* the crc follows the record data */
+	withcrc = *record;
+	withcrc.size += SAS_CRCSIZE;
+	rc = storage_area_record_map(&withcrc, 0U, withcrc.size, NULL, data);
+	if (rc != 0) {
+		return rc;
+	}
+
+	if (!store_record_crc_mapped(record, *data)) {
+		LOG_DBG("record at [%d-%d] has bad crc", record->sector,
+			record->loc);
+		(void)storage_area_record_unmap(record, *data);
+		return -EBADMSG;
+	}
+
+	*len = record->size;
+	return 0;
+}
+
 int storage_area_record_update(const struct storage_area_record *record,
 			       void *data, size_t len)
 {
@@ -1070,14 +2838,14 @@ int storage_area_record_update(const struct storage_area_record *record,
 	size_t rpos = record->loc + SAS_HDRSIZE;
 	size_t apos = SAS_ALIGNDOWN(rpos, align);
 	uint8_t *data8 = (uint8_t *)data;
-	uint8_t buf[align];
+	uint8_t buf[SAS_MOVEBUFSIZE];
 	int rc = 0;
 
 	while (len != 0U) {
 		const size_t modlen = SAS_MIN(len, align - (rpos - apos));
 		struct storage_area_iovec iovec = {
 			.data = buf,
-			.len = sizeof(buf),
+			.len = align,
 		};
 		const sa_off_t rdwroff = (sa_off_t)(secpos + apos);
 
@@ -1117,39 +2885,144 @@ int storage_area_store_get_sector_cookie(const struct storage_area_store *store,
 	return store_get_sector_cookie(store, sector, cookie, cksz);
 }
 
-int storage_area_store_wipe(const struct storage_area_store *store)
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+/* erase counter index of the erase unit that contains an erase block */
+static int store_wear_block(const struct storage_area_store *store,
+			    size_t block, size_t *unit)
+{
+	const size_t bsector =
+		(block * store->area->erase_size) / store->sector_size;
+
+	if (bsector >= store->sector_cnt) {
+		LOG_DBG("Invalid erase block");
+		return -EINVAL;
+	}
+
+	*unit = store_wear_unit(store, bsector);
+	return 0;
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
+int storage_area_store_get_wear(const struct storage_area_store *store,
+				size_t block, uint32_t *erases)
+{
+	if ((!store_valid(store)) || (erases == NULL)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	size_t unit;
+	int rc = store_wear_block(store, block, &unit);
+
+	if (rc == 0) {
+		*erases = store->data->wear[unit];
+	}
+
+	return rc;
+#else
+	ARG_UNUSED(block);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+int storage_area_store_set_wear_limit(const struct storage_area_store *store,
+				      uint32_t limit)
+{
+	if (!store_valid(store)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	store->data->wear_limit = limit;
+	return 0;
+#else
+	ARG_UNUSED(limit);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+int storage_area_store_retire_block(const struct storage_area_store *store,
+				    size_t block)
 {
 	if (!store_valid(store)) {
 		return -EINVAL;
 	}
 
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	size_t unit;
+	int rc;
+
+	if (store->data->ready) {
+		return -EBUSY;
+	}
+
+	rc = store_wear_block(store, block, &unit);
+	if (rc == 0) {
+		store->data->wear[unit] = SAS_RETIRED;
+	}
+
+	return rc;
+#else
+	ARG_UNUSED(block);
+	return -ENOTSUP;
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+}
+
+int storage_area_store_wipe(const struct storage_area_store *store)
+{
+	if ((!store_valid(store)) || (!store_config_valid(store))) {
+		return -EINVAL;
+	}
+
 	if (store->data->ready) {
 		return -EINVAL;
 	}
 
 	const struct storage_area *area = store->area;
-	uint8_t wbuf[area->write_size];
-	const struct storage_area_iovec wr = {
-		.data = wbuf,
-		.len = sizeof(wbuf)
-	};
+	const size_t asize = area->erase_size * area->erase_blocks;
+	const size_t bsize = SAS_MAX(SAS_ALIGNDOWN(SAS_WBUFSIZE, area->write_size),
+				     area->write_size);
+	uint8_t wbuf[SAS_WBUFSIZE];
+	struct storage_area_iovec wr[SAS_FILLCNT];
 	sa_off_t wroff = 0;
 	int rc;
 
-	rc = storage_area_erase(area, 0, area->erase_blocks);
+	/* the area is completely rewritten: a discard avoids a second fill */
+	rc = storage_area_discard(area, 0, area->erase_blocks);
 
 	if (rc != 0) {
 		goto end;
 	}
 
-	while (wroff < (area->erase_size * area->erase_blocks)) {
-		rc = storage_area_writev(area, wroff, &wr, 1U);
+	/*
+	 * the area is filled in chunks of the buffer size (or of a write
+	 * block), the fill differs from the erase value so sectors are erased
+	 * before they are reused
+	 */
+	memset(wbuf,
+	       STORAGE_AREA_HAS_PROPERTY(area, STORAGE_AREA_PROP_ZEROERASE)
+		       ? 0xff
+		       : 0x00,
+	       sizeof(wbuf));
+	while (wroff < asize) {
+		const size_t len = SAS_MIN(bsize, asize - wroff);
+
+		rc = storage_area_writev(area, wroff, wr,
+					 store_fill_iovec(wr, wbuf, len));
 		if (rc != 0) {
 			break;
 		}
 
-		wroff += sizeof(wbuf);
+		wroff += len;
+	}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+	const size_t uscnt = store_unit_sectors(store);
+
+	for (size_t i = 0U; (rc == 0) && (i < store->sector_cnt); i += uscnt) {
+		store_wear_add(store, i);
 	}
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
 end:
 	return rc;
 }
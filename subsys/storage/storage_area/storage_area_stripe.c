@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/storage/storage_area/storage_area_stripe.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(storage_area_stripe, CONFIG_STORAGE_AREA_LOG_LEVEL);
+
+#if defined(CONFIG_STORAGE_AREA_STRIPE_WORKERS) &&                             \
+	(CONFIG_STORAGE_AREA_STRIPE_WORKERS > 0)
+#define SA_STRIPE_WORKERS CONFIG_STORAGE_AREA_STRIPE_WORKERS
+#endif
+
+enum sa_stripe_op {
+	SA_STRIPE_READ,
+	SA_STRIPE_WRITE,
+	SA_STRIPE_ERASE,
+	SA_STRIPE_BLANK_CHECK,
+};
+
+static void sa_stripe_lock(const struct storage_area_stripe *stripe)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_lock(stripe->lock, K_FOREVER);
+#else
+	ARG_UNUSED(stripe);
+#endif
+}
+
+static void sa_stripe_unlock(const struct storage_area_stripe *stripe)
+{
+#ifdef CONFIG_MULTITHREADING
+	(void)k_mutex_unlock(stripe->lock);
+#else
+	ARG_UNUSED(stripe);
+#endif
+}
+
+/*
+ * Get the part of iovec (that starts at offset) that covers [start, end) in
+ * sub, returns the number of entries in sub.
+ */
+static size_t sa_stripe_slice(const struct storage_area_iovec *iovec,
+			      size_t iovcnt, sa_off_t offset, sa_off_t start,
+			      sa_off_t end, struct storage_area_iovec *sub)
+{
+	size_t cnt = 0U;
+
+	for (size_t i = 0U; (i < iovcnt) && (offset < end); i++) {
+		const sa_off_t ivend = offset + iovec[i].len;
+		const sa_off_t ivstart = MAX(offset, start);
+
+		if (ivstart < MIN(ivend, end)) {
+			sub[cnt].data = (uint8_t *)iovec[i].data +
+					(ivstart - offset);
+			sub[cnt].len = MIN(ivend, end) - ivstart;
+			cnt++;
+		}
+
+		offset = ivend;
+	}
+
+	return cnt;
+}
+
+/* execute the stripe operation on child idx */
+static int sa_stripe_child_op(const struct storage_area_stripe *stripe,
+			      size_t idx)
+{
+	const struct storage_area_stripe_data *data = stripe->data;
+	const struct storage_area *child = stripe->children[idx];
+	const sa_off_t end = data->offset + data->len;
+	const size_t su = stripe->su;
+	size_t unit = data->offset / su;
+	int rc = 0;
+
+	if (data->op == SA_STRIPE_ERASE) {
+		return storage_area_erase(child, (size_t)data->offset,
+					  data->len);
+	}
+
+	if (data->len == 0U) {
+		return 0;
+	}
+
+	/* first stripe unit on child idx */
+	unit += (idx + stripe->cnt - (unit % stripe->cnt)) % stripe->cnt;
+	while ((rc == 0) && (((sa_off_t)unit * su) < end)) {
+		const sa_off_t ustart = MAX((sa_off_t)unit * su, data->offset);
+		const sa_off_t uend = MIN((sa_off_t)(unit + 1) * su, end);
+		const sa_off_t coff = (sa_off_t)(unit / stripe->cnt) * su +
+				      (ustart - (sa_off_t)unit * su);
+
+		if (data->op == SA_STRIPE_BLANK_CHECK) {
+			rc = storage_area_blank_check(child, coff,
+						      uend - ustart);
+		} else {
+			struct storage_area_iovec
+				sub[STORAGE_AREA_STRIPE_MAX_IOVCNT];
+			size_t subcnt;
+
+			subcnt = sa_stripe_slice(data->iovec, data->iovcnt,
+						 data->offset, ustart, uend,
+						 sub);
+			if (data->op == SA_STRIPE_READ) {
+				rc = storage_area_readv(child, coff, sub,
+							subcnt);
+			} else {
+				rc = storage_area_writev(child, coff, sub,
+							 subcnt);
+			}
+		}
+
+		unit += stripe->cnt;
+	}
+
+	return rc;
+}
+
+#ifdef SA_STRIPE_WORKERS
+static K_THREAD_STACK_ARRAY_DEFINE(sa_stripe_stack, SA_STRIPE_WORKERS,
+				   CONFIG_STORAGE_AREA_STRIPE_STACK_SIZE);
+static struct k_work_q sa_stripe_wq[SA_STRIPE_WORKERS];
+
+static int sa_stripe_wq_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "sa_stripe",
+	};
+
+	for (size_t i = 0U; i < SA_STRIPE_WORKERS; i++) {
+		k_work_queue_start(&sa_stripe_wq[i], sa_stripe_stack[i],
+				   K_THREAD_STACK_SIZEOF(sa_stripe_stack[i]),
+				   CONFIG_STORAGE_AREA_STRIPE_PRIORITY, &cfg);
+	}
+
+	return 0;
+}
+
+SYS_INIT(sa_stripe_wq_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
+
+static void sa_stripe_work(struct k_work *work)
+{
+	struct storage_area_stripe_task *task =
+		CONTAINER_OF(work, struct storage_area_stripe_task, work);
+	const struct storage_area_stripe *stripe = task->stripe;
+
+	task->rc = sa_stripe_child_op(stripe, task - stripe->tasks);
+	k_sem_give(&stripe->data->done);
+}
+#endif /* SA_STRIPE_WORKERS */
+
+/* execute the stripe operation on all children, called with the lock taken */
+static int sa_stripe_run(const struct storage_area_stripe *stripe)
+{
+	int rc = 0;
+
+#ifdef SA_STRIPE_WORKERS
+	/* the first child is handled by the calling thread */
+	for (size_t i = 1U; i < stripe->cnt; i++) {
+		(void)k_work_submit_to_queue(
+			&sa_stripe_wq[(i - 1U) % SA_STRIPE_WORKERS],
+			&stripe->tasks[i].work);
+	}
+
+	stripe->tasks[0].rc = sa_stripe_child_op(stripe, 0U);
+	for (size_t i = 1U; i < stripe->cnt; i++) {
+		(void)k_sem_take(&stripe->data->done, K_FOREVER);
+	}
+#else
+	for (size_t i = 0U; i < stripe->cnt; i++) {
+		stripe->tasks[i].rc = sa_stripe_child_op(stripe, i);
+	}
+#endif /* SA_STRIPE_WORKERS */
+
+	for (size_t i = 0U; i < stripe->cnt; i++) {
+		if (stripe->tasks[i].rc != 0) {
+			rc = stripe->tasks[i].rc;
+			break;
+		}
+	}
+
+	return rc;
+}
+
+static int sa_stripe_init(const struct storage_area_stripe *stripe)
+{
+	const struct storage_area *area = &stripe->area;
+
+	for (size_t i = 0U; i < stripe->cnt; i++) {
+		const struct storage_area *child = stripe->children[i];
+
+		if ((child == NULL) || (child->api == NULL)) {
+			LOG_DBG("Bad child %zu", i);
+			return -EINVAL;
+		}
+
+		/* autoerase is done by the stripe, not by the children */
+		if ((child->write_size != area->write_size) ||
+		    ((child->erase_size * stripe->cnt) != area->erase_size) ||
+		    (child->erase_blocks != area->erase_blocks) ||
+		    (STORAGE_AREA_AUTOERASE(child)) ||
+		    ((child->props | STORAGE_AREA_PROP_AUTOERASE) !=
+		     (area->props | STORAGE_AREA_PROP_AUTOERASE))) {
+			LOG_DBG("Child %zu definition differs", i);
+			return -EINVAL;
+		}
+	}
+
+	for (size_t i = 0U; i < stripe->cnt; i++) {
+		stripe->tasks[i].stripe = stripe;
+#ifdef SA_STRIPE_WORKERS
+		k_work_init(&stripe->tasks[i].work, sa_stripe_work);
+#endif /* SA_STRIPE_WORKERS */
+	}
+
+#ifdef SA_STRIPE_WORKERS
+	(void)k_sem_init(&stripe->data->done, 0, stripe->cnt);
+#endif /* SA_STRIPE_WORKERS */
+	return 0;
+}
+
+/* called with the stripe locked */
+static int sa_stripe_valid(const struct storage_area_stripe *stripe)
+{
+	int rc = 0;
+
+	if (!stripe->data->ready) {
+		rc = sa_stripe_init(stripe);
+		stripe->data->ready = (rc == 0);
+	}
+
+	return rc;
+}
+
+static int sa_stripe_rw(const struct storage_area *area, enum sa_stripe_op op,
+			sa_off_t offset, const struct storage_area_iovec *iovec,
+			size_t iovcnt)
+{
+	const struct storage_area_stripe *stripe =
+		CONTAINER_OF(area, struct storage_area_stripe, area);
+	struct storage_area_stripe_data *data = stripe->data;
+	int rc;
+
+	if (iovcnt > STORAGE_AREA_STRIPE_MAX_IOVCNT) {
+		LOG_DBG("Too many iovec elements");
+		return -EINVAL;
+	}
+
+	sa_stripe_lock(stripe);
+	rc = sa_stripe_valid(stripe);
+	if (rc != 0) {
+		goto end;
+	}
+
+	size_t len = 0U;
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		len += iovec[i].len;
+	}
+
+	/* erase the blocks of all children when a write starts a block */
+	if ((op == SA_STRIPE_WRITE) && (STORAGE_AREA_AUTOERASE(area))) {
+		const size_t esz = area->erase_size;
+
+		for (size_t blk = DIV_ROUND_UP(offset, esz);
+		     ((sa_off_t)blk * esz) < (offset + len); blk++) {
+			data->op = SA_STRIPE_ERASE;
+			data->offset = (sa_off_t)blk;
+			data->len = 1U;
+			rc = sa_stripe_run(stripe);
+			if (rc != 0) {
+				goto end;
+			}
+		}
+	}
+
+	data->op = op;
+	data->offset = offset;
+	data->iovec = iovec;
+	data->iovcnt = iovcnt;
+	data->len = len;
+	rc = sa_stripe_run(stripe);
+end:
+	sa_stripe_unlock(stripe);
+	return rc;
+}
+
+static int sa_stripe_readv(const struct storage_area *area, sa_off_t offset,
+			   const struct storage_area_iovec *iovec,
+			   size_t iovcnt)
+{
+	return sa_stripe_rw(area, SA_STRIPE_READ, offset, iovec, iovcnt);
+}
+
+static int sa_stripe_writev(const struct storage_area *area, sa_off_t offset,
+			    const struct storage_area_iovec *iovec,
+			    size_t iovcnt)
+{
+	return sa_stripe_rw(area, SA_STRIPE_WRITE, offset, iovec, iovcnt);
+}
+
+static int sa_stripe_erase(const struct storage_area *area, size_t sblk,
+			   size_t bcnt)
+{
+	const struct storage_area_stripe *stripe =
+		CONTAINER_OF(area, struct storage_area_stripe, area);
+	struct storage_area_stripe_data *data = stripe->data;
+	int rc;
+
+	sa_stripe_lock(stripe);
+	rc = sa_stripe_valid(stripe);
+	if (rc != 0) {
+		goto end;
+	}
+
+	/* a stripe erase block is one erase block on each child */
+	data->op = SA_STRIPE_ERASE;
+	data->offset = (sa_off_t)sblk;
+	data->len = bcnt;
+	rc = sa_stripe_run(stripe);
+end:
+	sa_stripe_unlock(stripe);
+	return rc;
+}
+
+static int sa_stripe_blank_check(const struct storage_area *area,
+				 sa_off_t offset, size_t len)
+{
+	const struct storage_area_stripe *stripe =
+		CONTAINER_OF(area, struct storage_area_stripe, area);
+	struct storage_area_stripe_data *data = stripe->data;
+	int rc;
+
+	sa_stripe_lock(stripe);
+	rc = sa_stripe_valid(stripe);
+	if (rc != 0) {
+		goto end;
+	}
+
+	data->op = SA_STRIPE_BLANK_CHECK;
+	data->offset = offset;
+	data->len = len;
+	rc = sa_stripe_run(stripe);
+end:
+	sa_stripe_unlock(stripe);
+	return rc;
+}
+
+static int sa_stripe_ioctl(const struct storage_area *area,
+			   enum storage_area_ioctl_cmd cmd, void *data)
+{
+	const struct storage_area_stripe *stripe =
+		CONTAINER_OF(area, struct storage_area_stripe, area);
+	int rc;
+
+	sa_stripe_lock(stripe);
+	rc = sa_stripe_valid(stripe);
+	if (rc != 0) {
+		goto end;
+	}
+
+	switch (cmd) {
+	case STORAGE_AREA_IOCTL_FLUSH:
+		for (size_t i = 0U; i < stripe->cnt; i++) {
+			rc = storage_area_ioctl(stripe->children[i], cmd, data);
+			if (rc == -ENOTSUP) {
+				rc = 0;
+			}
+
+			if (rc != 0) {
+				break;
+			}
+		}
+
+		break;
+	case STORAGE_AREA_IOCTL_DISCARD:
+		if (data == NULL) {
+			rc = -EINVAL;
+			break;
+		}
+
+		/* a stripe block is the same block on each child */
+		const struct storage_area_blocks *blocks =
+			(const struct storage_area_blocks *)data;
+
+		for (size_t i = 0U; i < stripe->cnt; i++) {
+			rc = storage_area_discard(stripe->children[i],
+						  blocks->sblk, blocks->bcnt);
+			if (rc != 0) {
+				break;
+			}
+		}
+
+		break;
+	default:
+		/* the stripe is not contiguous on one child (e.g. no xip) */
+		rc = -ENOTSUP;
+		break;
+	}
+end:
+	sa_stripe_unlock(stripe);
+	return rc;
+}
+
+const struct storage_area_api storage_area_stripe_rw_api = {
+	.readv = sa_stripe_readv,
+	.writev = sa_stripe_writev,
+	.erase = sa_stripe_erase,
+	.blank_check = sa_stripe_blank_check,
+	.ioctl = sa_stripe_ioctl,
+};
+
+const struct storage_area_api storage_area_stripe_ro_api = {
+	.readv = sa_stripe_readv,
+	.blank_check = sa_stripe_blank_check,
+	.ioctl = sa_stripe_ioctl,
+};
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host side clock of the storage area benchmarks, this is built with the host
+ * libc (no zephyr headers).
+ */
+
+#ifndef BENCH_CLOCK_NATIVE_H_
+#define BENCH_CLOCK_NATIVE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Monotonic host time in nanoseconds. */
+unsigned long long bench_clock_native_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_CLOCK_NATIVE_H_ */
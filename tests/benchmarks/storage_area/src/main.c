@@ -0,0 +1,853 @@
+/*
+ * Copyright (c) 2024 Laczen
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Storage area benchmarks: the storage area backends are timed for several
+ * write sizes and iovec counts, the storage area store is timed for append,
+ * mount, iterate and compact at several fill levels. Each result is printed
+ * as one comma separated line:
+ *
+ * BENCH,<backend>,<test>,<param>,<iovcnt>,<ops>,<bytes>,<us>,<ops/s>,<bytes/s>
+ *
+ * For the storage area tests <param> is the size of each operation, for the
+ * store tests it is the fill level (percentage of live records) and <iovcnt>
+ * is 0. For the mount_size test <param> is the number of store sectors, for
+ * settings_load it is the number of settings and <bytes> are the records read.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/storage/storage_area/storage_area.h>
+#include <zephyr/storage/storage_area/storage_area_store.h>
+#ifdef CONFIG_NATIVE_LIBRARY
+#include "bench_clock_native.h"
+#endif
+
+#define BENCH_SECTOR_SIZE 1024
+#define BENCH_RECORD_SIZE 32
+#define BENCH_MAX_SIZE	  4096
+#define BENCH_MAX_IOVCNT  16
+#define BENCH_READ_CNT	  1000
+#define BENCH_READ_SIZE	  4
+
+#ifdef CONFIG_STORAGE_AREA_RAM
+#include <zephyr/storage/storage_area/storage_area_ram.h>
+#define RAM_AREA_SIZE	(64 * 1024)
+#define RAM_ERASE_SIZE	4096
+#define RAM_WRITE_SIZE	4
+
+static uint8_t ram_mem[RAM_AREA_SIZE];
+STORAGE_AREA_RAM_RW_DEFINE(ram, (uintptr_t)ram_mem, RAM_WRITE_SIZE,
+	RAM_ERASE_SIZE, RAM_AREA_SIZE, 0);
+#endif /* CONFIG_STORAGE_AREA_RAM */
+
+#ifdef CONFIG_STORAGE_AREA_FLASH
+#include <zephyr/storage/storage_area/storage_area_flash.h>
+#define FLASH_AREA_NODE		DT_NODELABEL(storage_partition)
+#define FLASH_MTD_NODE		DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE)
+#define FLASH_AREA_OFFSET	DT_REG_ADDR(FLASH_AREA_NODE)
+#define FLASH_AREA_DEVICE	DEVICE_DT_GET(FLASH_MTD_NODE)
+#define FLASH_AREA_SIZE		DT_REG_SIZE(FLASH_AREA_NODE)
+#define FLASH_ERASE_SIZE	DT_PROP(FLASH_MTD_NODE, erase_block_size)
+#define FLASH_WRITE_SIZE	8
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	STORAGE_AREA_FLASH_NO_XIP, FLASH_WRITE_SIZE, FLASH_ERASE_SIZE,
+	FLASH_AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE);
+#endif /* CONFIG_STORAGE_AREA_FLASH */
+
+#ifdef CONFIG_STORAGE_AREA_EEPROM
+#include <zephyr/storage/storage_area/storage_area_eeprom.h>
+#define EEPROM_NODE		DT_ALIAS(eeprom_0)
+#define EEPROM_AREA_DEVICE	DEVICE_DT_GET(EEPROM_NODE)
+#define EEPROM_AREA_SIZE	DT_PROP(EEPROM_NODE, size)
+#define EEPROM_ERASE_SIZE	4096
+#define EEPROM_WRITE_SIZE	4
+
+STORAGE_AREA_EEPROM_RW_DEFINE(eeprom, EEPROM_AREA_DEVICE, 0U,
+	EEPROM_WRITE_SIZE, EEPROM_ERASE_SIZE, EEPROM_AREA_SIZE, 0);
+#endif /* CONFIG_STORAGE_AREA_EEPROM */
+
+#ifdef CONFIG_STORAGE_AREA_DISK
+#include <zephyr/storage/storage_area/storage_area_disk.h>
+#define DISK_NODE		DT_NODELABEL(ramdisk0)
+#define DISK_NAME		DT_PROP(DISK_NODE, disk_name)
+#define DISK_SSIZE		DT_PROP(DISK_NODE, sector_size)
+#define DISK_SCNT		DT_PROP(DISK_NODE, sector_count)
+#define DISK_AREA_SIZE		(DISK_SCNT * DISK_SSIZE)
+#define DISK_ERASE_SIZE		4096
+#define DISK_WRITE_SIZE		DISK_SSIZE
+
+STORAGE_AREA_DISK_RW_DEFINE(disk, DISK_NAME, 0U, DISK_SSIZE, DISK_WRITE_SIZE,
+	DISK_ERASE_SIZE, DISK_AREA_SIZE, 0);
+#endif /* CONFIG_STORAGE_AREA_DISK */
+
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+#include <zephyr/storage/storage_area/storage_area_nor_sim.h>
+#define NOR_SIM_AREA_SIZE	(64 * 1024)
+#define NOR_SIM_ERASE_SIZE	4096
+#define NOR_SIM_WRITE_SIZE	8
+/* 1 us program time per byte, 20 ms erase time per block */
+#define NOR_SIM_PROGRAM_NS	1000
+#define NOR_SIM_ERASE_US	20000
+
+STORAGE_AREA_NOR_SIM_RW_DEFINE(nor_sim, NOR_SIM_WRITE_SIZE, NOR_SIM_ERASE_SIZE,
+	NOR_SIM_AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE, NOR_SIM_PROGRAM_NS,
+	NOR_SIM_ERASE_US);
+#endif /* CONFIG_STORAGE_AREA_NOR_SIM */
+
+static const char cookie[] = "!BEN";
+
+/*
+ * Each backend gets a store with the same sector size, the spare sectors
+ * cover one erase block. Two smaller stores (a quarter and half of the
+ * sectors) are used to time the mount for different store sizes.
+ */
+#define BENCH_STORE_DEFINE(_name, _size, _es)                                   \
+	STORAGE_AREA_STORE_DEFINE(_name, GET_STORAGE_AREA(_name),               \
+				  (void *)cookie, sizeof(cookie),               \
+				  BENCH_SECTOR_SIZE,                            \
+				  (_size) / BENCH_SECTOR_SIZE,                  \
+				  MAX(1, (_es) / BENCH_SECTOR_SIZE), 0U);       \
+	STORAGE_AREA_STORE_DEFINE(_name##_quarter, GET_STORAGE_AREA(_name),     \
+				  (void *)cookie, sizeof(cookie),               \
+				  BENCH_SECTOR_SIZE,                            \
+				  MAX(2, (_size) / (4 * BENCH_SECTOR_SIZE)),    \
+				  0U, 0U);                                      \
+	STORAGE_AREA_STORE_DEFINE(_name##_half, GET_STORAGE_AREA(_name),        \
+				  (void *)cookie, sizeof(cookie),               \
+				  BENCH_SECTOR_SIZE,                            \
+				  MAX(2, (_size) / (2 * BENCH_SECTOR_SIZE)),    \
+				  0U, 0U)
+
+#ifdef CONFIG_STORAGE_AREA_RAM
+BENCH_STORE_DEFINE(ram, RAM_AREA_SIZE, RAM_ERASE_SIZE);
+#endif
+#ifdef CONFIG_STORAGE_AREA_FLASH
+BENCH_STORE_DEFINE(flash, FLASH_AREA_SIZE, FLASH_ERASE_SIZE);
+#endif
+#ifdef CONFIG_STORAGE_AREA_EEPROM
+BENCH_STORE_DEFINE(eeprom, EEPROM_AREA_SIZE, EEPROM_ERASE_SIZE);
+#endif
+#ifdef CONFIG_STORAGE_AREA_DISK
+BENCH_STORE_DEFINE(disk, DISK_AREA_SIZE, DISK_ERASE_SIZE);
+#endif
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+BENCH_STORE_DEFINE(nor_sim, NOR_SIM_AREA_SIZE, NOR_SIM_ERASE_SIZE);
+#endif
+
+/*
+ * Settings on flash are loaded directly and through a read cache, each
+ * setting is written several times so the load skips the older records.
+ */
+#if defined(CONFIG_SETTINGS_STORAGE_AREA_STORE) &&                              \
+	defined(CONFIG_STORAGE_AREA_FLASH)
+#define BENCH_SETTINGS
+#include <zephyr/settings/settings_storage_area_store.h>
+#define BENCH_SETTINGS_KEYS   32
+#define BENCH_SETTINGS_WRITES 4
+#define BENCH_SETTINGS_LOADS  8
+
+#define BENCH_SETTINGS_DEFINE(_name, _area)                                     \
+	STORAGE_AREA_STORE_DEFINE(_name, _area, (void *)cookie,                 \
+				  sizeof(cookie), BENCH_SECTOR_SIZE,            \
+				  FLASH_AREA_SIZE / BENCH_SECTOR_SIZE,          \
+				  MAX(1, FLASH_ERASE_SIZE / BENCH_SECTOR_SIZE), \
+				  0U);                                          \
+	create_settings_storage_area_store(_name, GET_STORAGE_AREA_STORE(_name))
+
+BENCH_SETTINGS_DEFINE(flash_settings, GET_STORAGE_AREA(flash));
+#ifdef CONFIG_STORAGE_AREA_RCACHE
+#include <zephyr/storage/storage_area/storage_area_rcache.h>
+#define RCACHE_LINE_SIZE 64
+#define RCACHE_LINE_CNT	 8
+
+STORAGE_AREA_RCACHE_RW_DEFINE(flash_rcache, GET_STORAGE_AREA(flash),
+	RCACHE_LINE_SIZE, RCACHE_LINE_CNT, FLASH_WRITE_SIZE, FLASH_ERASE_SIZE,
+	FLASH_AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE);
+BENCH_SETTINGS_DEFINE(flash_rcache_settings, GET_STORAGE_AREA(flash_rcache));
+#endif /* CONFIG_STORAGE_AREA_RCACHE */
+#endif
+
+struct bench_backend {
+	const char *name;
+	const struct storage_area *area;
+	const struct storage_area_store *store;
+	const struct storage_area_store *quarter;
+	const struct storage_area_store *half;
+};
+
+#define BENCH_BACKEND(_name)                                                    \
+	{                                                                       \
+		.name = STRINGIFY(_name), .area = GET_STORAGE_AREA(_name),      \
+		.store = GET_STORAGE_AREA_STORE(_name),                         \
+		.quarter = GET_STORAGE_AREA_STORE(_name##_quarter),             \
+		.half = GET_STORAGE_AREA_STORE(_name##_half),                   \
+	}
+
+static const struct bench_backend backends[] = {
+#ifdef CONFIG_STORAGE_AREA_RAM
+	BENCH_BACKEND(ram),
+#endif
+#ifdef CONFIG_STORAGE_AREA_FLASH
+	BENCH_BACKEND(flash),
+#endif
+#ifdef CONFIG_STORAGE_AREA_EEPROM
+	BENCH_BACKEND(eeprom),
+#endif
+#ifdef CONFIG_STORAGE_AREA_DISK
+	BENCH_BACKEND(disk),
+#endif
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+	BENCH_BACKEND(nor_sim),
+#endif
+};
+
+static const size_t bench_sizes[] = {16, 64, 256, 512, 1024, BENCH_MAX_SIZE};
+static const size_t bench_iovcnts[] = {1, 4, BENCH_MAX_IOVCNT};
+static const uint32_t bench_fills[] = {25, 50, 75};
+
+static uint8_t bench_buf[BENCH_MAX_SIZE];
+static int bench_errors;
+
+static uint64_t bench_start(void)
+{
+#ifdef CONFIG_NATIVE_LIBRARY
+	return bench_clock_native_ns();
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+static uint64_t bench_elapsed_ns(uint64_t start)
+{
+#ifdef CONFIG_NATIVE_LIBRARY
+	return bench_clock_native_ns() - start;
+#else
+	return k_cyc_to_ns_floor64((uint32_t)(k_cycle_get_32() -
+					      (uint32_t)start));
+#endif
+}
+
+static void bench_report(const char *backend, const char *test, size_t param,
+			 size_t iovcnt, uint64_t ops, uint64_t bytes,
+			 uint64_t ns)
+{
+	const uint64_t div = MAX(ns, 1U);
+
+	printk("BENCH,%s,%s,%zu,%zu,%llu,%llu,%llu,%llu,%llu\n", backend, test,
+	       param, iovcnt, (unsigned long long)ops,
+	       (unsigned long long)bytes, (unsigned long long)(ns / 1000U),
+	       (unsigned long long)((ops * 1000000000U) / div),
+	       (unsigned long long)((bytes * 1000000000U) / div));
+}
+
+static void bench_error(const char *backend, const char *test, int rc)
+{
+	printk("BENCH_ERROR,%s,%s,%d\n", backend, test, rc);
+	bench_errors++;
+}
+
+/* split size bytes of bench_buf over iovcnt iovec elements */
+/*
+ * The simulated nor flash keeps the device time on a virtual clock, it is
+ * reported as an extra <test>_dev result: <ops> are the writes and erases,
+ * <bytes> the bytes written and <us> the program and erase time.
+ */
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+static struct storage_area_nor_sim_stats bench_dev;
+
+static void bench_dev_start(const struct bench_backend *be)
+{
+	if (storage_area_ioctl(be->area, STORAGE_AREA_IOCTL_NOR_SIM_STATS,
+			       &bench_dev) != 0) {
+		bench_dev.busy_us = UINT64_MAX;
+	}
+}
+
+static void bench_dev_report(const struct bench_backend *be, const char *test,
+			     size_t param, size_t iovcnt)
+{
+	struct storage_area_nor_sim_stats st;
+
+	if ((bench_dev.busy_us == UINT64_MAX) ||
+	    (storage_area_ioctl(be->area, STORAGE_AREA_IOCTL_NOR_SIM_STATS,
+				&st) != 0)) {
+		return;
+	}
+
+	bench_report(be->name, test, param, iovcnt,
+		     (st.writes - bench_dev.writes) +
+			     (st.erases - bench_dev.erases),
+		     st.write_bytes - bench_dev.write_bytes,
+		     (st.busy_us - bench_dev.busy_us) * 1000U);
+}
+#else
+static void bench_dev_start(const struct bench_backend *be)
+{
+	ARG_UNUSED(be);
+}
+
+static void bench_dev_report(const struct bench_backend *be, const char *test,
+			     size_t param, size_t iovcnt)
+{
+	ARG_UNUSED(be);
+	ARG_UNUSED(test);
+	ARG_UNUSED(param);
+	ARG_UNUSED(iovcnt);
+}
+#endif /* CONFIG_STORAGE_AREA_NOR_SIM */
+
+static void bench_iovec_fill(struct storage_area_iovec *iovec, size_t iovcnt,
+			     size_t size)
+{
+	const size_t chunk = size / iovcnt;
+	uint8_t *data = bench_buf;
+
+	for (size_t i = 0U; i < iovcnt; i++) {
+		iovec[i].data = data;
+		iovec[i].len = (i == (iovcnt - 1U)) ? size - chunk * i : chunk;
+		data += iovec[i].len;
+	}
+}
+
+static void bench_area_erase(const struct bench_backend *be)
+{
+	const struct storage_area *area = be->area;
+	uint64_t start, ns;
+	int rc;
+
+	bench_dev_start(be);
+	start = bench_start();
+	rc = storage_area_erase(area, 0U, area->erase_blocks);
+	ns = bench_elapsed_ns(start);
+	if (rc != 0) {
+		bench_error(be->name, "erase", rc);
+		return;
+	}
+
+	bench_report(be->name, "erase", area->erase_size, 0U,
+		     area->erase_blocks, area->erase_size * area->erase_blocks,
+		     ns);
+	bench_dev_report(be, "erase_dev", area->erase_size, 0U);
+}
+
+static void bench_area_rw(const struct bench_backend *be, size_t size,
+			  size_t iovcnt)
+{
+	const struct storage_area *area = be->area;
+	const size_t asize = area->erase_size * area->erase_blocks;
+	const size_t ops = asize / size;
+	struct storage_area_iovec iovec[BENCH_MAX_IOVCNT];
+	uint64_t start, ns;
+	int rc = 0;
+
+	bench_iovec_fill(iovec, iovcnt, size);
+
+	/* the erase is not part of the write timing */
+	rc = storage_area_erase(area, 0U, area->erase_blocks);
+	if (rc != 0) {
+		bench_error(be->name, "write", rc);
+		return;
+	}
+
+	bench_dev_start(be);
+	start = bench_start();
+	for (size_t i = 0U; (rc == 0) && (i < ops); i++) {
+		rc = storage_area_writev(area, (sa_off_t)(i * size), iovec,
+					 iovcnt);
+	}
+
+	ns = bench_elapsed_ns(start);
+	if (rc != 0) {
+		bench_error(be->name, "write", rc);
+		return;
+	}
+
+	bench_report(be->name, "write", size, iovcnt, ops, ops * size, ns);
+	bench_dev_report(be, "write_dev", size, iovcnt);
+
+	start = bench_start();
+	for (size_t i = 0U; (rc == 0) && (i < ops); i++) {
+		rc = storage_area_readv(area, (sa_off_t)(i * size), iovec,
+					iovcnt);
+	}
+
+	ns = bench_elapsed_ns(start);
+	if (rc != 0) {
+		bench_error(be->name, "read", rc);
+		return;
+	}
+
+	bench_report(be->name, "read", size, iovcnt, ops, ops * size, ns);
+}
+
+/*
+ * Small reads: the area is not used before, so the first read includes the
+ * checks of backends that validate on first use (read_first), the average of
+ * the following reads does not.
+ */
+static void bench_area_read_small(const struct bench_backend *be)
+{
+	const struct storage_area *area = be->area;
+	uint8_t rd[BENCH_READ_SIZE];
+	uint64_t start, ns;
+	int rc;
+
+	start = bench_start();
+	rc = storage_area_read(area, 0U, rd, sizeof(rd));
+	ns = bench_elapsed_ns(start);
+	if (rc != 0) {
+		bench_error(be->name, "read_first", rc);
+		return;
+	}
+
+	bench_report(be->name, "read_first", sizeof(rd), 1U, 1U, sizeof(rd), ns);
+
+	start = bench_start();
+	for (size_t i = 0U; (rc == 0) && (i < BENCH_READ_CNT); i++) {
+		rc = storage_area_read(area, 0U, rd, sizeof(rd));
+	}
+
+	ns = bench_elapsed_ns(start);
+	if (rc != 0) {
+		bench_error(be->name, "read_small", rc);
+		return;
+	}
+
+	bench_report(be->name, "read_small", sizeof(rd), 1U, BENCH_READ_CNT,
+		     BENCH_READ_CNT * sizeof(rd), ns);
+}
+
+static void bench_area(const struct bench_backend *be)
+{
+	const struct storage_area *area = be->area;
+
+	bench_area_read_small(be);
+	bench_area_erase(be);
+	for (size_t i = 0U; i < ARRAY_SIZE(bench_sizes); i++) {
+		const size_t size = bench_sizes[i];
+
+		if (((size % area->write_size) != 0U) ||
+		    (size > (area->erase_size * area->erase_blocks))) {
+			continue;
+		}
+
+		for (size_t j = 0U; j < ARRAY_SIZE(bench_iovcnts); j++) {
+			bench_area_rw(be, size, bench_iovcnts[j]);
+		}
+	}
+}
+
+/*
+ * The store records hold a key and a sequence number, the keys are updated in
+ * pseudo random order and compaction keeps the last update of each key. The
+ * number of keys sets the fill level.
+ */
+#define BENCH_MAX_KEYS 2048
+
+static uint32_t bench_seqs[BENCH_MAX_KEYS];
+static uint32_t bench_keys;
+static uint32_t bench_seq;
+static uint32_t bench_rand;
+static uint64_t bench_moved;
+
+static bool bench_move(const struct storage_area_record *record)
+{
+	uint32_t hdr[2];
+
+	if (storage_area_record_read(record, 0U, hdr, sizeof(hdr)) != 0) {
+		return false;
+	}
+
+	return (hdr[0] < bench_keys) && (bench_seqs[hdr[0]] == hdr[1]);
+}
+
+static void bench_move_cb(const struct storage_area_record *orig,
+			  const struct storage_area_record *dest)
+{
+	ARG_UNUSED(dest);
+
+	bench_moved += orig->size;
+}
+
+static const struct storage_area_store_compact_cb bench_compact_cb = {
+	.move = bench_move,
+	.move_cb = bench_move_cb,
+};
+
+static void bench_store_reset(uint32_t keys)
+{
+	memset(bench_seqs, 0xff, sizeof(bench_seqs));
+	bench_keys = keys;
+	bench_seq = 0U;
+	bench_rand = 1U;
+}
+
+static int bench_store_write(const struct storage_area_store *store)
+{
+	uint8_t record[BENCH_RECORD_SIZE];
+	const uint32_t rand = bench_rand * 1103515245U + 12345U;
+	uint32_t hdr[2];
+	int rc;
+
+	hdr[0] = (rand >> 16) % bench_keys;
+	hdr[1] = bench_seq;
+	memset(record, (uint8_t)bench_seq, sizeof(record));
+	memcpy(record, hdr, sizeof(hdr));
+	rc = storage_area_store_write(store, record, sizeof(record));
+	if (rc == 0) {
+		/* a failed write is retried with the same key */
+		bench_rand = rand;
+		bench_seqs[hdr[0]] = bench_seq++;
+	}
+
+	return rc;
+}
+
+/* number of records that fit in a sector */
+static int bench_store_sector_records(const struct storage_area_store *store,
+				      uint32_t *cnt)
+{
+	int rc;
+
+	rc = storage_area_store_wipe(store);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = storage_area_store_mount_cb(store);
+	if (rc != 0) {
+		return rc;
+	}
+
+	bench_store_reset(1U);
+	while (true) {
+		rc = bench_store_write(store);
+		if (rc != 0) {
+			break;
+		}
+	}
+
+	*cnt = bench_seq;
+	if ((rc == -ENOSPC) && (bench_seq != 0U)) {
+		rc = 0;
+	}
+
+	(void)storage_area_store_unmount(store);
+	return rc;
+}
+
+static int bench_store_append(const struct bench_backend *be, uint32_t fill,
+			      uint32_t records)
+{
+	const struct storage_area_store *store = be->store;
+	uint64_t append_ns = 0U, compact_ns = 0U, compact_ops = 0U;
+	uint64_t start;
+	int rc;
+
+	bench_moved = 0U;
+	bench_dev_start(be);
+	for (uint32_t i = 0U; i < records; i++) {
+		/* a compaction can fill the new sector with moved records */
+		for (size_t j = 0U; j < store->sector_cnt; j++) {
+			start = bench_start();
+			rc = bench_store_write(store);
+			append_ns += bench_elapsed_ns(start);
+			if (rc != -ENOSPC) {
+				break;
+			}
+
+			start = bench_start();
+			rc = storage_area_store_compact(store,
+							&bench_compact_cb);
+			compact_ns += bench_elapsed_ns(start);
+			compact_ops++;
+			if (rc != 0) {
+				bench_error(be->name, "compact", rc);
+				return rc;
+			}
+		}
+
+		if (rc != 0) {
+			bench_error(be->name, "append", rc);
+			return rc;
+		}
+	}
+
+	bench_report(be->name, "append", fill, 0U, records,
+		     (uint64_t)records * BENCH_RECORD_SIZE, append_ns);
+	bench_report(be->name, "compact", fill, 0U, compact_ops, bench_moved,
+		     compact_ns);
+	/* the device time of the appends and the compactions together */
+	bench_dev_report(be, "append_dev", fill, 0U);
+	return 0;
+}
+
+static int bench_store_mount(const struct bench_backend *be, uint32_t fill)
+{
+	const struct storage_area_store *store = be->store;
+	uint64_t start, ns;
+	int rc;
+
+	rc = storage_area_store_unmount(store);
+	if (rc != 0) {
+		bench_error(be->name, "mount", rc);
+		return rc;
+	}
+
+	start = bench_start();
+	rc = storage_area_store_mount(store, &bench_compact_cb);
+	ns = bench_elapsed_ns(start);
+	if (rc != 0) {
+		bench_error(be->name, "mount", rc);
+		return rc;
+	}
+
+	bench_report(be->name, "mount", fill, 0U, 1U,
+		     store->sector_cnt * store->sector_size, ns);
+	return 0;
+}
+
+/*
+ * The store is written around once and then up to 3/4 of its sectors, the
+ * mount has to search for the last written sector and record. The quarter and
+ * half stores have no spare sectors, so they are used without compaction.
+ */
+static int bench_store_mount_size(const struct bench_backend *be,
+				  const struct storage_area_store *store)
+{
+	const size_t end = (3U * store->sector_cnt) / 4U;
+	bool wrapped = false;
+	uint64_t start, ns;
+	int rc;
+
+	rc = storage_area_store_wipe(store);
+	if (rc == 0) {
+		rc = storage_area_store_mount(store, NULL);
+	}
+
+	bench_store_reset(BENCH_MAX_KEYS);
+	while ((rc == 0) && (!wrapped || (store->data->sector != end))) {
+		rc = bench_store_write(store);
+		if (rc == -ENOSPC) {
+			rc = storage_area_store_advance(store);
+			wrapped = wrapped || (store->data->sector == 0U);
+		}
+	}
+
+	if (rc == 0) {
+		rc = storage_area_store_unmount(store);
+	}
+
+	if (rc != 0) {
+		bench_error(be->name, "mount_size", rc);
+		return rc;
+	}
+
+	start = bench_start();
+	rc = storage_area_store_mount(store, NULL);
+	ns = bench_elapsed_ns(start);
+	(void)storage_area_store_unmount(store);
+	if (rc != 0) {
+		bench_error(be->name, "mount_size", rc);
+		return rc;
+	}
+
+	bench_report(be->name, "mount_size", store->sector_cnt, 0U, 1U,
+		     store->sector_cnt * store->sector_size, ns);
+	return 0;
+}
+
+static int bench_store_iterate(const struct bench_backend *be, uint32_t fill)
+{
+	const struct storage_area_store *store = be->store;
+	struct storage_area_record record = {
+		.store = NULL,
+	};
+	uint64_t records = 0U, bytes = 0U;
+	uint64_t start, ns;
+	uint32_t seq;
+	int rc;
+
+	start = bench_start();
+	while (true) {
+		rc = storage_area_record_next(store, &record);
+		if (rc != 0) {
+			break;
+		}
+
+		rc = storage_area_record_read(&record, 0U, &seq, sizeof(seq));
+		if (rc != 0) {
+			break;
+		}
+
+		records++;
+		bytes += record.size;
+	}
+
+	ns = bench_elapsed_ns(start);
+	if (rc != -ENOENT) {
+		bench_error(be->name, "iterate", rc);
+		return rc;
+	}
+
+	bench_report(be->name, "iterate", fill, 0U, records, bytes, ns);
+	return 0;
+}
+
+static void bench_store(const struct bench_backend *be)
+{
+	const struct storage_area_store *store = be->store;
+	/* one sector is kept free of live records to leave room for moves */
+	const size_t sectors = store->sector_cnt - store->spare_sectors - 1U;
+	uint32_t per_sector;
+	int rc;
+
+	rc = bench_store_sector_records(store, &per_sector);
+	if (rc != 0) {
+		bench_error(be->name, "store", rc);
+		return;
+	}
+
+	for (size_t i = 0U; i < ARRAY_SIZE(bench_fills); i++) {
+		const uint32_t fill = bench_fills[i];
+
+		rc = storage_area_store_wipe(store);
+		if (rc == 0) {
+			rc = storage_area_store_mount(store, &bench_compact_cb);
+		}
+
+		if (rc != 0) {
+			bench_error(be->name, "store", rc);
+			return;
+		}
+
+		/* write the store around twice to reach steady state */
+		bench_store_reset(CLAMP((fill * per_sector * sectors) / 100U,
+					1U, BENCH_MAX_KEYS));
+		rc = bench_store_append(be, fill,
+					2U * per_sector * store->sector_cnt);
+		if (rc == 0) {
+			rc = bench_store_mount(be, fill);
+		}
+
+		if (rc == 0) {
+			(void)bench_store_iterate(be, fill);
+		}
+
+		(void)storage_area_store_unmount(store);
+	}
+
+	(void)bench_store_mount_size(be, be->quarter);
+	(void)bench_store_mount_size(be, be->half);
+	(void)bench_store_mount_size(be, store);
+}
+
+#ifdef BENCH_SETTINGS
+static uint32_t bench_settings_cnt;
+
+static int bench_settings_set(const char *key, size_t len,
+			      settings_read_cb read_cb, void *cb_arg)
+{
+	ARG_UNUSED(key);
+	ARG_UNUSED(len);
+	ARG_UNUSED(read_cb);
+	ARG_UNUSED(cb_arg);
+
+	bench_settings_cnt++;
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(bench, "bench", NULL, bench_settings_set, NULL,
+			       NULL);
+
+/*
+ * The settings store is not registered, its load is called directly: this is
+ * the work settings_load() does for the store.
+ */
+static void bench_settings(const char *backend,
+			   struct settings_storage_area_store *sstore)
+{
+	struct settings_store *cs = &sstore->store;
+	const struct settings_load_arg arg = {
+		.subtree = NULL,
+	};
+	char name[16];
+	uint64_t start, ns;
+	int rc;
+
+	(void)storage_area_store_unmount(sstore->sa_store);
+	rc = storage_area_store_wipe(sstore->sa_store);
+	for (uint32_t i = 0U; (rc == 0) && (i < BENCH_SETTINGS_WRITES); i++) {
+		for (int j = 0; (rc == 0) && (j < BENCH_SETTINGS_KEYS); j++) {
+			snprintf(name, sizeof(name), "bench/val%d", j);
+			rc = cs->cs_itf->csi_save(cs, name, (const char *)&i,
+						  sizeof(i));
+		}
+	}
+
+	if (rc != 0) {
+		bench_error(backend, "settings_load", rc);
+		return;
+	}
+
+	start = bench_start();
+	for (int i = 0; (rc == 0) && (i < BENCH_SETTINGS_LOADS); i++) {
+		bench_settings_cnt = 0U;
+		rc = cs->cs_itf->csi_load(cs, &arg);
+		if ((rc == 0) && (bench_settings_cnt != BENCH_SETTINGS_KEYS)) {
+			rc = -EIO;
+		}
+	}
+
+	ns = bench_elapsed_ns(start);
+	(void)storage_area_store_unmount(sstore->sa_store);
+	if (rc != 0) {
+		bench_error(backend, "settings_load", rc);
+		return;
+	}
+
+	bench_report(backend, "settings_load", BENCH_SETTINGS_KEYS, 0U,
+		     BENCH_SETTINGS_LOADS,
+		     BENCH_SETTINGS_LOADS * BENCH_SETTINGS_KEYS *
+			     BENCH_SETTINGS_WRITES,
+		     ns);
+}
+#endif /* BENCH_SETTINGS */
+
+int main(void)
+{
+	for (size_t i = 0U; i < sizeof(bench_buf); i++) {
+		bench_buf[i] = (uint8_t)i;
+	}
+
+	printk("BENCH,backend,test,param,iovcnt,ops,bytes,us,ops/s,bytes/s\n");
+	for (size_t i = 0U; i < ARRAY_SIZE(backends); i++) {
+		bench_area(&backends[i]);
+		bench_store(&backends[i]);
+	}
+
+#ifdef BENCH_SETTINGS
+	bench_settings("flash", get_settings_storage_area_store(flash_settings));
+#ifdef CONFIG_STORAGE_AREA_RCACHE
+	bench_settings("flash_rcache",
+		       get_settings_storage_area_store(flash_rcache_settings));
+#endif /* CONFIG_STORAGE_AREA_RCACHE */
+#endif /* BENCH_SETTINGS */
+
+	if (bench_errors != 0) {
+		printk("PROJECT EXECUTION FAILED\n");
+		return -EIO;
+	}
+
+	printk("PROJECT EXECUTION SUCCESSFUL\n");
+	return 0;
+}
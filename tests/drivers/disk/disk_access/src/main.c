@@ -13,6 +13,9 @@
 #include <zephyr/ztest.h>
 #include <zephyr/storage/disk_access.h>
 #include <zephyr/device.h>
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+#include <zephyr/drivers/disk/eepromdisk.h>
+#endif
 
 #if defined(CONFIG_DISK_DRIVER_SDMMC)
 #define DISK_NAME CONFIG_SDMMC_VOLUME_NAME
@@ -230,6 +233,53 @@ ZTEST(disk_driver, test_write)
 	}
 }
 
+#ifdef CONFIG_DISK_DRIVER_EEPROM_TRIM
+/* Trim sectors and verify they read as erased until written again
+ * WARNING: this test is destructive- it will overwrite data on the disk!
+ */
+ZTEST(disk_driver, test_trim)
+{
+	struct eeprom_disk_trim trim = {
+		.sector = 1,
+		.count = SECTOR_COUNT1 - 2,
+	};
+	uint8_t *wbuf = scratch_buf[0];
+	uint8_t *rbuf = scratch_buf[1];
+	const uint32_t ssize = disk_sector_size;
+	int rc, i;
+
+	for (i = 0; i < SECTOR_COUNT1 * ssize; i++) {
+		wbuf[i] = i & 0x7f;
+	}
+
+	rc = disk_access_write(disk_pdrv, wbuf, 0, SECTOR_COUNT1);
+	zassert_equal(rc, 0, "Failed to write to disk");
+	rc = disk_access_ioctl(disk_pdrv, EEPROM_DISK_IOCTL_CTRL_TRIM, &trim);
+	zassert_equal(rc, 0, "Disk ioctl trim failed");
+
+	/* Trimmed sectors read as erased, the sectors around them are kept */
+	rc = read_sector(rbuf, 0, SECTOR_COUNT1);
+	zassert_equal(rc, 0, "Failed to read from disk");
+	zassert_mem_equal(rbuf, wbuf, ssize, "First sector was changed");
+	for (i = ssize; i < (SECTOR_COUNT1 - 1) * ssize; i++) {
+		zassert_equal(rbuf[i], 0xff, "Trimmed sector is not erased");
+	}
+	zassert_mem_equal(rbuf + (SECTOR_COUNT1 - 1) * ssize,
+			  wbuf + (SECTOR_COUNT1 - 1) * ssize, ssize,
+			  "Last sector was changed");
+
+	/* A written sector is no longer trimmed */
+	rc = write_sector_checked(wbuf, rbuf, 2, 1);
+	zassert_equal(rc, 0, "Failed to write to trimmed sector");
+
+	/* Trims outside the disk are rejected */
+	trim.sector = disk_sector_count - 1;
+	trim.count = 2;
+	rc = disk_access_ioctl(disk_pdrv, EEPROM_DISK_IOCTL_CTRL_TRIM, &trim);
+	zassert_not_equal(rc, 0, "Disk should fail to trim out of bounds");
+}
+#endif
+
 static void *disk_driver_setup(void)
 {
 	test_setup();
@@ -21,15 +21,35 @@ LOG_MODULE_REGISTER(sas_test);
 #define FLASH_AREA_OFFSET	DT_REG_ADDR(FLASH_AREA_NODE)
 #define FLASH_AREA_DEVICE							\
 	DEVICE_DT_GET(DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE))
+#ifdef CONFIG_FLASH_SIMULATOR
+/* the flash simulator is not memory mapped */
+#define FLASH_AREA_XIP		STORAGE_AREA_FLASH_NO_XIP
+#else
 #define FLASH_AREA_XIP		FLASH_AREA_OFFSET +				\
 	DT_REG_ADDR(DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE))
+#endif /* CONFIG_FLASH_SIMULATOR */
 #define AREA_SIZE		DT_REG_SIZE(FLASH_AREA_NODE)
 #define AREA_ERASE_SIZE		4096
 #define AREA_WRITE_SIZE		8
+#define AREA_PROPS		(STORAGE_AREA_PROP_LOVRWRITE |			\
+				 STORAGE_AREA_PROP_AUTOERASE)
 
+#ifdef CONFIG_STORAGE_AREA_RCACHE
+#include <zephyr/storage/storage_area/storage_area_rcache.h>
+#define RCACHE_LINE_SIZE	64
+#define RCACHE_LINE_CNT		8
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	AREA_PROPS);
+STORAGE_AREA_RCACHE_RW_DEFINE(test, GET_STORAGE_AREA(flash), RCACHE_LINE_SIZE,
+	RCACHE_LINE_CNT, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	AREA_PROPS);
+#else
 STORAGE_AREA_FLASH_RW_DEFINE(test, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
 	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
-	STORAGE_AREA_PROP_LOVRWRITE | STORAGE_AREA_PROP_AUTOERASE);
+	AREA_PROPS);
+#endif /* CONFIG_STORAGE_AREA_RCACHE */
 #endif /* CONFIG_STORAGE_AREA_FLASH */
 
 const char cookie[]="!NVS";
@@ -177,6 +197,212 @@ ZTEST_USER(settings_storage_area_store_api, test_store)
 	zassert_equal(set_cnt, 1U, "loaded wrong settings count %d", set_cnt);
 }
 
+#ifdef CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX
+/* get the newest valid record of name by walking the store */
+static bool index_newest_record(const struct storage_area_store *sa_store,
+				const char *name,
+				struct storage_area_record *newest)
+{
+	const size_t nsz = strlen(name);
+	struct storage_area_record record = {
+		.store = NULL,
+	};
+	bool found = false;
+
+	while (storage_area_record_next(sa_store, &record) == 0) {
+		char rname[16];
+		uint8_t rnsz;
+
+		if ((storage_area_record_read(&record, 0U, &rnsz,
+					      sizeof(rnsz)) != 0) ||
+		    (rnsz != nsz) ||
+		    (storage_area_record_read(&record, 1U, rname, nsz) != 0) ||
+		    (memcmp(rname, name, nsz) != 0) ||
+		    (!storage_area_record_valid(&record))) {
+			continue;
+		}
+
+		*newest = record;
+		found = true;
+	}
+
+	return found;
+}
+
+static size_t index_entries(const struct settings_sas_index *index)
+{
+	size_t cnt = 0U;
+
+	for (size_t i = 0U; i < ARRAY_SIZE(index->entry); i++) {
+		if (index->entry[i].hash != 0U) {
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+/* check that the index has an entry for the newest record of name */
+static bool index_has(const struct settings_storage_area_store *sstore,
+		      const char *name)
+{
+	const struct settings_sas_index *index = &sstore->index;
+	struct storage_area_record newest;
+
+	if (!index_newest_record(sstore->sa_store, name, &newest)) {
+		return false;
+	}
+
+	for (size_t i = 0U; i < ARRAY_SIZE(index->entry); i++) {
+		const struct settings_sas_index_entry *entry =
+			&index->entry[i];
+
+		if ((entry->hash != 0U) && (entry->sector == newest.sector) &&
+		    (entry->loc == newest.loc) &&
+		    (entry->size == newest.size)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * The index suite starts each test from an empty, unmounted store. The store
+ * is not registered with the settings subsystem, it is loaded and saved to
+ * through its interface.
+ */
+static int index_load(struct settings_store *store)
+{
+	const struct settings_load_arg arg = {
+		.subtree = NULL,
+	};
+
+	return store->cs_itf->csi_load(store, &arg);
+}
+
+static int index_save(struct settings_store *store, const char *name,
+		      const void *value, size_t len)
+{
+	return store->cs_itf->csi_save(store, name, value, len);
+}
+
+static void settings_storage_area_store_index_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+	const struct storage_area *area = GET_STORAGE_AREA(test);
+	int rc;
+
+	rc = storage_area_store_unmount(GET_STORAGE_AREA_STORE(test));
+	zassert_equal(rc, 0, "unmount returned [%d]", rc);
+	rc = storage_area_erase(area, 0, area->erase_blocks);
+	zassert_equal(rc, 0, "erase returned [%d]", rc);
+}
+
+static void settings_storage_area_store_index_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)storage_area_store_unmount(GET_STORAGE_AREA_STORE(test));
+}
+
+ZTEST_USER(settings_storage_area_store_index, test_index)
+{
+	struct settings_store *store =
+		get_settings_storage_area_store_settings_store(test);
+	struct settings_storage_area_store *sstore =
+		CONTAINER_OF(store, struct settings_storage_area_store, store);
+	const struct settings_sas_index *index = &sstore->index;
+	const struct storage_area_store *sa_store = sstore->sa_store;
+	uint32_t val = 0U;
+	uint32_t wrapcnt;
+	int rc;
+
+	rc = index_load(store);
+	zassert_equal(rc, 0, "load returned [%d]", rc);
+
+	rc = index_save(store, "data/a", &val, sizeof(val));
+	zassert_equal(rc, 0, "save one returned [%d]", rc);
+	rc = index_save(store, "data/b", &val, sizeof(val));
+	zassert_equal(rc, 0, "save one returned [%d]", rc);
+	rc = index_save(store, "data/k", &val, sizeof(val));
+	zassert_equal(rc, 0, "save one returned [%d]", rc);
+	zassert_true(index->ready, "index not ready");
+	zassert_equal(index_entries(index), 3U, "wrong index entry count");
+	zassert_true(index_has(sstore, "data/a"), "data/a not indexed");
+	zassert_true(index_has(sstore, "data/b"), "data/b not indexed");
+
+	/* an overwrite points the entry to the new record */
+	val++;
+	rc = index_save(store, "data/a", &val, sizeof(val));
+	zassert_equal(rc, 0, "save one returned [%d]", rc);
+	zassert_equal(index_entries(index), 3U, "wrong index entry count");
+	zassert_true(index_has(sstore, "data/a"), "data/a not updated");
+
+	/* a delete stays indexed until compaction drops it */
+	rc = index_save(store, "data/b", NULL, 0U);
+	zassert_equal(rc, 0, "delete returned [%d]", rc);
+	zassert_equal(index_entries(index), 3U, "wrong index entry count");
+	zassert_true(index_has(sstore, "data/b"), "delete not indexed");
+
+	/* wrap the store twice: data/k is moved, the delete is dropped */
+	wrapcnt = sa_store->data->wrapcnt;
+	while (sa_store->data->wrapcnt < (wrapcnt + 2U)) {
+		val++;
+		rc = index_save(store, "data/a", &val, sizeof(val));
+		zassert_equal(rc, 0, "save one returned [%d]", rc);
+	}
+
+	zassert_true(index->ready, "index dropped by compaction");
+	zassert_equal(index_entries(index), 2U, "deleted entry not dropped");
+	zassert_true(index_has(sstore, "data/a"), "data/a not indexed");
+	zassert_true(index_has(sstore, "data/k"), "data/k not moved");
+
+	set_cnt = 0U;
+	rc = index_load(store);
+	zassert_equal(rc, 0, "load returned [%d]", rc);
+	zassert_equal(set_cnt, 2U, "loaded wrong settings count");
+
+	/* a record added while unmounted is indexed on remount */
+	const uint8_t nsz = strlen("data/c");
+	const struct storage_area_iovec wr[] = {
+		{
+			.data = (void *)&nsz,
+			.len = sizeof(nsz),
+		}, {
+			.data = (void *)"data/c",
+			.len = nsz,
+		}, {
+			.data = (void *)&val,
+			.len = sizeof(val),
+		},
+	};
+
+	rc = storage_area_store_unmount(sa_store);
+	zassert_equal(rc, 0, "unmount returned [%d]", rc);
+	rc = storage_area_store_mount(sa_store, NULL);
+	zassert_equal(rc, 0, "mount returned [%d]", rc);
+	rc = storage_area_store_writev(sa_store, wr, ARRAY_SIZE(wr));
+	zassert_equal(rc, 0, "write returned [%d]", rc);
+	rc = storage_area_store_unmount(sa_store);
+	zassert_equal(rc, 0, "unmount returned [%d]", rc);
+
+	set_cnt = 0U;
+	rc = index_load(store);
+	zassert_equal(rc, 0, "load returned [%d]", rc);
+	zassert_equal(set_cnt, 3U, "loaded wrong settings count");
+	zassert_true(index->ready, "index not rebuilt");
+	zassert_equal(index_entries(index), 3U, "wrong index entry count");
+	zassert_true(index_has(sstore, "data/a"), "data/a not indexed");
+	zassert_true(index_has(sstore, "data/k"), "data/k not indexed");
+	zassert_true(index_has(sstore, "data/c"), "data/c not indexed");
+}
+
+ZTEST_SUITE(settings_storage_area_store_index, NULL, NULL,
+	    settings_storage_area_store_index_before,
+	    settings_storage_area_store_index_after, NULL);
+#endif /* CONFIG_SETTINGS_STORAGE_AREA_STORE_INDEX */
+
 ZTEST_SUITE(settings_storage_area_store_api, NULL,
 	    settings_storage_area_store_api_setup,
 	    settings_storage_area_store_api_before, NULL, NULL);
\ No newline at end of file
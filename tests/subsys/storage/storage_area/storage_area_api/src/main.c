@@ -20,15 +20,173 @@ LOG_MODULE_REGISTER(sa_api_test);
 #define FLASH_AREA_OFFSET	DT_REG_ADDR(FLASH_AREA_NODE)
 #define FLASH_AREA_DEVICE							\
 	DEVICE_DT_GET(DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE))
+#ifdef CONFIG_FLASH_SIMULATOR
+/* the flash simulator is not memory mapped */
+#define FLASH_AREA_XIP		STORAGE_AREA_FLASH_NO_XIP
+#else
 #define FLASH_AREA_XIP		FLASH_AREA_OFFSET +				\
 	DT_REG_ADDR(DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE))
+#endif /* CONFIG_FLASH_SIMULATOR */
+#ifdef CONFIG_STORAGE_AREA_MIRROR
+/* each half of the partition is a replica */
+#define AREA_SIZE		(DT_REG_SIZE(FLASH_AREA_NODE) / 2)
+#else
 #define AREA_SIZE		DT_REG_SIZE(FLASH_AREA_NODE)
+#endif /* CONFIG_STORAGE_AREA_MIRROR */
+
+#ifdef CONFIG_STORAGE_AREA_STRIPE
+/* a stripe erase block is a flash page on each half of the partition */
+#define AREA_ERASE_SIZE		8192
+#else
 #define AREA_ERASE_SIZE		4096
+#endif /* CONFIG_STORAGE_AREA_STRIPE */
 #define AREA_WRITE_SIZE		512
 
+#ifdef CONFIG_STORAGE_AREA_RCACHE
+#include <zephyr/storage/storage_area/storage_area_rcache.h>
+#define RCACHE_LINE_SIZE	64
+#define RCACHE_LINE_CNT		4
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	STORAGE_AREA_PROP_LOVRWRITE);
+STORAGE_AREA_RCACHE_RW_DEFINE(test, GET_STORAGE_AREA(flash), RCACHE_LINE_SIZE,
+	RCACHE_LINE_CNT, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	STORAGE_AREA_PROP_LOVRWRITE);
+#elif defined(CONFIG_STORAGE_AREA_MIRROR)
+#include <zephyr/storage/storage_area/storage_area_mirror.h>
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash0, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	STORAGE_AREA_PROP_LOVRWRITE);
+/* the second replica is memory mapped after the first (if mapped) */
+#define FLASH_AREA_XIP1							\
+	((FLASH_AREA_XIP == STORAGE_AREA_FLASH_NO_XIP) ?			\
+	 STORAGE_AREA_FLASH_NO_XIP : (FLASH_AREA_XIP + AREA_SIZE))
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash1, FLASH_AREA_DEVICE,
+	FLASH_AREA_OFFSET + AREA_SIZE, FLASH_AREA_XIP1,
+	AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	STORAGE_AREA_PROP_LOVRWRITE);
+
+/* the mirror replicas count their reads and fail on request */
+struct mirror_replica {
+	const struct storage_area area;
+	const struct storage_area *backend;
+	size_t reads;
+	bool fail;
+	bool wfail;
+};
+
+static int mirror_replica_readv(const struct storage_area *area,
+				sa_off_t offset,
+				const struct storage_area_iovec *iovec,
+				size_t iovcnt)
+{
+	struct mirror_replica *replica =
+		CONTAINER_OF(area, struct mirror_replica, area);
+
+	replica->reads++;
+	if (replica->fail) {
+		return -EIO;
+	}
+
+	return storage_area_readv(replica->backend, offset, iovec, iovcnt);
+}
+
+static int mirror_replica_writev(const struct storage_area *area,
+				 sa_off_t offset,
+				 const struct storage_area_iovec *iovec,
+				 size_t iovcnt)
+{
+	struct mirror_replica *replica =
+		CONTAINER_OF(area, struct mirror_replica, area);
+
+	if (replica->wfail) {
+		return -EIO;
+	}
+
+	return storage_area_writev(replica->backend, offset, iovec, iovcnt);
+}
+
+static int mirror_replica_erase(const struct storage_area *area, size_t sblk,
+				size_t bcnt)
+{
+	struct mirror_replica *replica =
+		CONTAINER_OF(area, struct mirror_replica, area);
+
+	return storage_area_erase(replica->backend, sblk, bcnt);
+}
+
+static int mirror_replica_blank_check(const struct storage_area *area,
+				      sa_off_t offset, size_t len)
+{
+	struct mirror_replica *replica =
+		CONTAINER_OF(area, struct mirror_replica, area);
+
+	if (replica->fail) {
+		return -EIO;
+	}
+
+	return storage_area_blank_check(replica->backend, offset, len);
+}
+
+static int mirror_replica_ioctl(const struct storage_area *area,
+				enum storage_area_ioctl_cmd cmd, void *data)
+{
+	struct mirror_replica *replica =
+		CONTAINER_OF(area, struct mirror_replica, area);
+
+	return storage_area_ioctl(replica->backend, cmd, data);
+}
+
+static const struct storage_area_api mirror_replica_api = {
+	.readv = mirror_replica_readv,
+	.writev = mirror_replica_writev,
+	.erase = mirror_replica_erase,
+	.blank_check = mirror_replica_blank_check,
+	.ioctl = mirror_replica_ioctl,
+};
+
+#define MIRROR_REPLICA(_backend)                                                \
+	{                                                                       \
+		.area = {                                                       \
+			.api = &mirror_replica_api,                             \
+			.write_size = AREA_WRITE_SIZE,                          \
+			.erase_size = AREA_ERASE_SIZE,                          \
+			.erase_blocks = AREA_SIZE / AREA_ERASE_SIZE,            \
+			.props = STORAGE_AREA_PROP_LOVRWRITE,                   \
+		},                                                              \
+		.backend = _backend,                                            \
+	}
+
+static struct mirror_replica mirror_replica[] = {
+	MIRROR_REPLICA(GET_STORAGE_AREA(flash0)),
+	MIRROR_REPLICA(GET_STORAGE_AREA(flash1)),
+};
+
+STORAGE_AREA_MIRROR_RW_DEFINE(test, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE,
+	&mirror_replica[0].area, &mirror_replica[1].area);
+#elif defined(CONFIG_STORAGE_AREA_STRIPE)
+#include <zephyr/storage/storage_area/storage_area_stripe.h>
+#define STRIPE_UNIT		1024
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash0, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	STORAGE_AREA_FLASH_NO_XIP, AREA_WRITE_SIZE, (AREA_ERASE_SIZE / 2),
+	(AREA_SIZE / 2), STORAGE_AREA_PROP_LOVRWRITE);
+STORAGE_AREA_FLASH_RW_DEFINE(flash1, FLASH_AREA_DEVICE,
+	FLASH_AREA_OFFSET + (AREA_SIZE / 2), STORAGE_AREA_FLASH_NO_XIP,
+	AREA_WRITE_SIZE, (AREA_ERASE_SIZE / 2), (AREA_SIZE / 2),
+	STORAGE_AREA_PROP_LOVRWRITE);
+STORAGE_AREA_STRIPE_RW_DEFINE(test, STRIPE_UNIT, AREA_WRITE_SIZE,
+	AREA_ERASE_SIZE, AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE,
+	GET_STORAGE_AREA(flash0), GET_STORAGE_AREA(flash1));
+#else
 STORAGE_AREA_FLASH_RW_DEFINE(test, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
 	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
 	STORAGE_AREA_PROP_LOVRWRITE);
+#endif /* CONFIG_STORAGE_AREA_RCACHE */
 #endif /* CONFIG_STORAGE_AREA_FLASH */
 
 #ifdef CONFIG_STORAGE_AREA_EEPROM
@@ -39,8 +197,20 @@ STORAGE_AREA_FLASH_RW_DEFINE(test, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
 #define AREA_ERASE_SIZE		1024
 #define AREA_WRITE_SIZE		4
 
+#ifdef CONFIG_STORAGE_AREA_CACHE
+#include <zephyr/storage/storage_area/storage_area_cache.h>
+#define CACHE_LINE_SIZE		64
+#define CACHE_LINE_CNT		4
+
+STORAGE_AREA_EEPROM_RW_DEFINE(eeprom, EEPROM_AREA_DEVICE, 0U, AREA_WRITE_SIZE,
+	AREA_ERASE_SIZE, AREA_SIZE, 0);
+STORAGE_AREA_CACHE_RW_DEFINE(test, GET_STORAGE_AREA(eeprom), CACHE_LINE_SIZE,
+	CACHE_LINE_CNT, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	STORAGE_AREA_PROP_FOVRWRITE);
+#else
 STORAGE_AREA_EEPROM_RW_DEFINE(test, EEPROM_AREA_DEVICE, 0U, AREA_WRITE_SIZE,
 	AREA_ERASE_SIZE, AREA_SIZE, 0);
+#endif /* CONFIG_STORAGE_AREA_CACHE */
 #endif /* CONFIG_STORAGE_AREA_EEPROM */
 
 #ifdef CONFIG_STORAGE_AREA_RAM
@@ -68,6 +238,34 @@ STORAGE_AREA_DISK_RW_DEFINE(test, DISK_NAME, DISK_SCNT / 2, DISK_SSIZE,
 	AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE, 0);
 #endif /* CONFIG_STORAGE_AREA_DISK */
 
+#ifdef CONFIG_STORAGE_AREA_FILE
+#include <zephyr/storage/storage_area/storage_area_file.h>
+/* a temporary file: nothing is left behind in the working directory */
+#define FILE_PATH	NULL
+#define AREA_SIZE	(64 * 1024)
+#define AREA_ERASE_SIZE	4096
+#define AREA_WRITE_SIZE	8
+
+STORAGE_AREA_FILE_RW_DEFINE(test, FILE_PATH, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE);
+#endif /* CONFIG_STORAGE_AREA_FILE */
+
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+#include <zephyr/storage/storage_area/storage_area_nor_sim.h>
+#define AREA_SIZE	(64 * 1024)
+#define AREA_ERASE_SIZE	4096
+#define AREA_WRITE_SIZE	8
+#define AREA_PROGRAM_NS	100
+#define AREA_ERASE_US	1000
+
+STORAGE_AREA_NOR_SIM_RW_DEFINE(test, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE, AREA_PROGRAM_NS, AREA_ERASE_US);
+STORAGE_AREA_NOR_SIM_RW_DEFINE(nor_zero, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	2 * AREA_ERASE_SIZE, STORAGE_AREA_PROP_ZEROERASE |
+	STORAGE_AREA_PROP_LOVRWRITE | STORAGE_AREA_PROP_AUTOERASE,
+	AREA_PROGRAM_NS, AREA_ERASE_US);
+#endif /* CONFIG_STORAGE_AREA_NOR_SIM */
+
 static void *storage_area_api_setup(void)
 {
 	return NULL;
@@ -177,6 +375,119 @@ ZTEST_USER(storage_area_api, test_read_write_blocks)
 	zassert_mem_equal(rd, wr, sizeof(wr), 0, "data mismatch");
 }
 
+ZTEST_USER(storage_area_api, test_read_unaligned)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const size_t ws = STORAGE_AREA_WRITESIZE(sa);
+	const size_t es = STORAGE_AREA_ERASESIZE(sa);
+	const size_t bcnt = DIV_ROUND_UP(3U * ws, es);
+	uint8_t wr[3U * STORAGE_AREA_WRITESIZE(sa)];
+	uint8_t rd[3U * STORAGE_AREA_WRITESIZE(sa)];
+	uint8_t hdr[3];
+	struct storage_area_iovec rdvec[] = {
+		{
+			.data = (void *)&hdr,
+			.len = sizeof(hdr),
+		},
+		{
+			.data = (void *)&rd,
+			.len = 2U * ws,
+		},
+	};
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)i;
+	}
+
+	rc = storage_area_erase(sa, 0U, bcnt);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	/* a small read followed by a read over write block boundaries */
+	rc = storage_area_readv(sa, 1U, rdvec, ARRAY_SIZE(rdvec));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(hdr, wr + 1U, sizeof(hdr), "data mismatch");
+	zassert_mem_equal(rd, wr + 1U + sizeof(hdr), 2U * ws, "data mismatch");
+
+	/* a read after a rewrite returns the new data */
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)~i;
+	}
+
+	rc = storage_area_erase(sa, 0U, bcnt);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	rc = storage_area_read(sa, ws + 1U, rd, ws);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr + ws + 1U, ws, "data mismatch");
+}
+
+#define GATHER_VECCNT 16
+
+/* split len bytes of data in elements of the sizes, the last one is the rest */
+static size_t gather_iovec(struct storage_area_iovec *vec, uint8_t *data,
+			   size_t len, const size_t *sizes, size_t scnt)
+{
+	size_t cnt = 0U;
+
+	while ((len != 0U) && (cnt < GATHER_VECCNT)) {
+		size_t elen = MIN(len, sizes[cnt % scnt]);
+
+		if (cnt == (GATHER_VECCNT - 1U)) {
+			elen = len;
+		}
+
+		vec[cnt].data = data;
+		vec[cnt].len = elen;
+		data += elen;
+		len -= elen;
+		cnt++;
+	}
+
+	return cnt;
+}
+
+ZTEST_USER(storage_area_api, test_read_write_gather)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const size_t ws = STORAGE_AREA_WRITESIZE(sa);
+	const size_t bcnt = DIV_ROUND_UP(2U * ws, STORAGE_AREA_ERASESIZE(sa));
+	/* small elements around elements that exceed the gather buffer */
+	const size_t wrsizes[] = {1, 3, 7, CONFIG_STORAGE_AREA_WRITE_BUFSIZE + 1,
+				  2, 5};
+	const size_t rdsizes[] = {2, 5, 1, CONFIG_STORAGE_AREA_WRITE_BUFSIZE - 1,
+				  6, 3};
+	static struct storage_area_iovec wrvec[GATHER_VECCNT];
+	static struct storage_area_iovec rdvec[GATHER_VECCNT];
+	uint8_t wr[2U * STORAGE_AREA_WRITESIZE(sa)];
+	uint8_t rd[2U * STORAGE_AREA_WRITESIZE(sa)];
+	size_t wrcnt, rdcnt;
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)(i * 7U);
+	}
+
+	memset(rd, 0, sizeof(rd));
+	wrcnt = gather_iovec(wrvec, wr, sizeof(wr), wrsizes,
+			     ARRAY_SIZE(wrsizes));
+	rdcnt = gather_iovec(rdvec, rd, sizeof(rd), rdsizes,
+			     ARRAY_SIZE(rdsizes));
+
+	rc = storage_area_erase(sa, 0U, bcnt);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_writev(sa, 0U, wrvec, wrcnt);
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	rc = storage_area_readv(sa, 0U, rdvec, rdcnt);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr, sizeof(wr), "data mismatch");
+}
+
 ZTEST_USER(storage_area_api, test_ioctl)
 {
 	const struct storage_area *sa = GET_STORAGE_AREA(test);
@@ -184,13 +495,703 @@ ZTEST_USER(storage_area_api, test_ioctl)
 
 	int rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_XIPADDRESS, &xip);
 
+	/*
+	 * The flash simulator is not memory mapped (see FLASH_AREA_XIP): an
+	 * xip address would be dereferenced by map and blank check.
+	 */
 	if ((IS_ENABLED(CONFIG_STORAGE_AREA_DISK)) ||
-	    (IS_ENABLED(CONFIG_STORAGE_AREA_EEPROM))) {
+	    (IS_ENABLED(CONFIG_STORAGE_AREA_EEPROM)) ||
+	    (IS_ENABLED(CONFIG_STORAGE_AREA_STRIPE)) ||
+	    (IS_ENABLED(CONFIG_STORAGE_AREA_NOR_SIM)) ||
+	    (IS_ENABLED(CONFIG_FLASH_SIMULATOR))) {
 		zassert_equal(rc, -ENOTSUP, "xip returned invalid address");
 	} else {
 		zassert_ok(rc, "xip returned no address");
 	}
 }
 
+ZTEST_USER(storage_area_api, test_map)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	uint8_t wr[AREA_WRITE_SIZE];
+	uint8_t buf[AREA_WRITE_SIZE];
+	const void *ptr;
+	uintptr_t xip;
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)i;
+	}
+
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	rc = storage_area_map(sa, 0U, sizeof(wr), buf, &ptr);
+	zassert_ok(rc, "map returned [%d]", rc);
+	zassert_mem_equal(ptr, wr, sizeof(wr), "data mismatch");
+	rc = storage_area_unmap(sa, ptr);
+	zassert_ok(rc, "unmap returned [%d]", rc);
+
+	/* without a bounce buffer only memory addressable areas map */
+	rc = storage_area_map(sa, 0U, sizeof(wr), NULL, &ptr);
+	if (storage_area_ioctl(sa, STORAGE_AREA_IOCTL_XIPADDRESS, &xip) == 0) {
+		zassert_ok(rc, "map returned [%d]", rc);
+		zassert_equal_ptr(ptr, (const void *)xip, "map is not in place");
+		zassert_mem_equal(ptr, wr, sizeof(wr), "data mismatch");
+		rc = storage_area_unmap(sa, ptr);
+		zassert_ok(rc, "unmap returned [%d]", rc);
+	} else {
+		zassert_equal(rc, -ENOTSUP, "map without buffer succeeded");
+	}
+
+	rc = storage_area_map(sa, STORAGE_AREA_SIZE(sa), 1U, buf, &ptr);
+	zassert_equal(rc, -EINVAL, "map outside area succeeded");
+}
+
+ZTEST_USER(storage_area_api, test_blank_check)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const size_t ws = STORAGE_AREA_WRITESIZE(sa);
+	const size_t es = STORAGE_AREA_ERASESIZE(sa);
+	uint8_t wr[STORAGE_AREA_WRITESIZE(sa)];
+	int rc;
+
+	rc = storage_area_blank_check(sa, 0U, es);
+	zassert_ok(rc, "blank check returned [%d]", rc);
+
+	memset(wr, 'T', sizeof(wr));
+	rc = storage_area_write(sa, es - ws, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	rc = storage_area_blank_check(sa, 0U, es);
+	zassert_equal(rc, -ENOTEMPTY, "blank check returned [%d]", rc);
+
+	rc = storage_area_blank_check(sa, 0U, es - ws);
+	zassert_ok(rc, "blank check returned [%d]", rc);
+
+	rc = storage_area_blank_check(sa, 1U, es - 2U);
+	zassert_equal(rc, -ENOTEMPTY, "blank check returned [%d]", rc);
+
+	rc = storage_area_blank_check(sa, es - 1U, 1U);
+	zassert_equal(rc, -ENOTEMPTY, "blank check returned [%d]", rc);
+
+	rc = storage_area_blank_check(sa, STORAGE_AREA_SIZE(sa), 1U);
+	zassert_equal(rc, -EINVAL, "blank check returned [%d]", rc);
+}
+
+ZTEST_USER(storage_area_api, test_discard)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const size_t ws = STORAGE_AREA_WRITESIZE(sa);
+	const size_t es = STORAGE_AREA_ERASESIZE(sa);
+	const uint8_t erase_value = STORAGE_AREA_ERASEVALUE(sa);
+	uint8_t wr[STORAGE_AREA_WRITESIZE(sa)];
+	uint8_t rd[STORAGE_AREA_WRITESIZE(sa)];
+	int rc;
+
+	memset(wr, 'T', sizeof(wr));
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+	rc = storage_area_write(sa, es - ws, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	rc = storage_area_discard(sa, 0U, 1U);
+	zassert_ok(rc, "discard returned [%d]", rc);
+	rc = storage_area_blank_check(sa, 0U, es);
+	zassert_ok(rc, "blank check returned [%d]", rc);
+
+	/* a write leaves the data before it erased */
+	rc = storage_area_write(sa, 2U * ws, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+	rc = storage_area_blank_check(sa, 0U, 2U * ws);
+	zassert_ok(rc, "blank check returned [%d]", rc);
+	rc = storage_area_blank_check(sa, 3U * ws, es - 3U * ws);
+	zassert_ok(rc, "blank check returned [%d]", rc);
+	rc = storage_area_read(sa, 2U * ws, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr, sizeof(wr), "data mismatch");
+
+	rc = storage_area_read(sa, es - ws, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(rd[0], erase_value, "discarded data returned");
+
+	rc = storage_area_discard(sa, STORAGE_AREA_SIZE(sa) / es, 1U);
+	zassert_equal(rc, -EINVAL, "discard returned [%d]", rc);
+}
+
+#ifdef CONFIG_STORAGE_AREA_CACHE
+ZTEST_USER(storage_area_api, test_cache)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const struct storage_area *backend = GET_STORAGE_AREA(eeprom);
+	uint8_t wr[2 * CACHE_LINE_SIZE];
+	uint8_t rd[2 * CACHE_LINE_SIZE];
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)i;
+	}
+
+	/* adjacent writes that cross a line boundary */
+	rc = storage_area_write(sa, 0U, wr, CACHE_LINE_SIZE / 2);
+	zassert_ok(rc, "prog returned [%d]", rc);
+	rc = storage_area_write(sa, CACHE_LINE_SIZE / 2, wr + CACHE_LINE_SIZE / 2,
+				sizeof(wr) - CACHE_LINE_SIZE / 2);
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	rc = storage_area_blank_check(backend, 0U, sizeof(wr));
+	zassert_ok(rc, "data was written to the backend");
+
+	memset(rd, 0, sizeof(rd));
+	rc = storage_area_read(sa, AREA_WRITE_SIZE, rd, sizeof(rd) - AREA_WRITE_SIZE);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr + AREA_WRITE_SIZE, sizeof(rd) - AREA_WRITE_SIZE,
+			  "cached data mismatch");
+
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_FLUSH, NULL);
+	zassert_ok(rc, "flush returned [%d]", rc);
+
+	memset(rd, 0, sizeof(rd));
+	rc = storage_area_read(backend, 0U, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr, sizeof(rd), "flushed data mismatch");
+
+	/* more lines than available: the oldest line is flushed */
+	for (size_t i = 0U; i <= CACHE_LINE_CNT; i++) {
+		rc = storage_area_write(sa, (2U + i) * CACHE_LINE_SIZE, wr,
+					AREA_WRITE_SIZE);
+		zassert_ok(rc, "prog returned [%d]", rc);
+	}
+
+	rc = storage_area_blank_check(backend, 2U * CACHE_LINE_SIZE,
+				      AREA_WRITE_SIZE);
+	zassert_equal(rc, -ENOTEMPTY, "oldest line was not flushed");
+
+	/* erase drops the cached data */
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_FLUSH, NULL);
+	zassert_ok(rc, "flush returned [%d]", rc);
+	rc = storage_area_blank_check(backend, 0U, AREA_ERASE_SIZE);
+	zassert_ok(rc, "erased data was flushed");
+}
+#endif /* CONFIG_STORAGE_AREA_CACHE */
+
+#ifdef CONFIG_STORAGE_AREA_RCACHE
+static void storage_area_api_rcache_stats(struct storage_area_cache_stats *st)
+{
+	int rc = storage_area_ioctl(GET_STORAGE_AREA(test),
+				    STORAGE_AREA_IOCTL_CACHE_STATS, st);
+
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+}
+
+ZTEST_USER(storage_area_api, test_rcache)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	struct storage_area_cache_stats st0, st;
+	uint8_t wr[AREA_WRITE_SIZE];
+	uint8_t rd[AREA_WRITE_SIZE];
+	uint32_t hdr;
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)i;
+	}
+
+	/* a first read misses, reads of the same line hit */
+	storage_area_api_rcache_stats(&st0);
+	rc = storage_area_read(sa, 0U, &hdr, sizeof(hdr));
+	zassert_ok(rc, "read returned [%d]", rc);
+	rc = storage_area_read(sa, sizeof(hdr), &hdr, sizeof(hdr));
+	zassert_ok(rc, "read returned [%d]", rc);
+	storage_area_api_rcache_stats(&st);
+	zassert_equal(st.misses - st0.misses, 1U, "wrong miss count");
+	zassert_equal(st.hits - st0.hits, 1U, "wrong hit count");
+
+	/* a write invalidates the cached lines */
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+	memset(rd, 0, sizeof(rd));
+	rc = storage_area_read(sa, 0U, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr, sizeof(rd), "stale data after write");
+
+	/* an erase invalidates the cached lines */
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_read(sa, 0U, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_true(storage_area_mem_blank(rd, sizeof(rd),
+					    STORAGE_AREA_ERASEVALUE(sa)),
+		     "stale data after erase");
+}
+#endif /* CONFIG_STORAGE_AREA_RCACHE */
+
+#ifdef CONFIG_STORAGE_AREA_MIRROR
+ZTEST_USER(storage_area_api, test_mirror)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const struct storage_area *replica[] = {
+		GET_STORAGE_AREA(flash0),
+		GET_STORAGE_AREA(flash1),
+	};
+	uint8_t wr[AREA_WRITE_SIZE];
+	uint8_t rd[AREA_WRITE_SIZE];
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(wr); i++) {
+		wr[i] = (uint8_t)i;
+	}
+
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	/* the data is on each replica */
+	for (size_t i = 0U; i < ARRAY_SIZE(replica); i++) {
+		memset(rd, 0, sizeof(rd));
+		rc = storage_area_read(replica[i], 0U, rd, sizeof(rd));
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_mem_equal(rd, wr, sizeof(rd), "replica %zu differs", i);
+	}
+
+	/* reads are spread over the replicas */
+	for (size_t i = 0U; i < ARRAY_SIZE(replica); i++) {
+		memset(rd, 0, sizeof(rd));
+		rc = storage_area_read(sa, 0U, rd, sizeof(rd));
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_mem_equal(rd, wr, sizeof(rd), "data mismatch");
+	}
+
+	/* an erase is done on each replica */
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	for (size_t i = 0U; i < ARRAY_SIZE(replica); i++) {
+		rc = storage_area_blank_check(replica[i], 0U, AREA_ERASE_SIZE);
+		zassert_ok(rc, "replica %zu not erased", i);
+	}
+}
+
+static void storage_area_api_mirror_reads(const struct storage_area *sa,
+					  const uint8_t *wr, size_t len,
+					  size_t cnt)
+{
+	uint8_t rd[AREA_WRITE_SIZE];
+
+	for (size_t i = 0U; i < cnt; i++) {
+		int rc = storage_area_read(sa, 0U, rd, len);
+
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_mem_equal(rd, wr, len, "data mismatch");
+	}
+}
+
+ZTEST_USER(storage_area_api, test_mirror_failover)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	uint8_t wr[AREA_WRITE_SIZE];
+	uint8_t rd[AREA_WRITE_SIZE];
+	int rc;
+
+	memset(wr, 'M', sizeof(wr));
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	/* reads are spread over the replicas */
+	for (size_t i = 0U; i < ARRAY_SIZE(mirror_replica); i++) {
+		mirror_replica[i].reads = 0U;
+		mirror_replica[i].fail = false;
+	}
+
+	storage_area_api_mirror_reads(sa, wr, sizeof(wr), 4U);
+	zassert_equal(mirror_replica[0].reads, 2U, "reads not spread");
+	zassert_equal(mirror_replica[1].reads, 2U, "reads not spread");
+
+	/* reads on a failing replica are retried on the other replica */
+	mirror_replica[0].reads = 0U;
+	mirror_replica[1].reads = 0U;
+	mirror_replica[0].fail = true;
+	storage_area_api_mirror_reads(sa, wr, sizeof(wr), 4U);
+	zassert_equal(mirror_replica[0].reads, 2U, "failing replica not used");
+	zassert_equal(mirror_replica[1].reads, 4U, "read not retried");
+	rc = storage_area_blank_check(sa, 0U, sizeof(wr));
+	zassert_equal(rc, -ENOTEMPTY, "blank check returned [%d]", rc);
+
+	/* the read fails when all replicas fail */
+	mirror_replica[1].fail = true;
+	rc = storage_area_read(sa, 0U, rd, sizeof(rd));
+	zassert_equal(rc, -EIO, "read returned [%d]", rc);
+	rc = storage_area_blank_check(sa, 0U, sizeof(wr));
+	zassert_equal(rc, -EIO, "blank check returned [%d]", rc);
+
+	/* a replica that fails a write is no longer read */
+	uint32_t failed;
+
+	mirror_replica[0].fail = false;
+	mirror_replica[1].fail = false;
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	mirror_replica[0].wfail = true;
+	memset(wr, 'N', sizeof(wr));
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_equal(rc, -EIO, "prog returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_MIRROR_FAILED, &failed);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(failed, BIT(0), "failed replica not marked");
+
+	mirror_replica[0].reads = 0U;
+	mirror_replica[1].reads = 0U;
+	storage_area_api_mirror_reads(sa, wr, sizeof(wr), 4U);
+	zassert_equal(mirror_replica[0].reads, 0U, "failed replica used");
+	zassert_equal(mirror_replica[1].reads, 4U, "reads not done");
+
+	/* restored replicas are used again */
+	mirror_replica[0].wfail = false;
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_MIRROR_RESTORE, NULL);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_MIRROR_FAILED, &failed);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(failed, 0U, "failed replica not restored");
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+}
+#endif /* CONFIG_STORAGE_AREA_MIRROR */
+
+#ifdef CONFIG_STORAGE_AREA_STRIPE
+static uint8_t stripe_wr[2 * STRIPE_UNIT];
+static uint8_t stripe_rd[STRIPE_UNIT];
+
+ZTEST_USER(storage_area_api, test_stripe)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const struct storage_area *child0 = GET_STORAGE_AREA(flash0);
+	const struct storage_area *child1 = GET_STORAGE_AREA(flash1);
+	const size_t ws = AREA_WRITE_SIZE;
+	struct storage_area_iovec
+		rdvec[STORAGE_AREA_STRIPE_MAX_IOVCNT + 1];
+	int rc;
+
+	for (size_t i = 0U; i < sizeof(stripe_wr); i++) {
+		stripe_wr[i] = (uint8_t)(i ^ (i >> 8));
+	}
+
+	/* write the end of unit 0, unit 1 and the start of unit 2 */
+	rc = storage_area_write(sa, STRIPE_UNIT - ws, stripe_wr,
+				sizeof(stripe_wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	/* unit 0 and 2 are on child 0, one after the other */
+	rc = storage_area_read(child0, STRIPE_UNIT - ws, stripe_rd,
+			       sizeof(stripe_rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(stripe_rd, stripe_wr, ws, "unit 0 misplaced");
+	zassert_mem_equal(&stripe_rd[ws], &stripe_wr[ws + STRIPE_UNIT],
+			  STRIPE_UNIT - ws, "unit 2 misplaced");
+
+	/* unit 1 is at the start of child 1 */
+	rc = storage_area_read(child1, 0U, stripe_rd, sizeof(stripe_rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(stripe_rd, &stripe_wr[ws], STRIPE_UNIT,
+			  "unit 1 misplaced");
+
+	/* the stripe reads back what was written */
+	rc = storage_area_read(sa, STRIPE_UNIT, stripe_rd, sizeof(stripe_rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(stripe_rd, &stripe_wr[ws], STRIPE_UNIT,
+			  "data mismatch");
+
+	/* too many iovec elements */
+	for (size_t i = 0U; i < ARRAY_SIZE(rdvec); i++) {
+		rdvec[i].data = &stripe_rd[i];
+		rdvec[i].len = 1U;
+	}
+
+	rc = storage_area_readv(sa, 0U, rdvec, ARRAY_SIZE(rdvec));
+	zassert_equal(rc, -EINVAL, "read returned [%d]", rc);
+	rc = storage_area_readv(sa, 0U, rdvec, ARRAY_SIZE(rdvec) - 1U);
+	zassert_ok(rc, "read returned [%d]", rc);
+}
+#endif /* CONFIG_STORAGE_AREA_STRIPE */
+
+#ifdef CONFIG_STORAGE_AREA_ASYNC
+static K_SEM_DEFINE(async_running, 0, 1);
+static K_SEM_DEFINE(async_release, 0, 1);
+static K_SEM_DEFINE(async_done, 0, 1);
+static uint8_t async_rd[AREA_WRITE_SIZE];
+static struct storage_area_iovec async_rdvec = {
+	.data = async_rd,
+	.len = sizeof(async_rd),
+};
+static int async_runs;
+static int async_resubmit_rc;
+
+/*
+ * The first run is held until released, the second run resubmits the
+ * request from its callback.
+ */
+static void storage_area_api_async_cb(struct storage_area_async_req *req)
+{
+	async_runs++;
+	if (async_runs == 1) {
+		k_sem_give(&async_running);
+		(void)k_sem_take(&async_release, K_FOREVER);
+		return;
+	}
+
+	if (async_runs == 2) {
+		async_resubmit_rc = storage_area_readv_async(
+			req->area, 0U, &async_rdvec, 1U, req);
+		return;
+	}
+
+	k_sem_give(&async_done);
+}
+
+ZTEST(storage_area_api, test_async_busy)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	struct storage_area_async_req req;
+	int rc;
+
+	async_runs = 0;
+	async_resubmit_rc = -EIO;
+	rc = storage_area_async_init(&req, storage_area_api_async_cb);
+	zassert_ok(rc, "init returned [%d]", rc);
+	rc = storage_area_readv_async(sa, 0U, &async_rdvec, 1U, &req);
+	zassert_ok(rc, "read returned [%d]", rc);
+	rc = k_sem_take(&async_running, K_SECONDS(1));
+	zassert_ok(rc, "request did not run");
+
+	/* the request is done when its callback runs: it can be resubmitted */
+	zassert_ok(req.rc, "request returned [%d]", req.rc);
+	rc = storage_area_readv_async(sa, 0U, &async_rdvec, 1U, &req);
+	zassert_ok(rc, "read returned [%d]", rc);
+
+	/* the resubmitted request is queued */
+	rc = storage_area_readv_async(sa, 0U, &async_rdvec, 1U, &req);
+	zassert_equal(rc, -EBUSY, "read returned [%d]", rc);
+	rc = storage_area_erase_async(sa, 0U, 1U, &req);
+	zassert_equal(rc, -EBUSY, "erase returned [%d]", rc);
+
+	/* the callback itself can resubmit */
+	k_sem_give(&async_release);
+	rc = k_sem_take(&async_done, K_SECONDS(1));
+	zassert_ok(rc, "request was not resubmitted");
+	zassert_ok(async_resubmit_rc, "resubmit returned [%d]",
+		   async_resubmit_rc);
+	zassert_equal(async_runs, 3, "wrong number of runs");
+	rc = storage_area_async_wait(&req);
+	zassert_ok(rc, "request returned [%d]", rc);
+}
+#endif /* CONFIG_STORAGE_AREA_ASYNC */
+
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+static void
+storage_area_api_nor_sim_stats(struct storage_area_nor_sim_stats *st)
+{
+	int rc = storage_area_ioctl(GET_STORAGE_AREA(test),
+				    STORAGE_AREA_IOCTL_NOR_SIM_STATS, st);
+
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+}
+
+ZTEST_USER(storage_area_api, test_nor_sim)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	struct storage_area_nor_sim_stats st0, st;
+	struct storage_area_nor_sim_wear wear0 = {
+		.blk = 1U,
+	};
+	struct storage_area_nor_sim_wear wear = {
+		.blk = 1U,
+	};
+	uint8_t wr[2 * AREA_WRITE_SIZE];
+	uint8_t rd[2 * AREA_WRITE_SIZE];
+	int rc;
+
+	storage_area_api_nor_sim_stats(&st0);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_NOR_SIM_WEAR, &wear0);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+
+	/* an erase counts as wear and takes the erase time */
+	rc = storage_area_erase(sa, 1U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_NOR_SIM_WEAR, &wear);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(wear.erases, wear0.erases + 1U, "wrong erase count");
+
+	/* writes start at a write block */
+	memset(wr, 0xf0, sizeof(wr));
+	rc = storage_area_write(sa, AREA_ERASE_SIZE + AREA_WRITE_SIZE / 2, wr,
+				AREA_WRITE_SIZE);
+	zassert_equal(rc, -EINVAL, "unaligned write succeeded");
+
+	rc = storage_area_write(sa, AREA_ERASE_SIZE, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+
+	/* bits can not be set back to the erase value */
+	memset(wr, 0x0f, sizeof(wr));
+	rc = storage_area_write(sa, AREA_ERASE_SIZE, wr, sizeof(wr));
+	zassert_equal(rc, -EIO, "write changed erased bits");
+
+	/* limited overwrite: programs up to the limit clear bits */
+	memset(wr, 0xf0, sizeof(wr));
+	for (int i = 1; i < CONFIG_STORAGE_AREA_NOR_SIM_PROGRAM_LIMIT; i++) {
+		wr[0] &= (uint8_t)(wr[0] - 1U);
+		rc = storage_area_write(sa, AREA_ERASE_SIZE, wr,
+					AREA_WRITE_SIZE);
+		zassert_ok(rc, "prog returned [%d]", rc);
+	}
+
+	rc = storage_area_write(sa, AREA_ERASE_SIZE, wr, AREA_WRITE_SIZE);
+	zassert_equal(rc, -EIO, "write exceeded the program limit");
+
+	/* refused writes leave the data unchanged */
+	rc = storage_area_read(sa, AREA_ERASE_SIZE, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(rd[0], wr[0], "data mismatch");
+	zassert_equal(rd[AREA_WRITE_SIZE], 0xf0, "data mismatch");
+
+	storage_area_api_nor_sim_stats(&st);
+	zassert_equal(st.erases - st0.erases, 1U, "wrong erase count");
+	zassert_equal(st.writes - st0.writes,
+		      CONFIG_STORAGE_AREA_NOR_SIM_PROGRAM_LIMIT, "wrong writes");
+	zassert_equal(st.violations - st0.violations, 3U,
+		      "wrong violation count");
+	zassert_true(st.busy_us - st0.busy_us >= AREA_ERASE_US,
+		     "erase time not added");
+}
+
+ZTEST_USER(storage_area_api, test_nor_sim_zeroerase)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(nor_zero);
+	const sa_off_t off = AREA_ERASE_SIZE - AREA_WRITE_SIZE;
+	struct storage_area_nor_sim_wear wear0 = {
+		.blk = 1U,
+	};
+	struct storage_area_nor_sim_wear wear = {
+		.blk = 1U,
+	};
+	uint8_t wr[2 * AREA_WRITE_SIZE];
+	uint8_t rd[2 * AREA_WRITE_SIZE];
+	uint8_t erased[2 * AREA_WRITE_SIZE];
+	int rc;
+
+	zassert_equal(STORAGE_AREA_ERASEVALUE(sa) | 0x10, 0x10,
+		      "wrong erase value");
+	rc = storage_area_erase(sa, 0U, 2U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	memset(erased, 0x00, sizeof(erased));
+	rc = storage_area_read(sa, off, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, erased, sizeof(rd), "flash not erased to zero");
+
+	/* programming sets bits, block 1 is erased when it is written */
+	memset(wr, 0x0f, sizeof(wr));
+	rc = storage_area_write(sa, off, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_NOR_SIM_WEAR, &wear0);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+
+	/* bits can not be cleared, the refused write does not erase block 1 */
+	memset(wr, 0x0e, sizeof(wr));
+	rc = storage_area_write(sa, off, wr, sizeof(wr));
+	zassert_equal(rc, -EIO, "write cleared bits");
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_NOR_SIM_WEAR, &wear);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(wear.erases, wear0.erases, "refused write erased");
+	memset(wr, 0x0f, sizeof(wr));
+	rc = storage_area_read(sa, off, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr, sizeof(rd), "data mismatch");
+
+	/* a write to the start of block 1 erases it */
+	memset(wr, 0x30, sizeof(wr));
+	rc = storage_area_write(sa, AREA_ERASE_SIZE, wr, AREA_WRITE_SIZE);
+	zassert_ok(rc, "prog returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_NOR_SIM_WEAR, &wear);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(wear.erases, wear0.erases + 1U, "block not erased");
+	rc = storage_area_read(sa, AREA_ERASE_SIZE, rd, AREA_WRITE_SIZE);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_mem_equal(rd, wr, AREA_WRITE_SIZE, "data mismatch");
+}
+#endif /* CONFIG_STORAGE_AREA_NOR_SIM */
+
+#ifdef CONFIG_STORAGE_AREA_STATS
+static uint32_t
+storage_area_api_latency_ops(const struct storage_area_op_stats *ops)
+{
+	uint32_t rv = 0U;
+
+	for (size_t i = 0U; i < STORAGE_AREA_STATS_BUCKETS; i++) {
+		rv += ops->latency[i];
+	}
+
+	return rv;
+}
+
+ZTEST_USER(storage_area_api, test_stats)
+{
+	const struct storage_area *sa = GET_STORAGE_AREA(test);
+	const size_t ws = STORAGE_AREA_WRITESIZE(sa);
+	struct storage_area_stats stats;
+	uint8_t wr[STORAGE_AREA_WRITESIZE(sa)];
+	uint8_t rd[STORAGE_AREA_WRITESIZE(sa)];
+	int rc;
+
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_STATS, NULL);
+	zassert_equal(rc, -EINVAL, "ioctl returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_STATS_RESET, NULL);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+
+	memset(wr, 'T', sizeof(wr));
+	rc = storage_area_write(sa, 0U, wr, sizeof(wr));
+	zassert_ok(rc, "prog returned [%d]", rc);
+	rc = storage_area_read(sa, 0U, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	rc = storage_area_read(sa, ws, rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	rc = storage_area_erase(sa, 0U, 1U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	rc = storage_area_erase(sa, 0U, 2U);
+	zassert_ok(rc, "erase returned [%d]", rc);
+	/* failing range checks are not counted */
+	rc = storage_area_read(sa, STORAGE_AREA_SIZE(sa), rd, sizeof(rd));
+	zassert_equal(rc, -EINVAL, "read returned [%d]", rc);
+
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_STATS, &stats);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(stats.read.ops, 2U, "wrong read count");
+	zassert_equal(stats.read.bytes, 2U * ws, "wrong read bytes");
+	zassert_equal(stats.read.errors, 0U, "wrong read errors");
+	zassert_equal(storage_area_api_latency_ops(&stats.read), 2U,
+		      "wrong read latency count");
+	zassert_equal(stats.write.ops, 1U, "wrong write count");
+	zassert_equal(stats.write.bytes, ws, "wrong write bytes");
+	zassert_equal(stats.erase.ops, 2U, "wrong erase count");
+	zassert_equal(stats.erase.bytes, 3U * STORAGE_AREA_ERASESIZE(sa),
+		      "wrong erase bytes");
+	zassert_equal(stats.erased_blocks, 3U, "wrong erased blocks");
+	zassert_equal(stats.block_erases[0], 2U, "wrong block 0 erases");
+	if (STORAGE_AREA_STATS_ERASE_BLOCKS > 1) {
+		zassert_equal(stats.block_erases[1], 1U,
+			      "wrong block 1 erases");
+	}
+
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_STATS_RESET, NULL);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	rc = storage_area_ioctl(sa, STORAGE_AREA_IOCTL_STATS, &stats);
+	zassert_ok(rc, "ioctl returned [%d]", rc);
+	zassert_equal(stats.read.ops + stats.write.ops + stats.erase.ops, 0U,
+		      "statistics not cleared");
+	zassert_equal(stats.block_erases[0], 0U, "erase counters not cleared");
+}
+#endif /* CONFIG_STORAGE_AREA_STATS */
+
 ZTEST_SUITE(storage_area_api, NULL, storage_area_api_setup,
 	    storage_area_api_before, NULL, NULL);
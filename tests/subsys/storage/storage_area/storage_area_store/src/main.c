@@ -6,6 +6,7 @@
 
 /* Test for the storage_area_store API */
 
+#include <stdio.h>
 #include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/ztest.h>
@@ -21,15 +22,61 @@ LOG_MODULE_REGISTER(sas_test);
 #define FLASH_AREA_OFFSET	DT_REG_ADDR(FLASH_AREA_NODE)
 #define FLASH_AREA_DEVICE							\
 	DEVICE_DT_GET(DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE))
+#ifdef CONFIG_FLASH_SIMULATOR
+/* the flash simulator is not memory mapped */
+#define FLASH_AREA_XIP		STORAGE_AREA_FLASH_NO_XIP
+#else
 #define FLASH_AREA_XIP		FLASH_AREA_OFFSET +				\
 	DT_REG_ADDR(DT_MTD_FROM_FIXED_PARTITION(FLASH_AREA_NODE))
+#endif /* CONFIG_FLASH_SIMULATOR */
+#ifdef CONFIG_STORAGE_AREA_MIRROR
+/* each half of the partition is a replica */
+#define AREA_SIZE		(DT_REG_SIZE(FLASH_AREA_NODE) / 2)
+#else
 #define AREA_SIZE		DT_REG_SIZE(FLASH_AREA_NODE)
+#endif /* CONFIG_STORAGE_AREA_MIRROR */
 #define AREA_ERASE_SIZE		8192
 #define AREA_WRITE_SIZE		8
-
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+/* the background erase is only used when the area is erased before write */
+#define FLASH_AREA_PROPS	STORAGE_AREA_PROP_LOVRWRITE
+#else
+#define FLASH_AREA_PROPS						\
+	STORAGE_AREA_PROP_LOVRWRITE | STORAGE_AREA_PROP_AUTOERASE
+#endif /* CONFIG_STORAGE_AREA_STORE_PREERASE */
+
+#if defined(CONFIG_STORAGE_AREA_MIRROR)
+#include <zephyr/storage/storage_area/storage_area_mirror.h>
+
+STORAGE_AREA_FLASH_RW_DEFINE(flash0, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	FLASH_AREA_PROPS);
+STORAGE_AREA_FLASH_RW_DEFINE(flash1, FLASH_AREA_DEVICE,
+	FLASH_AREA_OFFSET + AREA_SIZE, FLASH_AREA_XIP + AREA_SIZE,
+	AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE, FLASH_AREA_PROPS);
+STORAGE_AREA_MIRROR_RW_DEFINE(test, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	AREA_SIZE, FLASH_AREA_PROPS,
+	GET_STORAGE_AREA(flash0), GET_STORAGE_AREA(flash1));
+#elif defined(CONFIG_STORAGE_AREA_STRIPE)
+#include <zephyr/storage/storage_area/storage_area_stripe.h>
+#define STRIPE_UNIT		1024
+
+/* the stripe does the autoerase, the halves are plain flash areas */
+STORAGE_AREA_FLASH_RW_DEFINE(flash0, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
+	STORAGE_AREA_FLASH_NO_XIP, AREA_WRITE_SIZE, (AREA_ERASE_SIZE / 2),
+	(AREA_SIZE / 2), STORAGE_AREA_PROP_LOVRWRITE);
+STORAGE_AREA_FLASH_RW_DEFINE(flash1, FLASH_AREA_DEVICE,
+	FLASH_AREA_OFFSET + (AREA_SIZE / 2), STORAGE_AREA_FLASH_NO_XIP,
+	AREA_WRITE_SIZE, (AREA_ERASE_SIZE / 2), (AREA_SIZE / 2),
+	STORAGE_AREA_PROP_LOVRWRITE);
+STORAGE_AREA_STRIPE_RW_DEFINE(test, STRIPE_UNIT, AREA_WRITE_SIZE,
+	AREA_ERASE_SIZE, AREA_SIZE, FLASH_AREA_PROPS,
+	GET_STORAGE_AREA(flash0), GET_STORAGE_AREA(flash1));
+#else
 STORAGE_AREA_FLASH_RW_DEFINE(test, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
 	FLASH_AREA_XIP, AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
-	STORAGE_AREA_PROP_LOVRWRITE | STORAGE_AREA_PROP_AUTOERASE);
+	FLASH_AREA_PROPS);
+#endif /* CONFIG_STORAGE_AREA_MIRROR */
 #endif /* CONFIG_STORAGE_AREA_FLASH */
 
 #ifdef CONFIG_STORAGE_AREA_EEPROM
@@ -40,8 +87,17 @@ STORAGE_AREA_FLASH_RW_DEFINE(test, FLASH_AREA_DEVICE, FLASH_AREA_OFFSET,
 #define AREA_ERASE_SIZE		4096
 #define AREA_WRITE_SIZE		4
 
+#ifdef CONFIG_STORAGE_AREA_CACHE
+#include <zephyr/storage/storage_area/storage_area_cache.h>
+STORAGE_AREA_EEPROM_RW_DEFINE(eeprom, EEPROM_AREA_DEVICE, 0U, AREA_WRITE_SIZE,
+	AREA_ERASE_SIZE, AREA_SIZE, 0);
+STORAGE_AREA_CACHE_RW_DEFINE(test, GET_STORAGE_AREA(eeprom), 256, 4,
+	AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE,
+	STORAGE_AREA_PROP_FOVRWRITE);
+#else
 STORAGE_AREA_EEPROM_RW_DEFINE(test, EEPROM_AREA_DEVICE, 0U, AREA_WRITE_SIZE,
 	AREA_ERASE_SIZE, AREA_SIZE, 0);
+#endif /* CONFIG_STORAGE_AREA_CACHE */
 #endif /* CONFIG_STORAGE_AREA_EEPROM */
 
 #ifdef CONFIG_STORAGE_AREA_RAM
@@ -69,6 +125,31 @@ STORAGE_AREA_DISK_RW_DEFINE(test, DISK_NAME, DISK_SCNT / 2, DISK_SSIZE,
 	AREA_WRITE_SIZE, AREA_ERASE_SIZE, AREA_SIZE, 0);
 #endif /* CONFIG_STORAGE_AREA_DISK */
 
+#ifdef CONFIG_STORAGE_AREA_FILE
+#include <zephyr/storage/storage_area/storage_area_file.h>
+/* a temporary file: nothing is left behind in the working directory */
+#define FILE_PATH	NULL
+#define AREA_SIZE	(64 * 1024)
+#define AREA_ERASE_SIZE	8192
+#define AREA_WRITE_SIZE	8
+
+STORAGE_AREA_FILE_RW_DEFINE(test, FILE_PATH, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE |
+	STORAGE_AREA_PROP_AUTOERASE);
+#endif /* CONFIG_STORAGE_AREA_FILE */
+
+#ifdef CONFIG_STORAGE_AREA_NOR_SIM
+#include <zephyr/storage/storage_area/storage_area_nor_sim.h>
+#define AREA_SIZE	(64 * 1024)
+#define AREA_ERASE_SIZE	8192
+#define AREA_WRITE_SIZE	8
+
+/* 100 ns program time per byte, 1 ms erase time per block */
+STORAGE_AREA_NOR_SIM_RW_DEFINE(test, AREA_WRITE_SIZE, AREA_ERASE_SIZE,
+	AREA_SIZE, STORAGE_AREA_PROP_LOVRWRITE | STORAGE_AREA_PROP_AUTOERASE,
+	100, 1000);
+#endif /* CONFIG_STORAGE_AREA_NOR_SIM */
+
 static const char cookie[] = "!NVS";
 
 bool move(const struct storage_area_record *record)
@@ -160,6 +241,9 @@ static void storage_area_store_api_before(void *fixture)
 {
 	ARG_UNUSED(fixture);
 
+	/* a test can leave the store mounted */
+	(void)storage_area_store_unmount(GET_STORAGE_AREA_STORE(test));
+
 	int rc = storage_area_store_wipe(GET_STORAGE_AREA_STORE(test));
 
 	zassert_ok(rc, "wipe returned [%d]", rc);
@@ -284,6 +368,19 @@ ZTEST_USER(storage_area_store_api, test_store)
 	zassert_ok(rc, "read returned [%d]", rc);
 	zassert_equal(rvalue, wvalue2, "bad data read");
 
+	struct storage_area_iovec wrmax[CONFIG_STORAGE_AREA_STORE_MAX_IOVCNT + 1];
+
+	for (size_t i = 0U; i < ARRAY_SIZE(wrmax); i++) {
+		wrmax[i].data = &wvalue2;
+		wrmax[i].len = sizeof(wvalue2);
+	}
+
+	rc = storage_area_store_writev(store, wrmax, ARRAY_SIZE(wrmax));
+	zassert_equal(rc, -EINVAL, "write with too many iovec elements [%d]",
+		      rc);
+	rc = storage_area_store_writev(store, wrmax, ARRAY_SIZE(wrmax) - 1U);
+	zassert_ok(rc, "write with the maximum iovec elements [%d]", rc);
+
 	wvalue3 = 0U;
 	for (int i = 0; i < store->sector_cnt; i++) {
 		while (write_data(store, "data2", wvalue3) == 0) {
@@ -393,5 +490,844 @@ ZTEST_USER(storage_area_store_api, test_record_update)
 	zassert_equal(status, rdstatus, "bad status");
 }
 
+ZTEST_USER(storage_area_store_api, test_record_view)
+{
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(test);
+	struct storage_area_record walk;
+	const uint8_t *data;
+	uintptr_t xip;
+	size_t len;
+	int rc;
+
+	rc = storage_area_store_mount(store, NULL);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	rc = write_data(store, "view", 0x00C0FFEE);
+	zassert_ok(rc, "write returned [%d]", rc);
+
+	walk.store = NULL;
+	rc = storage_area_record_next(store, &walk);
+	zassert_ok(rc, "retrieve record failed [%d]", rc);
+
+	rc = storage_area_record_view_valid(&walk, (const void **)&data, &len);
+	if (storage_area_ioctl(store->area, STORAGE_AREA_IOCTL_XIPADDRESS,
+			       &xip) != 0) {
+		/* records can only be viewed on memory mapped areas */
+		zassert_equal(rc, -ENOTSUP, "view returned [%d]", rc);
+		goto end;
+	}
+
+	zassert_ok(rc, "view returned [%d]", rc);
+	zassert_equal(len, walk.size, "bad view length");
+	zassert_equal(data[0], strlen("view"), "bad view data");
+	zassert_mem_equal(&data[1], "view", strlen("view"), "bad view data");
+	rc = storage_area_record_unmap(&walk, data);
+	zassert_ok(rc, "unmap returned [%d]", rc);
+end:
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+/*
+ * A record move writes the header last: an interrupted move leaves a copy
+ * without header. Records written after the next mount must still be found.
+ */
+static void storage_area_store_move_interrupted(const uint8_t *body,
+						size_t len)
+{
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(test);
+	const struct storage_area *area = GET_STORAGE_AREA(test);
+	struct storage_area_store_data *data = store->data;
+	const size_t head = ROUND_UP(4U, AREA_WRITE_SIZE);
+	struct storage_area_record walk;
+	uint32_t value = 0U;
+	size_t cnt = 0U;
+	sa_off_t off;
+	int rc;
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	rc = write_data(store, "before", 1U);
+	zassert_ok(rc, "write returned [%d]", rc);
+
+	/* the body of a copy is written, the header is not */
+	off = data->sector * store->sector_size + data->loc;
+	rc = storage_area_write(area, off + head, body, len);
+	zassert_ok(rc, "write returned [%d]", rc);
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	rc = write_data(store, "after", 2U);
+	zassert_ok(rc, "write returned [%d]", rc);
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	walk.store = NULL;
+	while (storage_area_record_next(store, &walk) == 0) {
+		zassert_true(storage_area_record_valid(&walk), "bad record");
+		cnt++;
+	}
+
+	zassert_equal(cnt, 2U, "wrong record count %d", cnt);
+	rc = read_data(store, "before", &value);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(value, 1U, "bad value before the interrupted copy");
+	rc = read_data(store, "after", &value);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(value, 2U, "bad value after the interrupted copy");
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+ZTEST_USER(storage_area_store_api, test_move_interrupted)
+{
+	uint8_t body[2 * AREA_WRITE_SIZE];
+
+	memset(body, 0x5a, sizeof(body));
+	storage_area_store_move_interrupted(body, sizeof(body));
+}
+
+/*
+ * The copy that is dropped is skipped by its size: a write block in the copy
+ * that starts like the fill (0xFF) does not end the scan.
+ */
+ZTEST_USER(storage_area_store_api, test_move_interrupted_fill)
+{
+	uint8_t body[4 * AREA_WRITE_SIZE];
+
+	memset(body, 0x5a, sizeof(body));
+	body[AREA_WRITE_SIZE] = 0xFF;
+	storage_area_store_move_interrupted(body, sizeof(body));
+}
+
+#define AUTOERASE_SECTOR_SIZE (2 * AREA_ERASE_SIZE)
+STORAGE_AREA_STORE_DEFINE(autoerase, GET_STORAGE_AREA(test), (void *)cookie,
+			  sizeof(cookie), AUTOERASE_SECTOR_SIZE,
+			  AREA_SIZE / AUTOERASE_SECTOR_SIZE, 0U, 0U);
+
+/*
+ * On an area that erases on write the second erase block of a sector keeps
+ * old data until it is written, the write head is found after the records.
+ */
+ZTEST_USER(storage_area_store_api, test_mount_autoerase)
+{
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(autoerase);
+	struct storage_area_store_data *data = store->data;
+	uint32_t value = 0U;
+	size_t loc;
+	int rc;
+
+	if ((!STORAGE_AREA_AUTOERASE(store->area)) ||
+	    (STORAGE_AREA_FOVRWRITE(store->area))) {
+		/* area is not erased on write */
+		return;
+	}
+
+	/* the wipe leaves data that differs from the erase value */
+	rc = storage_area_store_wipe(store);
+	zassert_ok(rc, "wipe returned [%d]", rc);
+
+	rc = storage_area_store_mount(store, NULL);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	rc = write_data(store, "autoerase", 1U);
+	zassert_ok(rc, "write returned [%d]", rc);
+
+	loc = data->loc;
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+
+	rc = storage_area_store_mount(store, NULL);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	zassert_equal(data->sector, 0U, "bad sector after mount");
+	zassert_equal(data->loc, loc, "bad loc after mount");
+
+	rc = write_data(store, "autoerase", 2U);
+	zassert_ok(rc, "write returned [%d]", rc);
+	rc = read_data(store, "autoerase", &value);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(value, 2U, "bad data read");
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+#define MOUNT_SECTOR_SIZE MAX(256, 4 * AREA_WRITE_SIZE)
+#define MOUNT_SECTOR_CNT  (AREA_SIZE / MOUNT_SECTOR_SIZE)
+STORAGE_AREA_STORE_DEFINE(mount_s, GET_STORAGE_AREA(test), (void *)cookie,
+			  sizeof(cookie), MOUNT_SECTOR_SIZE,
+			  MOUNT_SECTOR_CNT / 4, 0U, 0U);
+STORAGE_AREA_STORE_DEFINE(mount_m, GET_STORAGE_AREA(test), (void *)cookie,
+			  sizeof(cookie), MOUNT_SECTOR_SIZE,
+			  MOUNT_SECTOR_CNT / 2, 0U, 0U);
+STORAGE_AREA_STORE_DEFINE(mount_l, GET_STORAGE_AREA(test), (void *)cookie,
+			  sizeof(cookie), MOUNT_SECTOR_SIZE, MOUNT_SECTOR_CNT,
+			  0U, 0U);
+
+/* record header and crc size */
+#define MOUNT_RECORD_OVERHEAD 8U
+
+/* write a record that ends exactly at the end of the current sector */
+static size_t storage_area_store_fill_tail(
+	const struct storage_area_store *store)
+{
+	static uint8_t tail[MOUNT_SECTOR_SIZE];
+	struct storage_area_store_data *data = store->data;
+	size_t len;
+	int rc;
+
+	/* half fill the sector so the probe stays clear of the sector end */
+	while (data->loc < (store->sector_size / 2U)) {
+		rc = write_data(store, "mount", data->loc);
+		zassert_ok(rc, "write returned [%d]", rc);
+	}
+
+	memset(tail, 0x5a, sizeof(tail));
+	len = store->sector_size - data->loc - MOUNT_RECORD_OVERHEAD;
+	while (true) {
+		rc = storage_area_store_write(store, tail, len);
+		if ((rc != -ENOSPC) || (len == 0U)) {
+			break;
+		}
+
+		len--;
+	}
+
+	zassert_ok(rc, "write returned [%d]", rc);
+	return len;
+}
+
+static void storage_area_store_mount_head(
+	const struct storage_area_store *store)
+{
+	struct storage_area_store_data *data = store->data;
+	struct storage_area_record walk = {
+		.store = NULL,
+	};
+	struct storage_area_record last = {
+		.size = 0U,
+	};
+	uint32_t value = 0U;
+	size_t sector, loc, tail;
+	uint8_t wrapcnt, rd;
+	int rc;
+
+	rc = storage_area_store_wipe(store);
+	zassert_ok(rc, "wipe returned [%d]", rc);
+
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	/* fill the store up to 3/4 of its sectors, wrap once for half */
+	for (int i = 0; i < 2; i++) {
+		const size_t end = (i == 0) ? store->sector_cnt - 1 :
+					      (3 * store->sector_cnt) / 4;
+
+		while (data->sector != end) {
+			rc = write_data(store, "mount", value);
+			if (rc == -ENOSPC) {
+				rc = storage_area_store_advance(store);
+			}
+
+			zassert_ok(rc, "write returned [%d]", rc);
+			value++;
+		}
+
+		if (i == 0) {
+			rc = storage_area_store_advance(store);
+			zassert_ok(rc, "advance returned [%d]", rc);
+		}
+	}
+
+	/* the last record fills the head sector up to its end */
+	tail = storage_area_store_fill_tail(store);
+
+	sector = data->sector;
+	loc = data->loc;
+	wrapcnt = data->wrapcnt;
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+
+	/* the write head is found in the wrapped store */
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	zassert_equal(data->sector, sector, "bad sector after mount");
+	zassert_equal(data->loc, loc, "bad loc after mount");
+	zassert_equal(data->wrapcnt, wrapcnt, "bad wrapcnt after mount");
+
+	/* the record that exactly fills the sector is found */
+	while (storage_area_record_next(store, &walk) == 0) {
+		last = walk;
+	}
+
+	zassert_equal(last.sector, sector, "last record in wrong sector");
+	zassert_equal(last.size, tail, "last record not found");
+	rc = storage_area_record_read(&last, 0U, &rd, sizeof(rd));
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(rd, 0x5a, "bad last record data");
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+ZTEST_USER(storage_area_store_api, test_mount_head)
+{
+	storage_area_store_mount_head(GET_STORAGE_AREA_STORE(mount_s));
+	storage_area_store_mount_head(GET_STORAGE_AREA_STORE(mount_m));
+	storage_area_store_mount_head(GET_STORAGE_AREA_STORE(mount_l));
+}
+
+static uint32_t name_key(const char *name, size_t nsz)
+{
+	uint32_t key = 2166136261U;
+
+	for (size_t i = 0U; i < nsz; i++) {
+		key = (key ^ (uint8_t)name[i]) * 16777619U;
+	}
+
+	return key;
+}
+
+static uint32_t record_key(const struct storage_area_record *record)
+{
+	uint8_t nsz;
+
+	if (storage_area_record_read(record, 0U, &nsz, sizeof(nsz)) != 0) {
+		return 0U;
+	}
+
+	char name[nsz];
+
+	if (storage_area_record_read(record, sizeof(nsz), name, nsz) != 0) {
+		return 0U;
+	}
+
+	return name_key(name, nsz);
+}
+
+ZTEST_USER(storage_area_store_api, test_record_find)
+{
+	if (!IS_ENABLED(CONFIG_STORAGE_AREA_STORE_SUMMARY)) {
+		/* sector summary not enabled */
+		return;
+	}
+
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(mount_l);
+	struct storage_area_record record;
+	char name[8];
+	uint32_t value, rvalue;
+	int rc;
+
+	rc = storage_area_store_wipe(store);
+	zassert_ok(rc, "wipe returned [%d]", rc);
+
+	rc = storage_area_store_set_key(store, record_key);
+	zassert_ok(rc, "set key returned [%d]", rc);
+
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	for (value = 0U; value < 64U; value++) {
+		snprintf(name, sizeof(name), "key%d", value);
+		rc = write_data(store, name, value);
+		if (rc == -ENOSPC) {
+			rc = storage_area_store_advance(store);
+			zassert_ok(rc, "advance returned [%d]", rc);
+			rc = write_data(store, name, value);
+		}
+
+		zassert_ok(rc, "write returned [%d]", rc);
+	}
+
+	/* the summaries are persistent */
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	for (value = 0U; value < 64U; value++) {
+		snprintf(name, sizeof(name), "key%d", value);
+		record.store = NULL;
+		rc = storage_area_record_find(store, &record,
+					      name_key(name, strlen(name)));
+		zassert_ok(rc, "find returned [%d]", rc);
+		rc = storage_area_record_read(&record, 1U + strlen(name),
+					      &rvalue, sizeof(rvalue));
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_equal(rvalue, value, "bad data read");
+	}
+
+	record.store = NULL;
+	rc = storage_area_record_find(store, &record, name_key("none", 4U));
+	zassert_equal(rc, -ENOENT, "find returned [%d]", rc);
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+ZTEST_USER(storage_area_store_api, test_compactor)
+{
+	if (!IS_ENABLED(CONFIG_STORAGE_AREA_STORE_COMPACTOR)) {
+		/* background compactor not enabled */
+		return;
+	}
+
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(test);
+	struct storage_area_store_compactor_stats stats;
+	/* largest record written: name size, name, value, header and crc */
+	const size_t rmax = ROUND_UP(1U + 8U + 4U + 8U, AREA_WRITE_SIZE);
+	struct storage_area_record walk;
+	size_t sector = SIZE_MAX, end = 0U;
+	uint32_t values[8], rvalue;
+	char name[8];
+	int rc;
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	rc = storage_area_store_compactor_start(store, &compact_cb,
+					       store->sector_size / 4);
+	zassert_ok(rc, "compactor start returned [%d]", rc);
+
+	for (uint32_t i = 0U; i < (4U * store->sector_cnt * 64U); i++) {
+		snprintf(name, sizeof(name), "data%d", i % ARRAY_SIZE(values));
+		values[i % ARRAY_SIZE(values)] = i;
+		rc = write_data(store, name, i);
+		zassert_ok(rc, "write returned [%d]", rc);
+		if ((i % 8U) == 0U) {
+			/* give the compactor time to run */
+			k_msleep(1);
+		}
+	}
+
+	rc = storage_area_store_compactor_get_stats(store, &stats);
+	zassert_ok(rc, "get stats returned [%d]", rc);
+	LOG_INF("Compactor runs: %d - waits: %d - nospc: %d", stats.runs,
+		stats.waits, stats.nospc);
+	zassert_true(stats.runs > 0U, "compactor did not run");
+	zassert_equal(stats.nospc, 0U, "write without space");
+
+	rc = storage_area_store_compactor_stop(store);
+	zassert_ok(rc, "compactor stop returned [%d]", rc);
+
+	/* a sector is only left when a record does not fit in its tail */
+	walk.store = NULL;
+	while (storage_area_record_next(store, &walk) == 0) {
+		if ((walk.sector != sector) && (sector != SIZE_MAX)) {
+			zassert_true((store->sector_size - end) < rmax,
+				     "tail of sector %d left unused", sector);
+		}
+
+		sector = walk.sector;
+		end = walk.loc + ROUND_UP(walk.size + 8U, AREA_WRITE_SIZE);
+	}
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	for (size_t i = 0U; i < ARRAY_SIZE(values); i++) {
+		snprintf(name, sizeof(name), "data%d", i);
+		rvalue = 0xFFFF;
+		rc = read_data(store, name, &rvalue);
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_equal(rvalue, values[i], "bad data read");
+	}
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+#define STEP_SECTOR_SIZE (AREA_ERASE_SIZE / 4)
+STORAGE_AREA_STORE_DEFINE(step, GET_STORAGE_AREA(test), (void *)cookie,
+			  sizeof(cookie), STEP_SECTOR_SIZE,
+			  AREA_SIZE / STEP_SECTOR_SIZE, 4U, 0U);
+
+/* records that are written once and are moved by every compaction */
+#define STEP_FIXED_CNT 16
+
+static size_t step_fixed_cnt(const struct storage_area_store *store)
+{
+	/* at most half of a sector without cookie and summary */
+	const size_t avail = store->sector_size - 2U * AREA_WRITE_SIZE;
+
+	return MIN(STEP_FIXED_CNT,
+		   avail / (2U * ROUND_UP(24U, AREA_WRITE_SIZE)));
+}
+
+static void step_check(const struct storage_area_store *store,
+		       const uint32_t *values, size_t cnt)
+{
+	uint32_t rvalue;
+	char name[8];
+	int rc;
+
+	for (size_t i = 0U; i < step_fixed_cnt(store); i++) {
+		snprintf(name, sizeof(name), "fix%d", i);
+		rvalue = 0xFFFF;
+		rc = read_data(store, name, &rvalue);
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_equal(rvalue, i, "bad data read");
+	}
+
+	for (size_t i = 0U; i < cnt; i++) {
+		snprintf(name, sizeof(name), "data%d", i);
+		rvalue = 0xFFFF;
+		rc = read_data(store, name, &rvalue);
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_equal(rvalue, values[i], "bad data read");
+	}
+}
+
+ZTEST_USER(storage_area_store_api, test_compact_step)
+{
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(step);
+	const size_t budget = store->sector_size / 8U;
+	uint32_t values[8], value = 0U;
+	size_t steps = 1U;
+	char name[8];
+	int rc;
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	for (size_t i = 0U; i < step_fixed_cnt(store); i++) {
+		snprintf(name, sizeof(name), "fix%d", i);
+		rc = write_data(store, name, i);
+		zassert_ok(rc, "write returned [%d]", rc);
+	}
+
+	/* interrupt compactions after 1, 2, ... steps until one finishes */
+	for (size_t cnt = 0U; true; cnt++) {
+		zassert_true(cnt < (16U * store->sector_cnt), "no finish");
+		do {
+			snprintf(name, sizeof(name), "data%d",
+				 value % ARRAY_SIZE(values));
+			rc = write_data(store, name, value);
+			if (rc == 0) {
+				values[value % ARRAY_SIZE(values)] = value;
+				value++;
+			}
+		} while (rc == 0);
+
+		zassert_equal(rc, -ENOSPC, "write returned [%d]", rc);
+		rc = storage_area_store_compact_step(store, &compact_cb, budget);
+		if (rc == 0) {
+			/* no records to move */
+			continue;
+		}
+
+		/* records that are not moved yet are found between steps */
+		step_check(store, values, MIN(value, ARRAY_SIZE(values)));
+		for (size_t i = 1U; (rc == -EAGAIN) && (i < steps); i++) {
+			rc = storage_area_store_compact_step(store, &compact_cb,
+							     budget);
+			step_check(store, values,
+				   MIN(value, ARRAY_SIZE(values)));
+		}
+
+		if (rc == 0) {
+			/* the compaction finished before the interruption */
+			break;
+		}
+
+		zassert_equal(rc, -EAGAIN, "compact step returned [%d]", rc);
+		rc = storage_area_store_unmount(store);
+		zassert_ok(rc, "unmount returned [%d]", rc);
+
+		rc = storage_area_store_mount(store, &compact_cb);
+		zassert_ok(rc, "mount returned [%d]", rc);
+
+		step_check(store, values, MIN(value, ARRAY_SIZE(values)));
+		steps++;
+	}
+
+	LOG_INF("Compaction interrupted at %d steps", steps - 1U);
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+#define PREERASE_SECTOR_SIZE (AREA_ERASE_SIZE / 2)
+STORAGE_AREA_STORE_DEFINE(preerase, GET_STORAGE_AREA(test), (void *)cookie,
+			  sizeof(cookie), PREERASE_SECTOR_SIZE,
+			  AREA_SIZE / PREERASE_SECTOR_SIZE, 6U, 0U);
+
+static size_t preerase_erased(const struct storage_area_store *store)
+{
+#ifdef CONFIG_STORAGE_AREA_STORE_PREERASE
+	return store->data->preerase.erased;
+#else
+	ARG_UNUSED(store);
+	return 0U;
+#endif /* CONFIG_STORAGE_AREA_STORE_PREERASE */
+}
+
+static void preerase_wait(const struct storage_area_store *store, size_t cnt)
+{
+	for (size_t i = 0U; (i < 100U) && (preerase_erased(store) < cnt); i++) {
+		k_msleep(10);
+	}
+}
+
+ZTEST_USER(storage_area_store_api, test_preerase)
+{
+	if (!IS_ENABLED(CONFIG_STORAGE_AREA_STORE_PREERASE)) {
+		/* background erase not enabled */
+		return;
+	}
+
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(preerase);
+	uint32_t values[8], rvalue;
+	char name[8];
+	int rc;
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	rc = storage_area_store_preerase_start(store, 6U);
+	zassert_equal(rc, -EINVAL, "preerase without spare sectors [%d]", rc);
+
+	rc = storage_area_store_preerase_start(store, 4U);
+	zassert_ok(rc, "preerase start returned [%d]", rc);
+
+	for (uint32_t i = 0U; i < (4U * store->sector_cnt * 64U); i++) {
+		snprintf(name, sizeof(name), "data%d", i % ARRAY_SIZE(values));
+		values[i % ARRAY_SIZE(values)] = i;
+		rc = write_data(store, name, i);
+		if (rc == -ENOSPC) {
+			preerase_wait(store, 2U);
+			zassert_equal(preerase_erased(store), 2U,
+				      "sectors not erased");
+			rc = storage_area_store_compact(store, &compact_cb);
+			zassert_ok(rc, "compact returned [%d]", rc);
+			rc = write_data(store, name, i);
+		}
+
+		zassert_ok(rc, "write returned [%d]", rc);
+	}
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+	zassert_equal(preerase_erased(store), 0U, "erased not reset");
+
+	rc = storage_area_store_mount(store, &compact_cb);
+	zassert_ok(rc, "mount returned [%d]", rc);
+
+	for (size_t i = 0U; i < ARRAY_SIZE(values); i++) {
+		snprintf(name, sizeof(name), "data%d", i);
+		rvalue = 0xFFFF;
+		rc = read_data(store, name, &rvalue);
+		zassert_ok(rc, "read returned [%d]", rc);
+		zassert_equal(rvalue, values[i], "bad data read");
+	}
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR
+/* the retired blocks are not cleared: each wear test has its own store */
+STORAGE_AREA_STORE_BLOCKS_DEFINE(wear, GET_STORAGE_AREA(test), AREA_ERASE_SIZE,
+				 (void *)cookie, sizeof(cookie), SECTOR_SIZE,
+				 AREA_SIZE / SECTOR_SIZE,
+				 AREA_ERASE_SIZE / SECTOR_SIZE, 0U);
+
+static size_t wear_block(const struct storage_area_store *store, size_t sector)
+{
+	return (sector * store->sector_size) / store->area->erase_size;
+}
+
+ZTEST_USER(storage_area_store_api, test_wear)
+{
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(wear);
+	const size_t uscnt = MAX(1U, AREA_ERASE_SIZE / SECTOR_SIZE);
+	const size_t retired = 2U * uscnt;
+	const uint32_t cnt = 2U * store->sector_cnt;
+	uint32_t erases, start, rvalue;
+	int rc;
+
+	zassert_equal(store->data->wear_cnt,
+		      DIV_ROUND_UP(store->sector_cnt, uscnt),
+		      "erase counters not sized per erase block");
+	rc = storage_area_store_wipe(store);
+	zassert_ok(rc, "wipe returned [%d]", rc);
+	rc = storage_area_store_get_wear(store,
+					 wear_block(store, store->sector_cnt),
+					 &erases);
+	zassert_equal(rc, -EINVAL, "get wear returned [%d]", rc);
+	rc = storage_area_store_get_wear(store, 0U, &start);
+	zassert_ok(rc, "get wear returned [%d]", rc);
+	zassert_true(start > 0U, "wipe not counted");
+
+	rc = storage_area_store_retire_block(store, wear_block(store, retired));
+	zassert_ok(rc, "retire returned [%d]", rc);
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	rc = storage_area_store_retire_block(store, 0U);
+	zassert_equal(rc, -EBUSY, "retire returned [%d]", rc);
+
+	/* wrap the circular buffer twice */
+	for (uint32_t i = 0U; i < cnt; i++) {
+		rc = write_data(store, "wear", i);
+		zassert_ok(rc, "write returned [%d]", rc);
+		rc = storage_area_store_advance(store);
+		zassert_ok(rc, "advance returned [%d]", rc);
+		zassert_true((store->data->sector < retired) ||
+			     (store->data->sector >= (retired + uscnt)),
+			     "retired block used");
+	}
+
+	rc = storage_area_store_get_wear(store, 0U, &erases);
+	zassert_ok(rc, "get wear returned [%d]", rc);
+	zassert_true(erases >= (start + 2U), "erases not counted");
+	rc = storage_area_store_get_wear(store, wear_block(store, retired),
+					 &erases);
+	zassert_ok(rc, "get wear returned [%d]", rc);
+	zassert_equal(erases, UINT32_MAX, "block not retired");
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	rc = read_data(store, "wear", &rvalue);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(rvalue, cnt - 1U, "bad data read");
+
+	/* worn blocks are skipped until no block is left */
+	rc = storage_area_store_get_wear(store, 0U, &erases);
+	zassert_ok(rc, "get wear returned [%d]", rc);
+	rc = storage_area_store_set_wear_limit(store, erases + 1U);
+	zassert_ok(rc, "set wear limit returned [%d]", rc);
+	for (size_t i = 0U; (rc == 0) && (i < (4U * cnt)); i++) {
+		rc = storage_area_store_advance(store);
+	}
+
+	zassert_equal(rc, -ENOSPC, "worn blocks used");
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+	rc = storage_area_store_set_wear_limit(store, 0U);
+	zassert_ok(rc, "set wear limit returned [%d]", rc);
+}
+
+#ifdef CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST
+/* a second store on the same area acts as the store after a reboot */
+STORAGE_AREA_STORE_BLOCKS_DEFINE(wear_boot, GET_STORAGE_AREA(test),
+				 AREA_ERASE_SIZE, (void *)cookie,
+				 sizeof(cookie), SECTOR_SIZE,
+				 AREA_SIZE / SECTOR_SIZE,
+				 AREA_ERASE_SIZE / SECTOR_SIZE, 0U);
+STORAGE_AREA_STORE_BLOCKS_DEFINE(wear_reboot, GET_STORAGE_AREA(test),
+				 AREA_ERASE_SIZE, (void *)cookie,
+				 sizeof(cookie), SECTOR_SIZE,
+				 AREA_SIZE / SECTOR_SIZE,
+				 AREA_ERASE_SIZE / SECTOR_SIZE, 0U);
+
+ZTEST_USER(storage_area_store_api, test_wear_persist)
+{
+	struct storage_area_store *store = GET_STORAGE_AREA_STORE(wear_boot);
+	struct storage_area_store *reboot =
+		GET_STORAGE_AREA_STORE(wear_reboot);
+	const size_t uscnt = MAX(1U, AREA_ERASE_SIZE / SECTOR_SIZE);
+	const size_t retired = 2U * uscnt;
+	const uint32_t cnt = 2U * store->sector_cnt;
+	uint32_t erases, restored, rvalue;
+	int rc;
+
+	rc = storage_area_store_wipe(store);
+	zassert_ok(rc, "wipe returned [%d]", rc);
+	rc = storage_area_store_mount_cb(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	for (uint32_t i = 0U; i < cnt; i++) {
+		rc = write_data(store, "wear", i);
+		zassert_ok(rc, "write returned [%d]", rc);
+		rc = storage_area_store_advance(store);
+		zassert_ok(rc, "advance returned [%d]", rc);
+	}
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+
+	/* retired blocks are kept when the counters are restored */
+	rc = storage_area_store_retire_block(reboot,
+					     wear_block(reboot, retired));
+	zassert_ok(rc, "retire returned [%d]", rc);
+	rc = storage_area_store_mount_cb(reboot);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	for (size_t i = 0U; i < store->sector_cnt; i += uscnt) {
+		rc = storage_area_store_get_wear(store, wear_block(store, i),
+						 &erases);
+		zassert_ok(rc, "get wear returned [%d]", rc);
+		rc = storage_area_store_get_wear(reboot, wear_block(reboot, i),
+						 &restored);
+		zassert_ok(rc, "get wear returned [%d]", rc);
+		if (i == retired) {
+			zassert_equal(restored, UINT32_MAX, "block not retired");
+		} else {
+			zassert_true(erases > 1U, "erases not counted");
+			zassert_equal(restored, erases, "erases not restored");
+		}
+	}
+
+	rc = read_data(reboot, "wear", &rvalue);
+	zassert_ok(rc, "read returned [%d]", rc);
+	zassert_equal(rvalue, cnt - 1U, "bad data read");
+	for (uint32_t i = 0U; i < cnt; i++) {
+		rc = storage_area_store_advance(reboot);
+		zassert_ok(rc, "advance returned [%d]", rc);
+		zassert_true((reboot->data->sector < retired) ||
+			     (reboot->data->sector >= (retired + uscnt)),
+			     "retired block used");
+	}
+
+	/* worn blocks keep their erase counter after a reboot */
+	rc = storage_area_store_get_wear(reboot, 0U, &erases);
+	zassert_ok(rc, "get wear returned [%d]", rc);
+	rc = storage_area_store_set_wear_limit(reboot, erases + 1U);
+	zassert_ok(rc, "set wear limit returned [%d]", rc);
+	for (size_t i = 0U; (rc == 0) && (i < (4U * cnt)); i++) {
+		rc = storage_area_store_advance(reboot);
+	}
+
+	zassert_equal(rc, -ENOSPC, "worn blocks used");
+	rc = storage_area_store_unmount(reboot);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+	rc = storage_area_store_set_wear_limit(reboot, 0U);
+	zassert_ok(rc, "set wear limit returned [%d]", rc);
+
+	rc = storage_area_store_mount_ro(store);
+	zassert_ok(rc, "mount returned [%d]", rc);
+	for (size_t i = 0U; i < store->sector_cnt; i += uscnt) {
+		if (i == retired) {
+			continue;
+		}
+
+		rc = storage_area_store_get_wear(reboot, wear_block(reboot, i),
+						 &erases);
+		zassert_ok(rc, "get wear returned [%d]", rc);
+		rc = storage_area_store_get_wear(store, wear_block(store, i),
+						 &restored);
+		zassert_ok(rc, "get wear returned [%d]", rc);
+		zassert_equal(restored, erases, "worn erases not restored");
+	}
+
+	rc = storage_area_store_unmount(store);
+	zassert_ok(rc, "unmount returned [%d]", rc);
+}
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR_PERSIST */
+#endif /* CONFIG_STORAGE_AREA_STORE_WEAR */
+
 ZTEST_SUITE(storage_area_store_api, NULL, storage_area_store_api_setup,
 	    storage_area_store_api_before, NULL, NULL);